@@ -1,9 +1,22 @@
 #include <MarketDataProvider/MarketDataProvider.hpp>
+#include <Profiling/Profiling.hpp>
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
+#include <fmt/ranges.h>
+#include <pthread.h>
+#include <sched.h>
 #include <iostream>
 #include <fstream>
 #include <csignal>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <span>
+#include <thread>
 
 /**
  * @brief Main market data application (Excalibur equivalent)
@@ -16,29 +29,190 @@ public:
         try {
             loadConfiguration(configPath);
             
-            // Initialize stream managers
+            // Initialize token list from config
+            MarketDataProvider::TokenListT tokenList;
+            if (_config.contains("tokens")) {
+                for (const auto& token : _config["tokens"]) {
+                    tokenList.push_back(token.get<int>());
+                }
+            }
+            
+            // Streams are sharded round-robin over the workers; each worker
+            // owns one StreamManager with the books of its streams' tokens,
+            // so sharding needs to know which stream carries which token
             int streamCount = _config.value("stream_count", 4);
+            int workerCount = std::clamp(_config.value("worker_count", streamCount), 1, std::max(streamCount, 1));
+            std::map<size_t, MarketDataProvider::TokenListT> streamTokens;
+            if (_config.contains("stream_tokens")) {
+                for (const auto& [stream, tokens] : _config["stream_tokens"].items()) {
+                    streamTokens[std::stoul(stream)] = tokens.get<MarketDataProvider::TokenListT>();
+                }
+            } else if (workerCount > 1) {
+                spdlog::warn("No stream_tokens configured, running all {} streams on one worker", streamCount);
+                workerCount = 1;
+            }
+            MarketDataProvider::ShardLayout layout;
+            if (!MarketDataProvider::planShards(streamCount, workerCount, streamTokens, layout)) {
+                return false;
+            }
+            if (streamTokens.empty()) {
+                layout._workerTokens[0] = tokenList;
+            } else {
+                tokenList.clear();
+                for (const auto& tokens : layout._workerTokens) {
+                    tokenList.insert(tokenList.end(), tokens.begin(), tokens.end());
+                }
+            }
+            _streamWorkers = layout._streamWorkers;
+            _workerStreams = layout._workerStreams;
+            
+            const size_t queueCapacity = _config.value("packet_queue_capacity", MarketDataProvider::PACKET_QUEUE_CAPACITY);
+            const auto waitStrategy = _config.value("wait_strategy", std::string("busy_spin")) == "blocking"
+                ? MarketDataProvider::BLOCKING : MarketDataProvider::BUSY_SPIN;
             for (int i = 0; i < streamCount; ++i) {
+                _packetQueues.emplace_back(
+                    std::make_unique<PacketQueueT>(queueCapacity, waitStrategy)
+                );
+            }
+            for (int i = 0; i < workerCount; ++i) {
                 _streamManagers.emplace_back(
                     std::make_unique<MarketDataProvider::StreamManager>(1000)
                 );
             }
+            _workerCores = _config.value("worker_cores", std::vector<int>());
+            _reportedDrops.assign(streamCount, 0);
             
-            // Initialize token list from config
-            MarketDataProvider::TokenListT tokenList;
-            if (_config.contains("tokens")) {
-                for (const auto& token : _config["tokens"]) {
-                    tokenList.push_back(token.get<int>());
+            // One multicast feed per stream: group:port + stream index
+            MarketDataProvider::SocketConfig socketConfig;
+            socketConfig._interface = _config.value("interface", socketConfig._interface);
+            socketConfig._receiveBufferSize = _config.value("receive_buffer_size", socketConfig._receiveBufferSize);
+            socketConfig._busyPollMicros = _config.value("busy_poll_micros", socketConfig._busyPollMicros);
+            socketConfig._batchSize = _config.value("receive_batch_size", socketConfig._batchSize);
+            if (_config.value("socket_backend", std::string("recvmmsg")) == "io_uring") {
+                socketConfig._backend = MarketDataProvider::IO_URING;
+            }
+            socketConfig._bufferCount = _config.value("io_uring_buffers", socketConfig._bufferCount);
+            const std::string group = _config.value("multicast_group", std::string("239.1.1.1"));
+            const int port = _config.value("port", 9999);
+            for (int i = 0; i < streamCount; ++i) {
+                _sockets.emplace_back(
+                    std::make_unique<MarketDataProvider::NetworkSocket>(group, port + i, socketConfig)
+                );
+            }
+            
+            // Optional redundant line B, arbitrated against line A on the stream's worker
+            const std::string lineBGroup = _config.value("line_b_multicast_group", std::string());
+            if (!lineBGroup.empty()) {
+                const int lineBPort = _config.value("line_b_port", port);
+                for (int i = 0; i < streamCount; ++i) {
+                    _lineBQueues.emplace_back(
+                        std::make_unique<PacketQueueT>(queueCapacity, waitStrategy)
+                    );
+                    _lineBSockets.emplace_back(
+                        std::make_unique<MarketDataProvider::NetworkSocket>(lineBGroup, lineBPort + i, socketConfig)
+                    );
+                    _arbitrators.emplace_back(std::make_unique<MarketDataProvider::LineArbitrator>());
+                }
+                _reportedLineBDrops.assign(streamCount, 0);
+                spdlog::info("Line B enabled on {}:{}", lineBGroup, lineBPort);
+            }
+            
+            // Ladder backend and contract tick sizes
+            MarketDataProvider::BookConfig bookConfig;
+            if (_config.value("book_backend", std::string("flat_map")) == "tick_array") {
+                bookConfig._type = MarketDataProvider::TICK_ARRAY;
+            }
+            bookConfig._defaultTickSize = _config.value("tick_size", 1);
+            if (_config.contains("tick_sizes")) {
+                for (const auto& [token, tickSize] : _config["tick_sizes"].items()) {
+                    bookConfig._tickSizes[std::stoi(token)] = tickSize.get<int>();
                 }
             }
             
-            // Initialize all stream managers with token list
-            for (auto& manager : _streamManagers) {
-                manager->init(tokenList);
+            for (int i = 0; i < workerCount; ++i) {
+                _streamManagers[i]->init(layout._workerTokens[i], bookConfig);
             }
             
-            spdlog::info("MarketDataApp initialized with {} streams and {} tokens", 
-                         streamCount, tokenList.size());
+            // Latest books for slow in-process consumers, conflated per subscriber;
+            // subscribed first since it tracks the books through their deltas.
+            // One publisher per shard, so workers never share its change log
+            const size_t conflationLogCapacity =
+                _config.value("conflation_log_capacity", MarketDataProvider::CONFLATION_LOG_CAPACITY);
+            const auto bookSummaryInterval = std::chrono::milliseconds(_config.value("book_summary_interval_ms", 1000));
+            for (int i = 0; i < workerCount; ++i) {
+                _conflators.emplace_back(std::make_unique<MarketDataProvider::ConflatingPublisher>(
+                    layout._workerTokens[i], conflationLogCapacity));
+                _streamManagers[i]->subscribe([conflator = _conflators.back().get()](const MarketDataProvider::DepthUpdate& update) {
+                    conflator->onUpdate(update);
+                });
+                _bookSummaries.push_back(_conflators.back()->subscribe("book_summary", bookSummaryInterval));
+            }
+            
+            // Rebuild books before recovery and the journal are attached, so
+            // replayed gaps are not requested again and nothing is re-journaled
+            if (!openJournals()) {
+                return false;
+            }
+            
+            // Books for other local processes, shared by every worker
+            const std::string sharedDepthName = _config.value("shared_depth_name", std::string());
+            if (!sharedDepthName.empty()) {
+                _depthStore = std::make_unique<MarketDataProvider::SharedDepthStore>(sharedDepthName);
+                if (!_depthStore->create(tokenList)) {
+                    return false;
+                }
+                for (auto& manager : _streamManagers) {
+                    // Only books that have been built, so an idle stream does not blank another's
+                    manager->forEachLadderBuilder([this](const MarketDataProvider::LadderBuilder& builder) {
+                        if (builder.getVersion() > 0) {
+                            _depthStore->publish(builder);
+                        }
+                    });
+                    manager->setDepthStore(_depthStore.get());
+                }
+            }
+            
+            // Bars start with the live feed, journal replay does not rebuild them
+            if (!openBars()) {
+                return false;
+            }
+            
+            // Recent trades per token for readers on other threads, written by each shard
+            const size_t tapeCapacity = _config.value("trade_tape_capacity", MarketDataProvider::TRADE_TAPE_CAPACITY);
+            if (tapeCapacity > 0) {
+                for (auto& manager : _streamManagers) {
+                    MarketDataProvider::TokenListT tokens;
+                    manager->forEachLadderBuilder([&tokens](const MarketDataProvider::LadderBuilder& builder) {
+                        tokens.push_back(builder.getToken());
+                    });
+                    _tradeTapes.emplace_back(std::make_unique<MarketDataProvider::TradeTape>(tokens, tapeCapacity));
+                    manager->setTradeTape(_tradeTapes.back().get());
+                }
+            }
+            
+            // Per-stage latency per worker, attached after the journal replay so only live packets count
+            if (_config.value("latency_histograms", false)) {
+                for (auto& manager : _streamManagers) {
+                    _latencyRecorders.emplace_back(std::make_unique<MarketDataProvider::LatencyRecorder>());
+                    manager->setLatencyRecorder(_latencyRecorders.back().get());
+                }
+                _latencyReportInterval = std::chrono::seconds(_config.value("latency_report_interval_seconds", 60));
+                _nextLatencyReport = std::chrono::steady_clock::now() + _latencyReportInterval;
+            }
+            
+            // Gap recovery: one TCP session per worker, results wake it
+            const std::string recoveryHost = _config.value("recovery_host", std::string("localhost"));
+            const int recoveryPort = _config.value("recovery_port", 9998);
+            for (int i = 0; i < workerCount; ++i) {
+                _recoveries.emplace_back(
+                    std::make_unique<MarketDataProvider::Recovery>(recoveryHost, recoveryPort)
+                );
+                _recoveries[i]->setNotify([queue = _packetQueues[_workerStreams[i].front()].get()]() { queue->interrupt(); });
+                _streamManagers[i]->setRecovery(_recoveries[i].get());
+            }
+            
+            spdlog::info("MarketDataApp initialized with {} streams on {} workers and {} tokens", 
+                         streamCount, workerCount, tokenList.size());
             return true;
         } catch (const std::exception& e) {
             spdlog::error("Failed to initialize MarketDataApp: {}", e.what());
@@ -49,10 +223,36 @@ public:
     void run() {
         spdlog::info("Starting Market Data Provider...");
         
-        // Start data processing threads
+        // Start one processing thread per shard; this thread only monitors
         for (size_t i = 0; i < _streamManagers.size(); ++i) {
             _processingThreads.emplace_back([this, i]() {
-                processStream(i);
+                processShard(i);
+            });
+        }
+        
+        // Start receiving once the consumers are running
+        for (size_t i = 0; i < _sockets.size(); ++i) {
+            if (!_sockets[i]->connect()) {
+                spdlog::error("Stream {} failed to join its multicast feed", i);
+                continue;
+            }
+            _sockets[i]->startReceivingBatch([this, i](const MarketDataProvider::PacketView* packets, size_t count) {
+                for (size_t p = 0; p < count; ++p) {
+                    onPacket(i, LineA, packets[p]._data, packets[p]._size, packets[p]._rxNanos);
+                }
+                wakeWorker(i, LineA);
+            });
+        }
+        for (size_t i = 0; i < _lineBSockets.size(); ++i) {
+            if (!_lineBSockets[i]->connect()) {
+                spdlog::error("Stream {} failed to join its line B feed", i);
+                continue;
+            }
+            _lineBSockets[i]->startReceivingBatch([this, i](const MarketDataProvider::PacketView* packets, size_t count) {
+                for (size_t p = 0; p < count; ++p) {
+                    onPacket(i, LineB, packets[p]._data, packets[p]._size, packets[p]._rxNanos);
+                }
+                wakeWorker(i, LineB);
             });
         }
         
@@ -68,13 +268,41 @@ public:
             }
         }
         
-        // Wait for processing threads to finish
+        for (auto& socket : _sockets) {
+            socket->disconnect();
+        }
+        for (auto& socket : _lineBSockets) {
+            socket->disconnect();
+        }
+        
+        // Wake workers blocked on an empty queue, then wait for them to finish
+        for (auto& queue : _packetQueues) {
+            queue->interrupt();
+        }
         for (auto& thread : _processingThreads) {
             if (thread.joinable()) {
                 thread.join();
             }
         }
         
+        reportArbitration();
+        reportLatency();
+        
+        // Final snapshot so the next start replays as little as possible
+        for (size_t i = 0; i < _checkpoints.size(); ++i) {
+            _checkpoints[i]->flush();
+            _checkpoints[i]->save(*_streamManagers[i], _journals[i]->getPosition());
+            _checkpoints[i]->flush();
+        }
+        for (auto& journal : _journals) {
+            journal->close();
+        }
+        for (auto& file : _barFiles) {
+            file->close();
+        }
+        if (_depthStore) {
+            _depthStore->close();
+        }
         spdlog::info("Market Data Provider stopped");
     }
     
@@ -83,7 +311,38 @@ public:
     }
 
 private:
-    std::vector<std::unique_ptr<MarketDataProvider::StreamManager>> _streamManagers;
+    using PacketQueueT = MarketDataProvider::SpscRingBuffer<MarketDataProvider::PacketSlot>;
+
+    static constexpr size_t PacketBatchSize = 64;
+    static constexpr size_t LineA = 0;
+    static constexpr size_t LineB = 1;
+
+    std::vector<std::unique_ptr<MarketDataProvider::StreamManager>> _streamManagers;   // One per worker
+    std::vector<std::vector<size_t>> _workerStreams;
+    std::vector<size_t> _streamWorkers;
+    std::vector<int> _workerCores;
+    std::vector<std::unique_ptr<PacketQueueT>> _packetQueues;
+    std::vector<std::unique_ptr<MarketDataProvider::NetworkSocket>> _sockets;
+    std::vector<std::unique_ptr<MarketDataProvider::Recovery>> _recoveries;
+    std::vector<std::unique_ptr<PacketQueueT>> _lineBQueues;
+    std::vector<std::unique_ptr<MarketDataProvider::NetworkSocket>> _lineBSockets;
+    std::vector<std::unique_ptr<MarketDataProvider::LineArbitrator>> _arbitrators;
+    std::vector<std::unique_ptr<MarketDataProvider::Journal>> _journals;
+    std::vector<std::unique_ptr<MarketDataProvider::Checkpoint>> _checkpoints;
+    std::vector<std::chrono::steady_clock::time_point> _nextCheckpoints;
+    std::unique_ptr<MarketDataProvider::SharedDepthStore> _depthStore;
+    std::vector<std::unique_ptr<MarketDataProvider::BarAggregator>> _barAggregators;   // One per worker when bars are configured
+    std::vector<std::unique_ptr<MarketDataProvider::BarFile>> _barFiles;
+    uint64_t _barCloseDelayNanos = 0;
+    std::vector<std::unique_ptr<MarketDataProvider::TradeTape>> _tradeTapes;   // One per worker
+    std::vector<std::unique_ptr<MarketDataProvider::LatencyRecorder>> _latencyRecorders;   // One per worker when enabled
+    std::chrono::seconds _latencyReportInterval{60};
+    std::chrono::steady_clock::time_point _nextLatencyReport;
+    std::vector<std::unique_ptr<MarketDataProvider::ConflatingPublisher>> _conflators;   // One per worker
+    std::vector<std::unique_ptr<MarketDataProvider::ConflatedSubscriber>> _bookSummaries;
+    std::chrono::seconds _checkpointInterval{60};
+    std::vector<uint64_t> _reportedDrops;
+    std::vector<uint64_t> _reportedLineBDrops;
     std::vector<std::thread> _processingThreads;
     std::atomic<bool> _running{true};
     nlohmann::json _config;
@@ -106,40 +365,400 @@ private:
     nlohmann::json createDefaultConfig() {
         nlohmann::json config;
         config["stream_count"] = 4;
+        config["worker_count"] = 4;
+        config["worker_cores"] = nlohmann::json::array();
         config["host"] = "localhost";
         config["port"] = 9999;
+        config["multicast_group"] = "239.1.1.1";
+        config["line_b_multicast_group"] = "";
+        config["line_b_port"] = 9999;
+        config["interface"] = "0.0.0.0";
+        config["receive_buffer_size"] = 16 * 1024 * 1024;
+        config["busy_poll_micros"] = 0;
+        config["receive_batch_size"] = 64;
+        config["socket_backend"] = "recvmmsg";
+        config["io_uring_buffers"] = 1024;
         config["recovery_host"] = "localhost";
         config["recovery_port"] = 9998;
+        config["journal_directory"] = "journal";
+        config["journal_segment_size"] = 256 * 1024 * 1024;
+        config["checkpoint_directory"] = "checkpoints";
+        config["checkpoint_interval_seconds"] = 60;
+        config["shared_depth_name"] = "mdp_depth";
+        config["bars"] = nlohmann::json::array({"1s", "1m", "5m"});
+        config["bar_directory"] = "bars";
+        config["bar_close_delay_ms"] = 1000;
+        config["trade_tape_capacity"] = MarketDataProvider::TRADE_TAPE_CAPACITY;
+        config["latency_histograms"] = true;
+        config["latency_report_interval_seconds"] = 60;
+        config["conflation_log_capacity"] = MarketDataProvider::CONFLATION_LOG_CAPACITY;
+        config["book_summary_interval_ms"] = 1000;
         config["tokens"] = nlohmann::json::array({35019, 35020, 35021, 35022});
+        config["stream_tokens"] = {{"0", nlohmann::json::array({35019})}, {"1", nlohmann::json::array({35020})},
+                                   {"2", nlohmann::json::array({35021})}, {"3", nlohmann::json::array({35022})}};
+        config["book_backend"] = "flat_map";
+        config["tick_size"] = 5;
+        config["packet_queue_capacity"] = MarketDataProvider::PACKET_QUEUE_CAPACITY;
+        config["wait_strategy"] = "busy_spin";
         return config;
     }
     
-    void processStream(size_t streamIndex) {
-        spdlog::info("Starting stream processor {}", streamIndex);
+    /**
+     * @brief Trading session the journal and checkpoints are stamped with
+     *
+     * "session" in the config, by default today's local date as YYYYMMDD,
+     * so a restart during the day resumes the day's books and the first
+     * start of a day begins empty.
+     */
+    uint64_t currentSession() const {
+        if (_config.contains("session")) {
+            return _config["session"].get<uint64_t>();
+        }
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        ::localtime_r(&now, &local);
+        return static_cast<uint64_t>(local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday;
+    }
+    
+    /**
+     * @brief Warm start each shard, then start journaling it
+     *
+     * Books are restored from the shard's newest checkpoint of the current
+     * session and the journal written since is replayed on top; without one
+     * the session's whole journal is replayed. Segments and snapshots of
+     * earlier sessions are ignored. The new run journals into fresh segments.
+     */
+    bool openJournals() {
+        const std::string journalDirectory = _config.value("journal_directory", std::string());
+        if (journalDirectory.empty()) {
+            return true;
+        }
+        MarketDataProvider::JournalConfig journalConfig;
+        journalConfig._directory = journalDirectory;
+        journalConfig._segmentSize = _config.value("journal_segment_size", journalConfig._segmentSize);
+        journalConfig._session = currentSession();
+        
+        // Checkpoints are only useful with the journal tail behind them
+        MarketDataProvider::CheckpointConfig checkpointConfig;
+        checkpointConfig._directory = _config.value("checkpoint_directory", std::string());
+        checkpointConfig._session = journalConfig._session;
+        _checkpointInterval = std::chrono::seconds(_config.value("checkpoint_interval_seconds", 60));
+        
+        for (size_t i = 0; i < _streamManagers.size(); ++i) {
+            auto& manager = *_streamManagers[i];
+            journalConfig._prefix = "shard" + std::to_string(i);
+            
+            MarketDataProvider::JournalPosition position;
+            bool restored = false;
+            if (!checkpointConfig._directory.empty()) {
+                checkpointConfig._prefix = journalConfig._prefix;
+                _checkpoints.emplace_back(std::make_unique<MarketDataProvider::Checkpoint>(checkpointConfig));
+                restored = _checkpoints[i]->restore(manager, position);
+                _nextCheckpoints.push_back(std::chrono::steady_clock::now() + _checkpointInterval);
+            }
+            
+            if (!MarketDataProvider::listJournalSegments(journalDirectory, journalConfig._prefix,
+                                                         journalConfig._session).empty()) {
+                MarketDataProvider::JournalReader reader(journalDirectory, journalConfig._prefix, journalConfig._session);
+                if (!reader.open() || (restored && !reader.seek(position))) {
+                    return false;
+                }
+                MarketDataProvider::ReplayConfig replayConfig;
+                replayConfig._measureLatency = false;
+                const auto stats = MarketDataProvider::ReplayDriver(manager, replayConfig).run(reader);
+                spdlog::info("Stream {} replayed {} journaled messages in {:.3f} ms", i, stats._messages,
+                             stats._elapsedNanos / 1e6);
+            }
+            
+            _journals.emplace_back(std::make_unique<MarketDataProvider::Journal>(journalConfig));
+            if (!_journals[i]->open()) {
+                return false;
+            }
+            manager.setJournal(_journals[i].get());
+        }
+        return true;
+    }
+    
+    /**
+     * @brief One bar aggregator per shard over the tokens it builds
+     *
+     * Closed bars are logged and, with a bar directory, appended to the
+     * shard's columnar bar file.
+     */
+    bool openBars() {
+        if (!_config.contains("bars") || _config["bars"].empty()) {
+            return true;
+        }
+        std::vector<MarketDataProvider::BarSpec> specs;
+        for (const auto& text : _config["bars"]) {
+            MarketDataProvider::BarSpec spec;
+            if (!MarketDataProvider::parseBarSpec(text.get<std::string>(), spec)) {
+                spdlog::error("Invalid bar spec {}", text.dump());
+                return false;
+            }
+            specs.push_back(spec);
+        }
+        _barCloseDelayNanos = _config.value("bar_close_delay_ms", 1000ULL) * 1'000'000ULL;
+        
+        const std::string barDirectory = _config.value("bar_directory", std::string());
+        if (!barDirectory.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(barDirectory, error);
+            if (error) {
+                spdlog::error("Cannot create bar directory {}: {}", barDirectory, error.message());
+                return false;
+            }
+        }
+        
+        for (size_t i = 0; i < _streamManagers.size(); ++i) {
+            MarketDataProvider::TokenListT tokens;
+            _streamManagers[i]->forEachLadderBuilder([&tokens](const MarketDataProvider::LadderBuilder& builder) {
+                tokens.push_back(builder.getToken());
+            });
+            _barAggregators.emplace_back(std::make_unique<MarketDataProvider::BarAggregator>(tokens, specs));
+            auto& bars = *_barAggregators[i];
+            bars.subscribe([](const MarketDataProvider::Bar& bar) {
+                spdlog::debug("Token {} bar {}: O {} H {} L {} C {} V {} ({} trades)", bar._token, bar._spec,
+                              bar._open, bar._high, bar._low, bar._close, bar._volume, bar._trades);
+            });
+            if (!barDirectory.empty()) {
+                _barFiles.emplace_back(std::make_unique<MarketDataProvider::BarFile>());
+                if (!_barFiles[i]->open(barDirectory + "/shard" + std::to_string(i) + ".bars")) {
+                    return false;
+                }
+                bars.setBarFile(_barFiles[i].get());
+            }
+            _streamManagers[i]->setBarAggregator(&bars);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Worker side: close time bars the quiet feed has not closed
+     *
+     * Waits out the close delay past the interval so late trades still land in it.
+     * Cheap between bar boundaries, the aggregator only scans once one has passed.
+     */
+    void closeBars(size_t workerIndex) {
+        if (_barAggregators.empty()) {
+            return;
+        }
+        const auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        _barAggregators[workerIndex]->closeExpired(now - _barCloseDelayNanos);
+    }
+    
+    /**
+     * @brief Worker side: snapshot the shard's books once the interval has passed
+     */
+    void checkpoint(size_t workerIndex) {
+        if (_checkpoints.empty()) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now < _nextCheckpoints[workerIndex]) {
+            return;
+        }
+        // A skipped save is retried on the next batch
+        if (_checkpoints[workerIndex]->save(*_streamManagers[workerIndex], _journals[workerIndex]->getPosition())) {
+            _nextCheckpoints[workerIndex] = now + _checkpointInterval;
+        }
+    }
+    
+    /**
+     * @brief Receive thread side: copy a datagram into the stream's queue
+     *
+     * Never blocks; when book building falls behind the packet is dropped
+     * and counted so the kernel socket buffer keeps draining.
+     */
+    void onPacket(size_t streamIndex, size_t line, const char* data, size_t size, uint64_t rxNanos) {
+        auto& queue = line == LineA ? *_packetQueues[streamIndex] : *_lineBQueues[streamIndex];
+        if (size > MarketDataProvider::MAX_PACKET_SIZE) {
+            spdlog::warn("Stream {} dropped oversized packet of {} bytes", streamIndex, size);
+            return;
+        }
+        MarketDataProvider::PacketSlot* slot = queue.claim();
+        if (!slot) {
+            return;
+        }
+        slot->_rxNanos = rxNanos;
+        slot->_size = static_cast<uint32_t>(size);
+        std::memcpy(slot->_data, data, size);
+        queue.publish();
+    }
+    
+    /**
+     * @brief Wake the worker of streamIndex after its receive thread queued packets
+     *
+     * A worker waits on its first stream's line A queue, so packets for any
+     * of its other queues interrupt that wait.
+     */
+    void wakeWorker(size_t streamIndex, size_t line) {
+        const size_t waitStream = _workerStreams[_streamWorkers[streamIndex]].front();
+        if (line == LineB || streamIndex != waitStream) {
+            _packetQueues[waitStream]->interrupt();
+        }
+    }
+    
+    /**
+     * @brief Pin the calling thread to core, -1 leaves it to the scheduler
+     */
+    static void pinThread(size_t workerIndex, int core) {
+        if (core < 0) {
+            return;
+        }
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error != 0) {
+            spdlog::warn("Worker {} cannot be pinned to core {}: {}", workerIndex, core, std::strerror(error));
+            return;
+        }
+        spdlog::info("Worker {} pinned to core {}", workerIndex, core);
+#else
+        spdlog::warn("Worker {} cannot be pinned to core {} on this platform", workerIndex, core);
+#endif
+    }
+    
+    /**
+     * @brief Worker thread: round-robin batches over its streams into its own books
+     *
+     * With line B each stream's lines are arbitrated, B drained before A so
+     * the first copy of each packet wins.
+     */
+    void processShard(size_t workerIndex) {
+        pinThread(workerIndex, workerIndex < _workerCores.size() ? _workerCores[workerIndex] : -1);
+        PROFILE_THREAD(fmt::format("MarketData worker {}", workerIndex).c_str());
+        spdlog::info("Starting worker {} for streams {}", workerIndex, fmt::join(_workerStreams[workerIndex], ", "));
+        
+        auto& manager = *_streamManagers[workerIndex];
+        const auto& streams = _workerStreams[workerIndex];
+        auto& waitQueue = *_packetQueues[streams.front()];
+        auto fromLine = [this, &manager](size_t stream, size_t line) {
+            return [this, &manager, stream, line](const MarketDataProvider::PacketSlot& slot) {
+                if (_arbitrators.empty() || _arbitrators[stream]->accept(line, slot._data, slot._size, slot._rxNanos)) {
+                    manager.process(slot._data, slot._size, slot._rxNanos);
+                }
+            };
+        };
+        // Accepted packets of a span go through processBatch so their books are prefetched
+        std::vector<MarketDataProvider::PacketView> batch;
+        batch.reserve(PacketBatchSize);
+        auto spansFromLine = [this, &manager, &batch](size_t stream, size_t line) {
+            return [this, &manager, &batch, stream, line](std::span<const MarketDataProvider::PacketSlot> slots) {
+                batch.clear();
+                for (const auto& slot : slots) {
+                    if (_arbitrators.empty() || _arbitrators[stream]->accept(line, slot._data, slot._size, slot._rxNanos)) {
+                        batch.push_back({slot._data, slot._size, slot._rxNanos});
+                    }
+                }
+                manager.processBatch(batch);
+            };
+        };
         
         while (_running) {
             try {
-                // Simulate market data processing
-                // In a real implementation, this would:
-                // - Receive data from network socket
-                // - Parse market data messages
-                // - Update order books
-                // - Publish market data updates
-                
-                // Placeholder for actual data processing
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                
+                // Read the signal before draining so packets queued after the
+                // drain still wake the wait
+                const uint32_t signal = waitQueue.interrupts();
+                size_t processed = 0;
+                for (size_t stream : streams) {
+                    if (!_lineBQueues.empty()) {
+                        processed += _lineBQueues[stream]->popSpans(spansFromLine(stream, LineB), PacketBatchSize);
+                    }
+                    processed += _packetQueues[stream]->popSpans(spansFromLine(stream, LineA), PacketBatchSize);
+                }
+                if (processed == 0) {
+                    waitQueue.waitPopBatch(fromLine(streams.front(), LineA), PacketBatchSize, _running, signal);
+                }
+                // Recovered packets may arrive while the feed is quiet
+                manager.pollRecovery();
+                checkpoint(workerIndex);
+                closeBars(workerIndex);
+                PROFILE_PLOT("Packet queue depth", static_cast<int64_t>(waitQueue.size()));
+                PROFILE_FRAME("MarketData worker");
             } catch (const std::exception& e) {
-                spdlog::error("Error in stream processor {}: {}", streamIndex, e.what());
+                spdlog::error("Error in worker {}: {}", workerIndex, e.what());
             }
         }
         
-        spdlog::info("Stream processor {} stopped", streamIndex);
+        spdlog::info("Worker {} stopped", workerIndex);
+    }
+    
+    void reportArbitration() {
+        for (size_t i = 0; i < _arbitrators.size(); ++i) {
+            for (size_t line : {LineA, LineB}) {
+                const auto stats = _arbitrators[i]->getLineStats(line);
+                spdlog::info("Stream {} line {}: {} packets, won {}, duplicates {}, stale {}, mean lead {:.1f}us, max lead {:.1f}us",
+                             i, line == LineA ? 'A' : 'B', stats._packets, stats._won, stats._duplicates, stats._stale,
+                             stats._leadSamples ? stats._leadNanos / 1000.0 / stats._leadSamples : 0.0,
+                             stats._maxLeadNanos / 1000.0);
+            }
+        }
+    }
+    
+    void reportLatency() {
+        for (size_t i = 0; i < _latencyRecorders.size(); ++i) {
+            _latencyRecorders[i]->report("Worker " + std::to_string(i));
+        }
     }
     
     void monitorSystem() {
         // Monitor system health, memory usage, connection status, etc.
-        // Placeholder for system monitoring
+#ifdef TRADING_PLATFORM_PROFILING
+        // Called about once a second, so the change in packets queued is the rate
+        static uint64_t plottedPushed = 0;
+        uint64_t pushed = 0;
+        for (const auto& queue : _packetQueues) {
+            pushed += queue->pushed();
+        }
+        PROFILE_PLOT("Packets per second", static_cast<int64_t>(pushed - plottedPushed));
+        plottedPushed = pushed;
+#endif
+        for (auto& bookSummary : _bookSummaries) {
+            bookSummary->poll([](const MarketDataProvider::ConflatedDepth& depth) {
+                spdlog::debug("Token {} v{} ({} conflated): bid {}@{} ask {}@{}", depth._depth._token, depth._version,
+                              depth._skipped, depth._depth._bid[0]._quantity, depth._depth._bid[0]._price,
+                              depth._depth._ask[0]._quantity, depth._depth._ask[0]._price);
+            });
+        }
+        if (spdlog::should_log(spdlog::level::debug)) {
+            for (const auto& tape : _tradeTapes) {
+                for (const auto token : tape->getTokens()) {
+                    MarketDataProvider::TapeSummary summary;
+                    if (tape->summarize(token, tape->getCapacity(), summary) && summary._trades > 0) {
+                        spdlog::debug("Token {} last {} trades: bought {} sold {} realized variance {:.3g}", token,
+                                      summary._trades, summary._buyVolume, summary._sellVolume, summary._realizedVariance);
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < _packetQueues.size(); ++i) {
+            const auto& queue = *_packetQueues[i];
+            const uint64_t drops = queue.drops();
+            if (drops != _reportedDrops[i]) {
+                spdlog::warn("Stream {} packet queue dropped {} packets (occupancy {}/{})",
+                             i, drops - _reportedDrops[i], queue.size(), queue.capacity());
+                _reportedDrops[i] = drops;
+            }
+        }
+        // Histograms are read live while the workers keep recording
+        if (!_latencyRecorders.empty() && _latencyReportInterval.count() > 0 &&
+            std::chrono::steady_clock::now() >= _nextLatencyReport) {
+            reportLatency();
+            _nextLatencyReport = std::chrono::steady_clock::now() + _latencyReportInterval;
+        }
+        for (size_t i = 0; i < _lineBQueues.size(); ++i) {
+            const auto& queue = *_lineBQueues[i];
+            const uint64_t drops = queue.drops();
+            if (drops != _reportedLineBDrops[i]) {
+                spdlog::warn("Stream {} line B queue dropped {} packets (occupancy {}/{})",
+                             i, drops - _reportedLineBDrops[i], queue.size(), queue.capacity());
+                _reportedLineBDrops[i] = drops;
+            }
+        }
     }
 };
 
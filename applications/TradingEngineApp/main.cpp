@@ -1,9 +1,15 @@
 #include <TradingEngine/TradingEngine.hpp>
 #include <DatabaseLayer/DatabaseLayer.hpp>
+#include <MarketDataProvider/SharedDepthStore.hpp>
+#include <Profiling/Profiling.hpp>
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
 
 /**
  * @brief Main trading engine application (Merlin equivalent)
@@ -25,6 +31,13 @@ public:
                 handleOrderUpdate(order);
             });
             
+            // Books published by MarketDataApp; attached again whenever it restarts
+            const std::string sharedDepthName = _config.value("shared_depth_name", std::string("mdp_depth"));
+            if (!sharedDepthName.empty()) {
+                _depthStore = std::make_unique<MarketDataProvider::SharedDepthStore>(sharedDepthName);
+                attachMarketData();
+            }
+            
             spdlog::info("TradingEngineApp initialized successfully");
             return true;
         } catch (const std::exception& e) {
@@ -41,6 +54,7 @@ public:
             try {
                 // Process incoming orders, market data, etc.
                 processMessages();
+                PROFILE_FRAME("TradingEngine loop");
                 
                 // Small delay to prevent busy waiting
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -55,9 +69,18 @@ public:
     void stop() {
         _running = false;
     }
+    
+    /**
+     * @brief Latest book for token from MarketDataApp, false if not available
+     */
+    bool getMarketData(MarketDataProvider::TokenT token, MarketDataProvider::SharedDepth& depth) const {
+        return _depthStore && _depthStore->isLive() && _depthStore->read(token, depth);
+    }
 
 private:
     std::unique_ptr<TradingEngine::OrderManager> _orderManager;
+    std::unique_ptr<MarketDataProvider::SharedDepthStore> _depthStore;
+    std::chrono::steady_clock::time_point _lastAttach;
     std::atomic<bool> _running{true};
     nlohmann::json _config;
     
@@ -71,7 +94,20 @@ private:
         spdlog::info("Configuration loaded from: {}", configPath);
     }
     
+    void attachMarketData() {
+        _lastAttach = std::chrono::steady_clock::now();
+        if (_depthStore->attach()) {
+            spdlog::info("Reading market data for {} tokens", _depthStore->getTokens().size());
+        }
+    }
+    
     void processMessages() {
+        PROFILE_ZONE();
+        if (_depthStore && !_depthStore->isLive() &&
+            std::chrono::steady_clock::now() - _lastAttach >= std::chrono::seconds(5)) {
+            attachMarketData();
+        }
+        
         // Placeholder for message processing
         // In a real implementation, this would handle:
         // - Client connections
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <MarketDataProvider/MessageDecoder.hpp>
+#include <MarketDataProvider/Structure.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace Benchmark {
+
+/**
+ * @brief Contiguous store of pre-built market data packets, messages in NSE wire form
+ */
+struct PacketStore {
+    std::vector<char>   _bytes;
+    std::vector<size_t> _offsets;
+    std::vector<size_t> _sizes;
+
+    template <typename MessageT>
+    void append(int sequence_, char type_, const MessageT& message_, short streamId_ = 0) {
+        const auto wire = MarketDataProvider::NseDecoder::encode(message_);
+        const size_t size = sizeof(MarketDataProvider::StreamHeader) + 1 + sizeof(wire);
+
+        MarketDataProvider::StreamHeader header{};
+        header._len = static_cast<short>(size);
+        header._streamId = streamId_;
+        header._sequence = sequence_;
+        header._type = type_;
+
+        const size_t offset = _bytes.size();
+        _bytes.resize(offset + size);
+        std::memcpy(_bytes.data() + offset, &header, sizeof(header));
+        _bytes[offset + sizeof(header)] = type_;
+        std::memcpy(_bytes.data() + offset + sizeof(header) + 1, &wire, sizeof(wire));
+
+        _offsets.push_back(offset);
+        _sizes.push_back(size);
+    }
+
+    size_t      count() const { return _offsets.size(); }
+    const char* data(size_t index_) const { return _bytes.data() + _offsets[index_]; }
+    size_t      size(size_t index_) const { return _sizes[index_]; }
+};
+
+/**
+ * @brief Time a callable and return elapsed nanoseconds
+ */
+template <typename FunctionT>
+double timeNanos(FunctionT&& function_) {
+    const auto start = std::chrono::steady_clock::now();
+    function_();
+    const auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+/**
+ * @brief Keep a computed value observable so the work is not optimised away
+ */
+template <typename ValueT>
+inline void doNotOptimize(const ValueT& value_) {
+    asm volatile("" : : "r,m"(value_) : "memory");
+}
+
+inline void report(const char* name_, size_t operations_, double nanos_) {
+    std::printf("%-40s %12zu ops %10.2f ns/op %14.0f ops/s\n",
+                name_, operations_, nanos_ / operations_, operations_ * 1e9 / nanos_);
+}
+
+} // namespace Benchmark
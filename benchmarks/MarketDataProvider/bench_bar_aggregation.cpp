@@ -0,0 +1,79 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/BarAggregator.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+void run(const char* name_, const std::vector<MarketDataProvider::TokenT>& tokens_,
+         const std::vector<MarketDataProvider::TradeMessage>& trades_, MarketDataProvider::BarFile* file_) {
+    std::vector<MarketDataProvider::BarSpec> specs;
+    for (const char* text : {"1s", "1m", "5m", "volume:5000", "ticks:100"}) {
+        MarketDataProvider::BarSpec spec;
+        MarketDataProvider::parseBarSpec(text, spec);
+        specs.push_back(spec);
+    }
+    MarketDataProvider::BarAggregator bars(tokens_, specs);
+    uint64_t closed = 0;
+    bars.subscribe([&closed](const MarketDataProvider::Bar& bar_) { closed += bar_._trades; });
+    bars.setBarFile(file_);
+
+    const double nanos = Benchmark::timeNanos([&] {
+        for (const auto& trade : trades_) {
+            bars.onTrade(trade);
+        }
+    });
+    Benchmark::doNotOptimize(closed);
+    Benchmark::report(name_, trades_.size(), nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Per-trade cost of building 1s/1m/5m, volume and tick bars, with and without the bar file
+ *
+ * Trades land on random tokens about every 20us of exchange time, so the
+ * one second bars close constantly and the bar file sees a steady stream.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t TokenCount = 2'000;
+    constexpr size_t TradeCount = 5'000'000;
+
+    std::vector<MarketDataProvider::TokenT> tokens;
+    for (size_t i = 0; i < TokenCount; ++i) {
+        tokens.push_back(static_cast<int>(35000 + i));
+    }
+
+    std::mt19937 rng(42);
+    std::vector<MarketDataProvider::TradeMessage> trades(TradeCount);
+    MarketDataProvider::TimestampT timestamp = 1'700'000'000'000'000'000ULL;
+    for (auto& trade : trades) {
+        timestamp += rng() % 40'000;
+        trade._timeStamp = timestamp;
+        trade._token = tokens[rng() % TokenCount];
+        trade._price = 9900 + static_cast<int>(rng() % 200);
+        trade._quantity = 1 + static_cast<int>(rng() % 100);
+    }
+
+    run("bars/in_memory", tokens, trades, nullptr);
+
+    const auto path = std::filesystem::temp_directory_path() / ("mdp_bench_" + std::to_string(::getpid()) + ".bars");
+    {
+        MarketDataProvider::BarFile file;
+        if (file.open(path.string())) {
+            run("bars/columnar_file", tokens, trades, &file);
+            file.close();
+            std::printf("%-40s %llu bars, %llu dropped, %ju bytes\n", "", static_cast<unsigned long long>(file.getBarsWritten()),
+                        static_cast<unsigned long long>(file.getBarsDropped()),
+                        static_cast<uintmax_t>(std::filesystem::file_size(path)));
+        }
+    }
+    std::filesystem::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/MarketDataProvider.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+
+namespace {
+
+constexpr size_t TokenCount = 10'000;
+constexpr size_t BatchSize = 64;
+
+/**
+ * @brief The same messages packed messages_ to a datagram
+ */
+Benchmark::PacketStore pack(const Benchmark::PacketStore& store_, size_t messages_) {
+    Benchmark::PacketStore packed;
+    packed._bytes = store_._bytes;
+    for (size_t i = 0; i < store_.count(); i += messages_) {
+        size_t size = 0;
+        for (size_t j = i; j < std::min(i + messages_, store_.count()); ++j) {
+            size += store_.size(j);
+        }
+        packed._offsets.push_back(store_._offsets[i]);
+        packed._sizes.push_back(size);
+    }
+    return packed;
+}
+
+void run(const char* name_, const MarketDataProvider::TokenListT& tokens_, const Benchmark::PacketStore& store_,
+         size_t messages_, bool batch_) {
+    // Tick arrays keep the ladder cost flat, so what differs is lookup and cache behaviour
+    MarketDataProvider::BookConfig config;
+    config._type = MarketDataProvider::TICK_ARRAY;
+    MarketDataProvider::StreamManager manager(0);
+    manager.init(tokens_, config);
+
+    std::vector<MarketDataProvider::PacketView> views;
+    views.reserve(BatchSize);
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        if (!batch_) {
+            for (size_t i = 0; i < packets; ++i) {
+                manager.process(store_.data(i), store_.size(i));
+            }
+            return;
+        }
+        for (size_t i = 0; i < packets; i += BatchSize) {
+            views.clear();
+            for (size_t j = i; j < std::min(i + BatchSize, packets); ++j) {
+                views.push_back({store_.data(j), store_.size(j), 0});
+            }
+            manager.processBatch(views);
+        }
+    });
+    Benchmark::report(name_, packets * messages_, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Messages/sec through process() against processBatch(), one and eight messages per datagram
+ *
+ * Orders land on random tokens of a large subscription and are cancelled a
+ * while later, so the order tables a message touches are rarely in cache
+ * and the prefetch distance has misses to hide.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    constexpr size_t MessageCount = 1'000'000;
+    constexpr size_t RestingOrders = 100'000;
+
+    MarketDataProvider::TokenListT tokens;
+    for (size_t i = 0; i < TokenCount; ++i) {
+        tokens.push_back(static_cast<int>(35000 + i * 3));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> tokenPick(0, TokenCount - 1);
+    std::uniform_int_distribution<int> pricePick(9900, 10100);
+
+    Benchmark::PacketStore store;
+    std::vector<MarketDataProvider::OrderMessage> live;
+    int sequence = 0;
+    MarketDataProvider::OrderIdT orderId = 0;
+    while (store.count() < MessageCount) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = ++orderId;
+        order._token = tokens[tokenPick(rng)];
+        order._orderType = (rng() & 1) ? 'B' : 'S';
+        order._price = pricePick(rng);
+        order._quantity = 1 + static_cast<int>(rng() % 100);
+        store.append(++sequence, MarketDataProvider::NEW, order);
+        live.push_back(order);
+
+        if (live.size() > RestingOrders) {
+            store.append(++sequence, MarketDataProvider::CANCEL, live[live.size() - RestingOrders - 1]);
+        }
+    }
+    const Benchmark::PacketStore packed = pack(store, 8);
+
+    run("process/1 message per packet", tokens, store, 1, false);
+    run("processBatch/1 message per packet", tokens, store, 1, true);
+    run("process/8 messages per packet", tokens, packed, 8, false);
+    run("processBatch/8 messages per packet", tokens, packed, 8, true);
+
+    return 0;
+}
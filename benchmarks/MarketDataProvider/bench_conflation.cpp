@@ -0,0 +1,87 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/ConflatingPublisher.hpp>
+#include <MarketDataProvider/LadderBuilder.hpp>
+#include <MarketDataProvider/StreamManager.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+constexpr int Tokens = 64;
+
+void run(const char* name_, const Benchmark::PacketStore& store_, bool conflate_, int subscribers_) {
+    MarketDataProvider::TokenListT tokens;
+    for (int i = 0; i < Tokens; ++i) {
+        tokens.push_back(35000 + i);
+    }
+    MarketDataProvider::StreamManager manager(1);
+    manager.init(tokens);
+    MarketDataProvider::ConflatingPublisher publisher(tokens);
+    if (conflate_) {
+        manager.subscribe([&publisher](const MarketDataProvider::DepthUpdate& update_) { publisher.onUpdate(update_); });
+    }
+
+    // Slow consumers polling every millisecond on their own thread
+    std::vector<std::unique_ptr<MarketDataProvider::ConflatedSubscriber>> subscribers;
+    for (int i = 0; i < subscribers_; ++i) {
+        subscribers.push_back(publisher.subscribe("bench", std::chrono::milliseconds(1)));
+    }
+    std::atomic<bool> running{true};
+    uint64_t delivered = 0;
+    std::thread consumer([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            for (auto& subscriber : subscribers) {
+                delivered += subscriber->poll([](const MarketDataProvider::ConflatedDepth& depth_) {
+                    Benchmark::doNotOptimize(depth_._depth._bid[0]._price);
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets; ++i) {
+            manager.process(store_.data(i), store_.size(i));
+        }
+    });
+    running = false;
+    consumer.join();
+
+    Benchmark::report(name_, packets, nanos);
+    if (subscribers_) {
+        std::printf("%-40s %12llu token states delivered\n", "", static_cast<unsigned long long>(delivered));
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Feed handler cost of conflated distribution as slow subscribers are added
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 2'000'000;
+
+    // Add and cancel at the top of book so nearly every event publishes a change
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = static_cast<MarketDataProvider::OrderIdT>(i % 2 ? i - 1 : i);
+        order._token = 35000 + static_cast<int>((i / 2) % Tokens);
+        order._orderType = 'B';
+        order._price = 100 + static_cast<int>(i % 16);
+        order._quantity = 10;
+        store.append(static_cast<int>(i + 1), i % 2 ? MarketDataProvider::CANCEL : MarketDataProvider::NEW, order);
+    }
+
+    run("process/no_conflation", store, false, 0);
+    run("process/conflation_0_subscribers", store, true, 0);
+    run("process/conflation_1_subscriber", store, true, 1);
+    run("process/conflation_16_subscribers", store, true, 16);
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/Journal.hpp>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+#include <filesystem>
+
+namespace {
+
+void run(const char* name_, const Benchmark::PacketStore& store_, size_t segmentSize_) {
+    const auto directory = std::filesystem::temp_directory_path() / ("bench_journal_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig config;
+    config._directory = directory.string();
+    config._segmentSize = segmentSize_;
+    MarketDataProvider::Journal journal(config);
+    if (!journal.open()) {
+        std::printf("%-40s cannot open journal in %s\n", name_, config._directory.c_str());
+        return;
+    }
+
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets; ++i) {
+            journal.append(store_.data(i), store_.size(i), 0, i);
+        }
+    });
+
+    const auto stats = journal.getStats();
+    Benchmark::report(name_, packets, nanos);
+    std::printf("%-40s %12llu segments %8llu stalls %10.1f MB/s\n", "",
+                static_cast<unsigned long long>(stats._segments), static_cast<unsigned long long>(stats._stalls),
+                stats._bytes * 1e3 / nanos);
+
+    journal.close();
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace
+
+/**
+ * @brief Cost of journaling a packet on the stream thread, including segment rotation
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 2'000'000;
+
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = static_cast<MarketDataProvider::OrderIdT>(i);
+        order._token = 35019;
+        order._orderType = 'B';
+        order._price = 100 + static_cast<int>(i % 16);
+        order._quantity = 10;
+        store.append(static_cast<int>(i + 1), MarketDataProvider::NEW, order);
+    }
+
+    run("journal_append/64MB_segments", store, 64 * 1024 * 1024);
+    run("journal_append/16MB_segments", store, 16 * 1024 * 1024);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/MarketDataProvider.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+
+namespace {
+
+template <int N>
+void readDepth(const char* name_, const MarketDataProvider::LadderBuilder& builder_) {
+    constexpr size_t Reads = 1'000'000;
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            const auto depth = builder_.getLadderDepth<N>();
+            Benchmark::doNotOptimize(depth);
+        }
+    });
+    Benchmark::report(name_, Reads, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief FLAT_MAP vs TICK_ARRAY ladder backends on the same order flow
+ *
+ * Orders arrive a few ticks either side of a slowly drifting mid, so most
+ * inserts land near the top of the book, and every message is followed by a
+ * getLadderDepth() read. The resting book is then read at each templated depth.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    constexpr size_t MessageCount = 2'000'000;
+    constexpr size_t RestingOrders = 4'000;
+    constexpr MarketDataProvider::PriceT TickSize = 5;
+    constexpr MarketDataProvider::TokenT Token = 35019;
+
+    struct Operation {
+        bool                             _cancel;
+        MarketDataProvider::OrderMessage _order;
+    };
+
+    std::mt19937 rng(42);
+    std::vector<Operation> operations;
+    std::vector<MarketDataProvider::OrderMessage> live;
+    operations.reserve(MessageCount);
+    int mid = 20000;
+    MarketDataProvider::OrderIdT orderId = 0;
+    while (operations.size() < MessageCount) {
+        if (rng() % 64 == 0) {
+            mid += static_cast<int>(rng() % 3) - 1;
+        }
+        if (live.size() < RestingOrders || rng() % 2 == 0) {
+            MarketDataProvider::OrderMessage order{};
+            order._orderId = ++orderId;
+            order._token = Token;
+            order._orderType = (rng() & 1) ? 'B' : 'S';
+            const int offset = 1 + static_cast<int>(rng() % 50);
+            order._price = (order._orderType == 'B' ? mid - offset : mid + offset) * TickSize;
+            order._quantity = 1 + static_cast<int>(rng() % 100);
+            operations.push_back({false, order});
+            live.push_back(order);
+        } else {
+            const size_t index = rng() % live.size();
+            operations.push_back({true, live[index]});
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (auto type : {MarketDataProvider::FLAT_MAP, MarketDataProvider::TICK_ARRAY}) {
+        MarketDataProvider::LadderBuilder builder(Token, type, TickSize);
+        int64_t checksum = 0;
+
+        const double nanos = Benchmark::timeNanos([&] {
+            for (const auto& operation : operations) {
+                if (operation._cancel) {
+                    builder.processCancelOrder(operation._order);
+                } else {
+                    builder.processNewOrder(operation._order);
+                }
+                const auto depth = builder.getLadderDepth();
+                checksum += depth._bid[0]._price + depth._ask[0]._price;
+            }
+        });
+
+        Benchmark::report(type == MarketDataProvider::FLAT_MAP ? "ladder/flat_map" : "ladder/tick_array",
+                          operations.size(), nanos);
+        std::printf("%-40s checksum %lld\n", "", static_cast<long long>(checksum));
+
+        const bool flat = type == MarketDataProvider::FLAT_MAP;
+        readDepth<1>(flat ? "depth<1>/flat_map" : "depth<1>/tick_array", builder);
+        readDepth<5>(flat ? "depth<5>/flat_map" : "depth<5>/tick_array", builder);
+        readDepth<10>(flat ? "depth<10>/flat_map" : "depth<10>/tick_array", builder);
+        readDepth<20>(flat ? "depth<20>/flat_map" : "depth<20>/tick_array", builder);
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/MarketDataProvider.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+
+namespace {
+
+constexpr MarketDataProvider::TokenT FirstToken = 35000;
+constexpr size_t TokenCount = 64;
+
+void run(const char* name_, const Benchmark::PacketStore& store_, MarketDataProvider::LatencyRecorder* recorder_) {
+    MarketDataProvider::BookConfig config;
+    config._type = MarketDataProvider::TICK_ARRAY;
+    config._orderCapacity = 1024;   // Room for the resting orders, so no table growth is timed
+    MarketDataProvider::TokenListT tokens;
+    for (size_t i = 0; i < TokenCount; ++i) {
+        tokens.push_back(FirstToken + static_cast<int>(i));
+    }
+    MarketDataProvider::StreamManager manager(0);
+    manager.init(tokens, config);
+    manager.setLatencyRecorder(recorder_);
+
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets; ++i) {
+            manager.process(store_.data(i), store_.size(i), i + 1);
+        }
+    });
+    Benchmark::report(name_, packets, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Cost of per-stage latency stamps on process(), and the stage histograms they produce
+ *
+ * Receive timestamps are tiny non-zero values so the socket stages are
+ * recorded (and saturate) without the wall clock mattering.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 2'000'000;
+    constexpr size_t RestingOrders = 20'000;
+
+    std::mt19937 rng(42);
+    Benchmark::PacketStore store;
+    std::vector<MarketDataProvider::OrderMessage> live;
+    int sequence = 0;
+    MarketDataProvider::OrderIdT orderId = 0;
+    while (store.count() < Packets) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = ++orderId;
+        order._token = FirstToken + static_cast<int>(rng() % TokenCount);
+        order._orderType = (rng() & 1) ? 'B' : 'S';
+        order._price = 9900 + static_cast<int>(rng() % 200);
+        order._quantity = 1 + static_cast<int>(rng() % 100);
+        store.append(++sequence, MarketDataProvider::NEW, order);
+        live.push_back(order);
+        if (live.size() > RestingOrders) {
+            store.append(++sequence, MarketDataProvider::CANCEL, live[live.size() - RestingOrders - 1]);
+        }
+    }
+
+    MarketDataProvider::TscClock::calibrate();
+    run("process/uninstrumented", store, nullptr);
+    MarketDataProvider::LatencyRecorder recorder;
+    run("process/latency histograms", store, &recorder);
+
+    for (auto stage : {MarketDataProvider::DECODE_STAGE, MarketDataProvider::BOOK_STAGE, MarketDataProvider::PUBLISH_STAGE}) {
+        const auto summary = recorder.summarize(stage);
+        std::printf("%-40s p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+                    MarketDataProvider::latencyStageName(stage), static_cast<unsigned long long>(summary._p50Nanos),
+                    static_cast<unsigned long long>(summary._p99Nanos), static_cast<unsigned long long>(summary._p999Nanos),
+                    static_cast<unsigned long long>(summary._maxNanos));
+    }
+
+    return 0;
+}
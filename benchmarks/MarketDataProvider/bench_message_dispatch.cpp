@@ -0,0 +1,111 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/MessageDecoder.hpp>
+#include <spdlog/spdlog.h>
+#include <functional>
+#include <random>
+
+namespace {
+
+using MarketDataProvider::NseDecoder;
+using MarketDataProvider::NseOrderWire;
+using MarketDataProvider::NseTradeWire;
+using MarketDataProvider::OrderMessage;
+using MarketDataProvider::StreamHeader;
+using MarketDataProvider::TradeMessage;
+
+/**
+ * @brief Stand-in for StreamManager's handlers, cheap enough that dispatch dominates
+ */
+struct Handler {
+    uint64_t _checksum = 0;
+
+    void newOrder(const OrderMessage& order_)    { _checksum += order_._token; }
+    void modifyOrder(const OrderMessage& order_) { _checksum += order_._price; }
+    void cancelOrder(const OrderMessage& order_) { _checksum -= order_._token; }
+    void tradeOrder(const TradeMessage& trade_)  { _checksum += trade_._quantity; }
+    void unknownMessage(char type_)              { _checksum ^= type_; }
+};
+
+/**
+ * @brief The table StreamManager used before, one std::function per letter
+ *
+ * Normalizes like NseDecoder so only the dispatch differs.
+ */
+struct FunctionTable {
+    std::function<void(const char*)> _function[26];
+
+    explicit FunctionTable(Handler& handler_) {
+        _function['N' - 'A'] = [&handler_](const char* buffer) { handler_.newOrder(NseDecoder::normalize(*reinterpret_cast<const NseOrderWire*>(buffer))); };
+        _function['M' - 'A'] = [&handler_](const char* buffer) { handler_.modifyOrder(NseDecoder::normalize(*reinterpret_cast<const NseOrderWire*>(buffer))); };
+        _function['X' - 'A'] = [&handler_](const char* buffer) { handler_.cancelOrder(NseDecoder::normalize(*reinterpret_cast<const NseOrderWire*>(buffer))); };
+        _function['T' - 'A'] = [&handler_](const char* buffer) { handler_.tradeOrder(NseDecoder::normalize(*reinterpret_cast<const NseTradeWire*>(buffer))); };
+    }
+
+    void dispatch(const char* buffer_, Handler& handler_) {
+        const char messageType = buffer_[sizeof(StreamHeader)];
+        const int functionIndex = messageType - 'A';
+        if (functionIndex >= 0 && functionIndex < 26 && _function[functionIndex]) {
+            _function[functionIndex](buffer_ + sizeof(StreamHeader) + 1);
+        } else {
+            handler_.unknownMessage(messageType);
+        }
+    }
+};
+
+template <typename DispatchT>
+void run(const char* name_, const Benchmark::PacketStore& store_, Handler& handler_, DispatchT&& dispatch_) {
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets; ++i) {
+            dispatch_(store_.data(i));
+        }
+    });
+    Benchmark::doNotOptimize(handler_._checksum);
+    Benchmark::report(name_, packets, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Per-message cost of the std::function table against the compile-time decoder
+ *
+ * Message types are drawn at random in roughly feed proportions, so neither
+ * the indirect call nor the switch gets a perfectly predictable pattern.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 5'000'000;
+
+    std::mt19937 rng(42);
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        const unsigned pick = rng() % 100;
+        if (pick < 10) {
+            MarketDataProvider::TradeMessage trade{};
+            trade._token = 35000 + static_cast<int>(rng() % 64);
+            trade._quantity = 1 + static_cast<int>(rng() % 100);
+            store.append(static_cast<int>(i + 1), MarketDataProvider::TRADE, trade);
+            continue;
+        }
+        MarketDataProvider::OrderMessage order{};
+        order._token = 35000 + static_cast<int>(rng() % 64);
+        order._price = 9900 + static_cast<int>(rng() % 200);
+        const char type = pick < 50 ? MarketDataProvider::NEW : pick < 70 ? MarketDataProvider::REPLACE : MarketDataProvider::CANCEL;
+        store.append(static_cast<int>(i + 1), type, order);
+    }
+
+    Handler handler;
+    FunctionTable table(handler);
+    run("dispatch/function_table", store, handler, [&](const char* buffer_) {
+        table.dispatch(buffer_, handler);
+    });
+    run("dispatch/nse_decoder", store, handler, [&](const char* buffer_) {
+        MarketDataProvider::NseDecoder::decode(buffer_[sizeof(StreamHeader)], buffer_ + sizeof(StreamHeader) + 1,
+                                               reinterpret_cast<const StreamHeader*>(buffer_)->_len - sizeof(StreamHeader) - 1,
+                                               handler);
+    });
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/OrderTable.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+using MarketDataProvider::Order;
+using MarketDataProvider::OrderIdT;
+using MarketDataProvider::OrderKeyT;
+
+// The container LadderBuilder::_orderBook used before OrderTable
+using OrderAllocatorT = boost::fast_pool_allocator<
+    std::pair<OrderIdT, Order>,
+    boost::default_user_allocator_malloc_free,
+    boost::details::pool::null_mutex,
+    8, 32
+>;
+using FlatOrderMapT = boost::container::flat_map<OrderIdT, Order, std::less<>, OrderAllocatorT>;
+
+struct Operation {
+    enum Kind : char { ADD, FIND, ERASE } _kind;
+    OrderKeyT _key;
+};
+
+// Steady state churn: resting orders stay around restingOrders_, each add is
+// paired with an erase of a random live order and a lookup of another.
+std::vector<Operation> makeWorkload(size_t restingOrders_, size_t operations_) {
+    std::mt19937_64 rng(42);
+    std::vector<OrderKeyT> live;
+    std::vector<Operation> workload;
+    workload.reserve(operations_ + restingOrders_);
+    OrderKeyT next = 1;
+
+    for (size_t i = 0; i < restingOrders_; ++i) {
+        workload.push_back({Operation::ADD, next});
+        live.push_back(next++);
+    }
+    while (workload.size() < operations_ + restingOrders_) {
+        workload.push_back({Operation::ADD, next});
+        live.push_back(next++);
+        workload.push_back({Operation::FIND, live[rng() % live.size()]});
+        const size_t index = rng() % live.size();
+        workload.push_back({Operation::ERASE, live[index]});
+        live[index] = live.back();
+        live.pop_back();
+    }
+    return workload;
+}
+
+template <typename RunT>
+void run(const char* name_, size_t restingOrders_, const std::vector<Operation>& workload_, RunT&& body_) {
+    int64_t checksum = 0;
+    const double nanos = Benchmark::timeNanos([&] {
+        for (const auto& operation : workload_) {
+            checksum += body_(operation);
+        }
+    });
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s/%zu", name_, restingOrders_);
+    Benchmark::report(label, workload_.size(), nanos);
+    Benchmark::doNotOptimize(checksum);
+}
+
+} // namespace
+
+/**
+ * @brief OrderTable against the previous flat_map order book and std::unordered_map
+ */
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    constexpr size_t Operations = 3'000'000;
+
+    for (size_t restingOrders : {1'000, 10'000, 50'000}) {
+        const auto workload = makeWorkload(restingOrders, Operations);
+
+        {
+            MarketDataProvider::OrderTable<Order> table(restingOrders * 2);
+            run("order_table", restingOrders, workload, [&](const Operation& operation_) -> int64_t {
+                switch (operation_._kind) {
+                    case Operation::ADD:
+                        table.insert(operation_._key, Order{1, 1});
+                        return 0;
+                    case Operation::FIND: {
+                        const auto* order = table.find(operation_._key);
+                        return order ? order->_quantity : 0;
+                    }
+                    case Operation::ERASE:
+                        return table.erase(operation_._key);
+                }
+                return 0;
+            });
+        }
+
+        {
+            FlatOrderMapT map;
+            run("flat_map", restingOrders, workload, [&](const Operation& operation_) -> int64_t {
+                const auto key = static_cast<OrderIdT>(operation_._key);
+                switch (operation_._kind) {
+                    case Operation::ADD:
+                        map[key] = Order{1, 1};
+                        return 0;
+                    case Operation::FIND: {
+                        auto it = map.find(key);
+                        return it != map.end() ? it->second._quantity : 0;
+                    }
+                    case Operation::ERASE:
+                        return static_cast<int64_t>(map.erase(key));
+                }
+                return 0;
+            });
+        }
+
+        {
+            std::unordered_map<OrderKeyT, Order> map;
+            map.reserve(restingOrders * 2);
+            run("unordered_map", restingOrders, workload, [&](const Operation& operation_) -> int64_t {
+                switch (operation_._kind) {
+                    case Operation::ADD:
+                        map[operation_._key] = Order{1, 1};
+                        return 0;
+                    case Operation::FIND: {
+                        auto it = map.find(operation_._key);
+                        return it != map.end() ? it->second._quantity : 0;
+                    }
+                    case Operation::ERASE:
+                        return static_cast<int64_t>(map.erase(operation_._key));
+                }
+                return 0;
+            });
+        }
+    }
+
+    return 0;
+}
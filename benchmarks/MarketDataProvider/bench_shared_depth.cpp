@@ -0,0 +1,100 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/LadderBuilder.hpp>
+#include <MarketDataProvider/SharedDepthStore.hpp>
+#include <MarketDataProvider/StreamManager.hpp>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr MarketDataProvider::TokenT Token = 35019;
+
+void runProcess(const char* name_, const Benchmark::PacketStore& store_, MarketDataProvider::SharedDepthStore* depthStore_) {
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({Token});
+    manager.setDepthStore(depthStore_);
+
+    const size_t packets = store_.count();
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets; ++i) {
+            manager.process(store_.data(i), store_.size(i), i + 1);
+        }
+    });
+    Benchmark::report(name_, packets, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Cost of publishing books to shared memory, and of a reader's top-of-book copy
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 1'000'000;
+    constexpr size_t Reads = 10'000'000;
+
+    // Orders walking the top level so nearly every event changes the depth
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = static_cast<MarketDataProvider::OrderIdT>(i % 2 ? i - 1 : i);
+        order._token = Token;
+        order._orderType = 'B';
+        order._price = 100 + static_cast<int>(i % 16);
+        order._quantity = 10;
+        store.append(static_cast<int>(i + 1), i % 2 ? MarketDataProvider::CANCEL : MarketDataProvider::NEW, order);
+    }
+
+    const std::string name = "bench_shared_depth_" + std::to_string(::getpid());
+    MarketDataProvider::SharedDepthStore writer(name);
+    if (!writer.create({Token})) {
+        std::printf("%-40s cannot create shared memory %s\n", "shared_depth", name.c_str());
+        return 1;
+    }
+    MarketDataProvider::SharedDepthStore reader(name);
+    if (!reader.attach()) {
+        return 1;
+    }
+
+    runProcess("process/no_shared_depth", store, nullptr);
+    runProcess("process/shared_depth", store, &writer);
+
+    const int slot = reader.findSlot(Token);
+    MarketDataProvider::SharedDepth depth;
+    double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            reader.readSlot(slot, depth);
+            Benchmark::doNotOptimize(depth._depth._bid[0]._price);
+        }
+    });
+    Benchmark::report("read/idle_writer", Reads, nanos);
+
+    // Readers racing a writer retry, they never hold it up
+    std::atomic<bool> running{true};
+    MarketDataProvider::LadderBuilder builder(Token);
+    std::thread publisher([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            writer.publish(builder);
+        }
+    });
+    size_t retries = 0;
+    nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            while (!reader.tryRead(slot, depth)) {
+                ++retries;
+            }
+            Benchmark::doNotOptimize(depth._depth._bid[0]._price);
+        }
+    });
+    running = false;
+    publisher.join();
+    Benchmark::report("read/busy_writer", Reads, nanos);
+    std::printf("%-40s %12zu retries\n", "", retries);
+
+    return 0;
+}
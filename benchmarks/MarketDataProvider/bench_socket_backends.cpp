@@ -0,0 +1,148 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/NetworkSocket.hpp>
+#include <spdlog/spdlog.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+namespace {
+
+constexpr const char* Group = "239.255.0.3";
+constexpr int         Port  = 41999;
+
+uint64_t threadCpuNanos() {
+    timespec now;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+uint64_t steadyNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Plain loopback multicast sender, bursts go out with one sendmmsg each
+class Sender {
+public:
+    Sender() {
+        _fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        in_addr interface{};
+        ::inet_pton(AF_INET, "127.0.0.1", &interface);
+        ::setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface));
+        unsigned char loop = 1;
+        ::setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+        _group.sin_family = AF_INET;
+        _group.sin_port   = htons(Port);
+        ::inet_pton(AF_INET, Group, &_group.sin_addr);
+    }
+
+    ~Sender() { ::close(_fd); }
+
+    size_t sendBurst(const Benchmark::PacketStore& store_, size_t first_, size_t count_) {
+        iovec iovecs[64];
+        mmsghdr messages[64] = {};
+        count_ = std::min<size_t>(count_, 64);
+        for (size_t i = 0; i < count_; ++i) {
+            iovecs[i].iov_base = const_cast<char*>(store_.data(first_ + i));
+            iovecs[i].iov_len  = store_.size(first_ + i);
+            messages[i].msg_hdr.msg_name    = &_group;
+            messages[i].msg_hdr.msg_namelen = sizeof(_group);
+            messages[i].msg_hdr.msg_iov     = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen  = 1;
+        }
+        const int sent = ::sendmmsg(_fd, messages, static_cast<unsigned>(count_), 0);
+        return sent > 0 ? static_cast<size_t>(sent) : 0;
+    }
+
+private:
+    int         _fd = -1;
+    sockaddr_in _group{};
+};
+
+void run(const char* name_, MarketDataProvider::SocketBackend backend_, const Benchmark::PacketStore& store_) {
+    MarketDataProvider::SocketConfig config;
+    config._interface = "127.0.0.1";
+    config._backend   = backend_;
+
+    MarketDataProvider::NetworkSocket socket(Group, Port, config);
+    if (!socket.connect()) {
+        std::printf("%-40s skipped, loopback multicast unavailable\n", name_);
+        return;
+    }
+    if (socket.getBackend() != backend_) {
+        std::printf("%-40s skipped, backend unavailable\n", name_);
+        return;
+    }
+
+    // Receive thread CPU and wall time between the first and last delivery
+    std::atomic<uint64_t> received{0};
+    uint64_t firstCpu = 0, lastCpu = 0, firstWall = 0, lastWall = 0;
+    int64_t checksum = 0;
+    socket.startReceivingBatch([&](const MarketDataProvider::PacketView* packets_, size_t count_) {
+        if (firstCpu == 0) {
+            firstCpu  = threadCpuNanos();
+            firstWall = steadyNanos();
+        }
+        for (size_t i = 0; i < count_; ++i) {
+            checksum += packets_[i]._data[packets_[i]._size - 1];
+        }
+        lastCpu  = threadCpuNanos();
+        lastWall = steadyNanos();
+        received.store(received.load(std::memory_order_relaxed) + count_, std::memory_order_release);
+    });
+
+    Sender sender;
+    size_t sent = 0;
+    while (sent < store_.count()) {
+        sent += sender.sendBurst(store_, sent, store_.count() - sent);
+    }
+
+    // Let the receiver drain what the kernel still holds
+    uint64_t previous = ~0ull;
+    while (received.load(std::memory_order_acquire) != previous) {
+        previous = received.load(std::memory_order_acquire);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    socket.stopReceiving();
+
+    const uint64_t packets = received.load(std::memory_order_acquire);
+    const auto stats = socket.getStats();
+    std::printf("%-40s %10llu/%zu rx %12.0f pkts/s %8.1f cpu ns/pkt %8.1f pkts/batch\n",
+                name_, static_cast<unsigned long long>(packets), sent,
+                packets * 1e9 / std::max<uint64_t>(lastWall - firstWall, 1),
+                static_cast<double>(lastCpu - firstCpu) / std::max<uint64_t>(packets, 1),
+                static_cast<double>(stats._packets) / std::max<uint64_t>(stats._batches, 1));
+    Benchmark::doNotOptimize(checksum);
+}
+
+} // namespace
+
+/**
+ * @brief Loopback multicast receive rate and receive-thread CPU per packet by backend
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    constexpr size_t Packets = 500'000;
+
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = static_cast<MarketDataProvider::OrderIdT>(i);
+        order._token = 35019;
+        order._orderType = 'B';
+        order._price = 100 + static_cast<int>(i % 16);
+        order._quantity = 10;
+        store.append(static_cast<int>(i + 1), MarketDataProvider::NEW, order);
+    }
+
+    run("recvmmsg", MarketDataProvider::RECVMMSG, store);
+    run("io_uring", MarketDataProvider::IO_URING, store);
+    return 0;
+}
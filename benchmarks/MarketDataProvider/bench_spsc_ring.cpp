@@ -0,0 +1,77 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/SpscRingBuffer.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using MarketDataProvider::PacketSlot;
+using PacketQueueT = MarketDataProvider::SpscRingBuffer<PacketSlot>;
+
+// Producer fills slots from the packet store as fast as it can, the consumer
+// drains in batches and touches each payload like StreamManager::process would
+void run(const char* name_, const Benchmark::PacketStore& store_, size_t capacity_,
+         MarketDataProvider::WaitStrategy strategy_, size_t batch_) {
+    PacketQueueT queue(capacity_, strategy_);
+    std::atomic<bool> running{true};
+    const size_t packets = store_.count();
+
+    int64_t checksum = 0;
+    const double nanos = Benchmark::timeNanos([&] {
+        std::thread producer([&] {
+            for (size_t i = 0; i < packets;) {
+                if (PacketSlot* slot = queue.claim()) {
+                    slot->_size = static_cast<uint32_t>(store_.size(i));
+                    std::memcpy(slot->_data, store_.data(i), store_.size(i));
+                    queue.publish();
+                    ++i;
+                }
+            }
+        });
+
+        size_t consumed = 0;
+        while (consumed < packets) {
+            consumed += queue.waitPopBatch([&](const PacketSlot& slot_) {
+                checksum += slot_._data[slot_._size - 1];
+            }, batch_, running);
+        }
+        producer.join();
+    });
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s/batch%zu", name_, batch_);
+    Benchmark::report(label, packets, nanos);
+    std::printf("%-40s %12llu producer retries on full\n", "", static_cast<unsigned long long>(queue.drops()));
+    Benchmark::doNotOptimize(checksum);
+}
+
+} // namespace
+
+/**
+ * @brief Cross-thread packet throughput of the socket -> book building queue
+ */
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    constexpr size_t Packets = 2'000'000;
+
+    Benchmark::PacketStore store;
+    for (size_t i = 0; i < Packets; ++i) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = static_cast<MarketDataProvider::OrderIdT>(i);
+        order._token = 35019;
+        order._orderType = 'B';
+        order._price = 100 + static_cast<int>(i % 16);
+        order._quantity = 10;
+        store.append(static_cast<int>(i + 1), MarketDataProvider::NEW, order);
+    }
+
+    for (size_t batch : {1, 16, 64}) {
+        run("spsc_busy_spin", store, MarketDataProvider::PACKET_QUEUE_CAPACITY, MarketDataProvider::BUSY_SPIN, batch);
+        run("spsc_blocking", store, MarketDataProvider::PACKET_QUEUE_CAPACITY, MarketDataProvider::BLOCKING, batch);
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/MarketDataProvider.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+#include <set>
+
+/**
+ * @brief Messages/sec through StreamManager::process as the subscription grows
+ *
+ * Every message targets a random subscribed token. Orders are cancelled a
+ * fixed number of messages after they are added, so the resting book size is
+ * the same for every subscription size and only the dispatch cost varies.
+ * Each size runs once with a compact token range (TokenIndex's flat array)
+ * and once with token ids scattered over a wide range (its hashed fallback).
+ */
+namespace {
+
+constexpr size_t MessageCount = 1'000'000;
+constexpr size_t RestingOrders = 512;
+
+void run(const char* layout_, const MarketDataProvider::TokenListT& tokens_) {
+    MarketDataProvider::StreamManager manager(0);
+    manager.init(tokens_);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> tokenPick(0, tokens_.size() - 1);
+    std::uniform_int_distribution<int> pricePick(9900, 10100);
+
+    Benchmark::PacketStore packets;
+    std::vector<MarketDataProvider::OrderMessage> live;
+    int sequence = 0;
+    MarketDataProvider::OrderIdT orderId = 0;
+    while (packets.count() < MessageCount) {
+        MarketDataProvider::OrderMessage order{};
+        order._orderId = ++orderId;
+        order._token = tokens_[tokenPick(rng)];
+        order._orderType = (rng() & 1) ? 'B' : 'S';
+        order._price = pricePick(rng);
+        order._quantity = 1 + static_cast<int>(rng() % 100);
+        packets.append(++sequence, MarketDataProvider::NEW, order);
+        live.push_back(order);
+
+        if (live.size() > RestingOrders) {
+            packets.append(++sequence, MarketDataProvider::CANCEL, live[live.size() - RestingOrders - 1]);
+        }
+    }
+
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < packets.count(); ++i) {
+            manager.process(packets.data(i), packets.size(i));
+        }
+    });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "process/%zu %s tokens", tokens_.size(), layout_);
+    Benchmark::report(name, packets.count(), nanos);
+}
+
+} // namespace
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    for (size_t tokenCount : {10, 100, 1'000, 10'000, 50'000}) {
+        MarketDataProvider::TokenListT dense;
+        for (size_t i = 0; i < tokenCount; ++i) {
+            dense.push_back(static_cast<int>(35000 + i * 3));
+        }
+        run("dense", dense);
+
+        // Far wider than the dense index allows for this many tokens
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> tokenPick(1, 1 << 30);
+        std::set<int> scattered;
+        while (scattered.size() < tokenCount) {
+            scattered.insert(tokenPick(rng));
+        }
+        run("sparse", MarketDataProvider::TokenListT(scattered.begin(), scattered.end()));
+    }
+
+    return 0;
+}
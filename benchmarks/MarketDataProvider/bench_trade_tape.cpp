@@ -0,0 +1,102 @@
+#include "BenchmarkUtils.hpp"
+
+#include <MarketDataProvider/TradeTape.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr MarketDataProvider::TokenT Token = 35019;
+constexpr size_t Window = 256;
+
+MarketDataProvider::TradeMessage makeTrade(size_t i_) {
+    MarketDataProvider::TradeMessage trade{};
+    trade._timeStamp = i_;
+    trade._token = Token;
+    trade._price = 10000 + static_cast<int>(i_ % 17);
+    trade._quantity = 1 + static_cast<int>(i_ % 50);
+    return trade;
+}
+
+void runRecord(const char* name_, bool reader_) {
+    constexpr size_t Trades = 20'000'000;
+    MarketDataProvider::TradeTape tape({Token});
+
+    // A reader copying the window back to back keeps the tape's lines bouncing
+    std::atomic<bool> done{false};
+    std::thread reader;
+    if (reader_) {
+        reader = std::thread([&] {
+            MarketDataProvider::TradePrint prints[Window];
+            size_t copied = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                copied += tape.read(Token, prints, Window);
+            }
+            Benchmark::doNotOptimize(copied);
+        });
+    }
+
+    const double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Trades; ++i) {
+            tape.record(makeTrade(i), i % 2 ? MarketDataProvider::BUY : MarketDataProvider::SELL);
+        }
+    });
+    done = true;
+    if (reader.joinable()) {
+        reader.join();
+    }
+    Benchmark::report(name_, Trades, nanos);
+}
+
+} // namespace
+
+/**
+ * @brief Writer cost per trade, alone and against a reader, and a reader's window copy
+ *
+ * For scale, the vector line copies the same window out of a std::vector
+ * of TradeMessages, which allocates and would still need a lock to be
+ * read from another thread.
+ */
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    runRecord("tape/record", false);
+    runRecord("tape/record with reader", true);
+
+    constexpr size_t Reads = 1'000'000;
+    MarketDataProvider::TradeTape tape({Token});
+    std::vector<MarketDataProvider::TradeMessage> history;
+    for (size_t i = 0; i < 4 * Window; ++i) {
+        tape.record(makeTrade(i), MarketDataProvider::BUY);
+        history.push_back(makeTrade(i));
+    }
+
+    MarketDataProvider::TradePrint prints[Window];
+    double nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            Benchmark::doNotOptimize(tape.read(Token, prints, Window));
+        }
+    });
+    Benchmark::report("tape/read 256", Reads, nanos);
+
+    MarketDataProvider::TapeSummary summary;
+    nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            tape.summarize(Token, Window, summary);
+            Benchmark::doNotOptimize(summary);
+        }
+    });
+    Benchmark::report("tape/summarize 256", Reads, nanos);
+
+    nanos = Benchmark::timeNanos([&] {
+        for (size_t i = 0; i < Reads; ++i) {
+            std::vector<MarketDataProvider::TradeMessage> copy(history.end() - Window, history.end());
+            Benchmark::doNotOptimize(copy);
+        }
+    });
+    Benchmark::report("vector/copy 256", Reads, nanos);
+
+    return 0;
+}
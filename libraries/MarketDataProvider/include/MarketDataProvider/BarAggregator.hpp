@@ -0,0 +1,205 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MarketDataProvider {
+
+constexpr uint64_t BAR_FILE_MAGIC   = 0x535241424144504DULL;   // "MPDABARS"
+constexpr uint32_t BAR_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+
+struct BarFileHeader {
+    uint64_t _magic;
+    uint32_t _version;
+};
+
+#pragma pack(pop)
+
+/**
+ * @brief What closes a bar
+ */
+enum BarType : char {
+    TIME_BAR   = 'T',   // Fixed interval of trade time, aligned to the epoch
+    VOLUME_BAR = 'V',   // Once the traded quantity reaches the size
+    TICK_BAR   = 'K'    // After a number of trades
+};
+
+struct BarSpec {
+    BarType  _type = TIME_BAR;
+    uint64_t _size = 0;         // Nanoseconds, quantity or trades
+};
+
+/**
+ * @brief Parse "1s", "1m", "5m", "500ms", "volume:1000" or "ticks:100"
+ */
+bool parseBarSpec(const std::string& text_, BarSpec& spec_);
+
+/**
+ * @brief OHLCV of one token over one bar
+ */
+struct Bar {
+    TokenT     _token      = 0;
+    uint8_t    _spec       = 0;   // Index into the aggregator's specs
+    TimestampT _startNanos = 0;   // Interval start for time bars, otherwise the first trade
+    TimestampT _endNanos   = 0;   // Interval end for time bars, otherwise the last trade
+    PriceT     _open       = 0;
+    PriceT     _high       = 0;
+    PriceT     _low        = 0;
+    PriceT     _close      = 0;
+    uint64_t   _volume     = 0;
+    uint32_t   _trades     = 0;
+    double     _notional   = 0;   // Sum of price * quantity, VWAP is _notional / _volume
+};
+
+/**
+ * @brief Append-only columnar file of closed bars
+ *
+ * A BarFileHeader, then blocks of up to BlockSize bars. Each block is a
+ * count followed by one array per Bar field in declaration order, so a
+ * reader can load the closes of a block without touching anything else.
+ *
+ * append() copies into one of BlockCount preallocated blocks; full blocks,
+ * and the partial one on flush(), are written by a background thread, so
+ * the stream thread never allocates or makes a syscall. If the writer falls
+ * BlockCount blocks behind, bars are dropped and counted rather than block
+ * the feed. append() and flush() must be called from one thread.
+ */
+class BarFile {
+public:
+    static constexpr size_t BlockSize  = 1024;
+    static constexpr size_t BlockCount = 4;
+
+    BarFile() = default;
+    ~BarFile();
+
+    BarFile(const BarFile&) = delete;
+    BarFile& operator=(const BarFile&) = delete;
+
+    /**
+     * @brief Open path_ for appending, writing the header if the file is new
+     */
+    bool open(const std::string& path_);
+    void append(const Bar& bar_);
+
+    /**
+     * @brief Hand the buffered partial block to the writer thread
+     */
+    void flush();
+
+    /**
+     * @brief Write everything appended so far and stop the writer thread
+     */
+    void close();
+
+    bool     isOpen() const { return _file != nullptr; }
+    uint64_t getBarsWritten() const { return _written.load(std::memory_order_relaxed); }
+    uint64_t getBarsDropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Load every bar of a file, false if it is missing or malformed
+     */
+    static bool read(const std::string& path_, std::vector<Bar>& bars_);
+
+private:
+    std::FILE*             _file = nullptr;
+    std::unique_ptr<Bar[]> _blocks;             // BlockCount blocks of BlockSize bars
+    size_t                 _counts[BlockCount] = {};
+    size_t                 _filling = 0;         // Bars in the block being filled, block _handed
+    std::atomic<uint64_t>  _written{0};
+    std::atomic<uint64_t>  _dropped{0};
+
+    // Shared with the writer thread
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+    uint64_t                _handed  = 0;       // Blocks handed to the writer
+    uint64_t                _drained = 0;       // Blocks it has written
+    bool                    _running = false;
+    std::thread             _writer;
+
+    bool handOver(bool wait_);
+    void writerLoop();
+    void writeBlock(const Bar* bars_, size_t count_, std::vector<char>& buffer_);
+};
+
+/**
+ * @brief Builds time, volume and tick bars per token from trades
+ *
+ * StreamManager hands every trade of a subscribed token to onTrade(). Each
+ * (token, spec) pair keeps its open bar and a fixed ring of the last
+ * history_ closed bars. Closed bars go to subscribers and, if attached, a
+ * BarFile. A time bar closes on the first trade of a later interval, or on
+ * closeExpired() when the feed is quiet; intervals without trades produce
+ * no bar. Volume and tick bars close on the trade that reaches their size.
+ * Used from the stream thread, subscribers are called on it.
+ */
+class BarAggregator {
+public:
+    using CallbackT = std::function<void(const Bar&)>;
+
+    BarAggregator(const std::vector<TokenT>& tokens_, std::vector<BarSpec> specs_, size_t history_ = BAR_HISTORY);
+
+    BarAggregator(const BarAggregator&) = delete;
+    BarAggregator& operator=(const BarAggregator&) = delete;
+
+    void onTrade(const TradeMessage& trade_);
+
+    /**
+     * @brief Close time bars whose interval ended by now_, returns how many
+     *
+     * Returns at once until the earliest open interval has ended, so it can
+     * be called on every batch of a busy stream.
+     */
+    size_t closeExpired(TimestampT now_);
+
+    void subscribe(CallbackT callback_);
+
+    /**
+     * @brief Also append closed bars to file_ (not owned), nullptr to stop
+     */
+    void setBarFile(BarFile* file_);
+
+    /**
+     * @brief Up to count_ most recent closed bars of a token and spec, oldest first
+     */
+    size_t getBars(TokenT token_, size_t spec_, std::vector<Bar>& bars_, size_t count_ = SIZE_MAX) const;
+
+    /**
+     * @brief The bar being built, false if it has no trades yet
+     */
+    bool getOpenBar(TokenT token_, size_t spec_, Bar& bar_) const;
+
+    const std::vector<BarSpec>& getSpecs() const { return _specs; }
+
+private:
+    struct Series {
+        Bar      _open;
+        bool     _active = false;
+        uint64_t _closed = 0;       // Bars closed so far, the ring holds the last _history
+    };
+
+    std::vector<BarSpec>               _specs;
+    size_t                             _history;
+    std::unordered_map<TokenT, size_t> _tokenIndex;   // Token -> first series
+    std::vector<Series>                _series;
+    std::vector<Bar>                   _ring;         // _history slots per series
+    std::vector<CallbackT>             _subscribers;
+    BarFile*                           _file = nullptr;
+    TimestampT                         _nextExpiry = UINT64_MAX;   // No open time bar ends before this
+
+    const Series* findSeries(TokenT token_, size_t spec_, size_t& index_) const;
+    void          closeBar(size_t index_);
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "MarketDataProvider/Journal.hpp"
+#include "MarketDataProvider/StreamManager.hpp"
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MarketDataProvider {
+
+constexpr uint64_t CHECKPOINT_MAGIC   = 0x54504B434144504DULL;   // "MPDACKPT"
+constexpr uint32_t CHECKPOINT_VERSION = 3;
+
+#pragma pack(push, 1)
+
+/**
+ * @brief Start of a snapshot file
+ *
+ * Followed by _books CheckpointBook records, each followed by its orders,
+ * and a trailing FNV-1a checksum of everything before it.
+ */
+struct CheckpointHeader {
+    uint64_t _magic;
+    uint32_t _version;
+    uint32_t _books;
+    uint64_t _createdNanos;
+    uint64_t _session;                // CheckpointConfig::_session of the run that saved it
+    uint32_t _journalSegment;         // Journal position the snapshot is consistent with
+    uint64_t _journalOffset;
+    int32_t  _expected[MaxStream];    // Next sequence number per stream
+};
+
+struct CheckpointBook {
+    TokenT   _token;
+    uint64_t _version;                // Last published depth version
+    uint64_t _tradeVolume;            // Session totals behind BookAnalytics::_vwap
+    double   _tradeNotional;
+    uint32_t _orders;
+};
+
+/**
+ * @brief Resting order; a book's orders are stored level by level in time priority
+ */
+struct CheckpointOrder {
+    OrderKeyT _orderId;
+    PriceT    _price;
+    QuantityT _quantity;
+    char      _side;
+};
+
+#pragma pack(pop)
+
+struct CheckpointConfig {
+    std::string _directory = "checkpoints";
+    std::string _prefix    = "marketdata";
+    size_t      _keep      = 2;       // Snapshots kept on disk
+    uint64_t    _session   = 0;       // Trading session; restore() skips snapshots of any other
+};
+
+struct CheckpointStats {
+    uint64_t _saved        = 0;
+    uint64_t _skipped      = 0;       // Not taken: stream recovering or previous write pending
+    uint64_t _failed       = 0;
+    uint64_t _bytes        = 0;       // Size of the last snapshot
+    uint64_t _captureNanos = 0;       // Time the last save() held the stream thread
+};
+
+/**
+ * @brief Periodic book snapshots for warm restart
+ *
+ * save() serializes every LadderBuilder's resting orders (levels in time
+ * priority), depth versions and per-stream expected sequence together with
+ * the journal position they correspond to. Serializing happens on the
+ * calling stream thread so the snapshot is consistent; writing, fsync and
+ * the atomic rename into <prefix>.<index>.snapshot happen on a background
+ * thread. On startup restore() loads the newest snapshot that verifies and
+ * returns its journal position, from which the journal tail is replayed.
+ */
+class Checkpoint {
+public:
+    explicit Checkpoint(const CheckpointConfig& config_);
+    ~Checkpoint();
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    /**
+     * @brief Snapshot manager_ at position_, false if skipped
+     *
+     * Skipped while a stream waits on recovery (held packets are already
+     * behind position_) or while the previous snapshot is still being written.
+     */
+    bool save(const StreamManager& manager_, const JournalPosition& position_);
+
+    /**
+     * @brief Load the newest valid snapshot of this session into an initialized manager_
+     */
+    bool restore(StreamManager& manager_, JournalPosition& position_);
+
+    /**
+     * @brief Wait until a pending snapshot is on disk
+     */
+    void flush();
+
+    CheckpointStats getStats() const;
+
+private:
+    CheckpointConfig      _config;
+    uint32_t              _nextIndex = 0;
+
+    std::atomic<uint64_t> _saved{0};
+    std::atomic<uint64_t> _skipped{0};
+    std::atomic<uint64_t> _failed{0};
+    std::atomic<uint64_t> _bytes{0};
+    std::atomic<uint64_t> _captureNanos{0};
+
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+    std::vector<char>       _pending;       // Serialized snapshot waiting for the writer
+    std::vector<char>       _buffer;        // Reused by save()
+    bool                    _writing = false;
+    bool                    _running = true;
+    std::thread             _worker;
+
+    void        workerLoop();
+    bool        write(const std::vector<char>& snapshot_, uint32_t index_);
+    std::string snapshotPath(uint32_t index_) const;
+};
+
+} // namespace MarketDataProvider
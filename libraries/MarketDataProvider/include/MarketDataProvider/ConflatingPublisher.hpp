@@ -0,0 +1,134 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Latest depth of one token as delivered to a conflated subscriber
+ */
+struct ConflatedDepth {
+    uint64_t    _version = 0;       // LadderBuilder depth version
+    uint64_t    _skipped = 0;       // Versions folded into this one since the subscriber's last delivery
+    LadderDepth _depth;
+};
+
+struct ConflatedSubscriberStats {
+    uint64_t _polls     = 0;        // poll() calls that delivered
+    uint64_t _delivered = 0;        // Token states handed to the callback
+    uint64_t _conflated = 0;        // Versions never seen because a later one replaced them
+    uint64_t _overruns  = 0;        // Fell a whole change log behind, every token marked dirty
+};
+
+class ConflatingPublisher;
+
+/**
+ * @brief One slow consumer's view of a ConflatingPublisher
+ *
+ * Keeps its own read position in the publisher's change log and a dirty
+ * token set built from it. poll() delivers the latest state of every dirty
+ * token at most once per minimum interval; whatever changed several times
+ * in between is delivered once. Used from a single consumer thread.
+ */
+class ConflatedSubscriber {
+public:
+    using CallbackT = std::function<void(const ConflatedDepth&)>;
+
+    ConflatedSubscriber(const ConflatingPublisher& publisher_, std::string name_,
+                        std::chrono::nanoseconds minInterval_);
+
+    /**
+     * @brief Deliver dirty tokens if the interval has passed, returns how many
+     */
+    size_t poll(const CallbackT& callback_);
+
+    /**
+     * @brief Tokens changed since the last delivery, without delivering
+     */
+    size_t pending();
+
+    const std::string&       getName() const { return _name; }
+    ConflatedSubscriberStats getStats() const { return _stats; }
+
+private:
+    const ConflatingPublisher&            _publisher;
+    std::string                           _name;
+    std::chrono::nanoseconds              _minInterval;
+    std::chrono::steady_clock::time_point _nextDelivery;
+    uint64_t                              _cursor = 0;
+    std::vector<uint8_t>                  _dirty;          // Per slot
+    std::vector<uint32_t>                 _dirtySlots;
+    std::vector<uint64_t>                 _lastVersions;   // Per slot, last delivered
+    ConflatedSubscriberStats              _stats;
+
+    void collect();
+    void markAll();
+};
+
+/**
+ * @brief Conflating distribution of LadderBuilder depth to slow consumers
+ *
+ * The stream thread hands every DepthUpdate to onUpdate(), which applies the
+ * deltas to the token's latest-state slot (a seqlock) and appends the slot
+ * to a shared change log. That is all the feed handler does, whatever the
+ * number of subscribers; each subscriber reads the log and the slots at its
+ * own pace. Several stream threads may publish as long as each token is
+ * updated by one of them.
+ */
+class ConflatingPublisher {
+public:
+    explicit ConflatingPublisher(const std::vector<TokenT>& tokens_, size_t logCapacity_ = CONFLATION_LOG_CAPACITY);
+
+    ConflatingPublisher(const ConflatingPublisher&) = delete;
+    ConflatingPublisher& operator=(const ConflatingPublisher&) = delete;
+
+    /**
+     * @brief Stream thread side: fold an update into the token's latest state
+     */
+    void onUpdate(const DepthUpdate& update_);
+
+    /**
+     * @brief New subscriber that starts with every token dirty
+     */
+    std::unique_ptr<ConflatedSubscriber> subscribe(const std::string& name_, std::chrono::nanoseconds minInterval_) const;
+
+    /**
+     * @brief Consistent copy of a token's latest state, false if not published here
+     */
+    bool read(TokenT token_, ConflatedDepth& depth_) const;
+
+    const std::vector<TokenT>& getTokens() const { return _tokens; }
+
+private:
+    friend class ConflatedSubscriber;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> _sequence{0};   // Odd while onUpdate() writes
+        uint64_t              _version = 0;
+        LadderDepth           _depth;
+    };
+
+    struct LogEntry {
+        std::atomic<uint64_t> _stamp{0};      // Log position + 1 once _slot is written
+        std::atomic<uint32_t> _slot{0};
+    };
+
+    std::vector<TokenT>                  _tokens;
+    std::unordered_map<TokenT, uint32_t> _slotIndex;
+    std::unique_ptr<Slot[]>              _slots;
+    std::unique_ptr<LogEntry[]>          _log;
+    uint64_t                             _logMask;
+    alignas(64) std::atomic<uint64_t>    _head{0};
+
+    void readSlot(uint32_t slot_, ConflatedDepth& depth_) const;
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MarketDataProvider {
+
+constexpr uint64_t JOURNAL_MAGIC   = 0x4C4E524A4144504DULL;   // "MPDAJRNL"
+constexpr uint32_t JOURNAL_VERSION = 1;
+constexpr size_t   JOURNAL_RECORD_ALIGNMENT = 8;
+
+/**
+ * @brief Where a journal record came from
+ */
+enum JournalFlag : uint16_t {
+    JOURNAL_LIVE      = 0,
+    JOURNAL_RECOVERED = 1    // Delivered by Recovery, not the feed
+};
+
+/**
+ * @brief First bytes of every segment file
+ */
+struct JournalSegmentHeader {
+    uint64_t _magic;
+    uint32_t _version;
+    uint32_t _segment;        // Index in the file name
+    uint64_t _createdNanos;
+    uint64_t _session;        // JournalConfig::_session of the run that wrote it, 0 if none
+};
+
+/**
+ * @brief Precedes each packet; records are 8-byte aligned
+ *
+ * _size is written last, so a zero _size marks the end of the data in a
+ * segment that is still being written.
+ */
+struct JournalRecordHeader {
+    uint32_t _size;           // Packet bytes that follow
+    short    _streamId;       // StreamHeader::_streamId, -1 if the packet had no header
+    uint16_t _flags;          // JournalFlag
+    uint64_t _rxNanos;        // Receive timestamp
+};
+
+/**
+ * @brief Bytes a record of packetSize_ occupies, header and padding included
+ */
+constexpr size_t journalRecordSize(size_t packetSize_) {
+    return (sizeof(JournalRecordHeader) + packetSize_ + JOURNAL_RECORD_ALIGNMENT - 1) & ~(JOURNAL_RECORD_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Segment and byte offset of the next record
+ */
+struct JournalPosition {
+    uint32_t _segment = 0;
+    uint64_t _offset  = 0;
+};
+
+/**
+ * @brief <directory_>/<prefix_>.<segment_>.journal
+ */
+std::string journalSegmentPath(const std::string& directory_, const std::string& prefix_, uint32_t segment_);
+
+/**
+ * @brief Indices of the prefix_ segments in directory_, ascending
+ *
+ * A non-zero session_ keeps only the segments stamped with that session.
+ */
+std::vector<uint32_t> listJournalSegments(const std::string& directory_, const std::string& prefix_,
+                                          uint64_t session_ = 0);
+
+struct JournalConfig {
+    std::string               _directory     = "journal";
+    std::string               _prefix        = "marketdata";
+    size_t                    _segmentSize   = 256 * 1024 * 1024;
+    std::chrono::microseconds _rotateTimeout{10'000};   // Longest append() waits for the next segment
+    uint64_t                  _session       = 0;       // Trading session stamped on each segment, e.g. 20261017
+};
+
+struct JournalStats {
+    uint64_t _records  = 0;
+    uint64_t _bytes    = 0;
+    uint64_t _segments = 0;   // Segments started
+    uint64_t _stalls   = 0;   // Rotations that waited for the next segment
+    uint64_t _rejected = 0;   // Packets too large for a segment
+    uint64_t _dropped  = 0;   // Packets lost because no next segment could be prepared in time
+};
+
+/**
+ * @brief Append-only binary journal of raw packets in memory-mapped segments
+ *
+ * Segments are files named <prefix>.<index>.journal, allocated at full size
+ * and mapped with their pages populated before the writer gets them. A
+ * background thread keeps the next segment ready and unmaps and trims the
+ * finished ones, so append() is a copy into mapped memory: no syscalls and
+ * no page faults until a segment fills up. The page cache writes the data
+ * back. open() continues after the highest existing segment index.
+ *
+ * If the next segment is not ready when one fills up (disk full, mmap
+ * failure), append() waits at most _rotateTimeout, then drops and counts
+ * packets without waiting again until the worker manages to prepare one.
+ *
+ * append() must be called from one thread.
+ */
+class Journal {
+public:
+    explicit Journal(const JournalConfig& config_);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return _current._data != nullptr; }
+
+    /**
+     * @brief Append a packet, false if the journal is closed, it cannot fit a segment or no segment is ready
+     */
+    bool append(const char* buffer_, size_t size_, short streamId_, uint64_t rxNanos_, uint16_t flags_ = JOURNAL_LIVE);
+
+    JournalPosition getPosition() const;
+    JournalStats    getStats() const;
+
+    std::string segmentPath(uint32_t segment_) const;
+
+private:
+    struct Segment {
+        int      _fd    = -1;
+        char*    _data  = nullptr;
+        size_t   _size  = 0;
+        size_t   _used  = 0;
+        uint32_t _index = 0;
+    };
+
+    JournalConfig _config;
+    Segment       _current;
+    size_t        _offset = 0;
+
+    std::atomic<uint64_t> _records{0};
+    std::atomic<uint64_t> _bytes{0};
+    std::atomic<uint64_t> _segments{0};
+    std::atomic<uint64_t> _stalls{0};
+    std::atomic<uint64_t> _rejected{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint32_t> _positionSegment{0};
+    std::atomic<uint64_t> _positionOffset{0};
+
+    // Shared with the background thread
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+    Segment                 _next;
+    bool                    _nextWanted = false;
+    std::deque<Segment>     _retired;
+    bool                    _running    = false;
+    std::thread             _worker;
+    bool                    _starved    = false;   // Writer side: last rotation timed out
+
+    bool rotate();
+    void workerLoop();
+    bool prepare(Segment& segment_, uint32_t index_);
+    void finish(Segment& segment_, bool remove_);
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "MarketDataProvider/Journal.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief One journaled packet, valid until the reader leaves its segment
+ */
+struct JournalRecord {
+    const JournalRecordHeader* _header = nullptr;
+    const char*                _data   = nullptr;   // _header->_size packet bytes
+};
+
+/**
+ * @brief Sequential reader over the segments a Journal wrote
+ *
+ * Maps one segment at a time read-only and hands out records in place. A
+ * segment ends at its file size or at the first zero-sized record, which
+ * covers both trimmed segments and the one a crashed writer left behind.
+ * Given a session, segments stamped with any other session are left out, so
+ * earlier runs sharing the directory are not read.
+ */
+class JournalReader {
+public:
+    JournalReader(const std::string& directory_, const std::string& prefix_, uint64_t session_ = 0);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    /**
+     * @brief Find the segments and position at the first record, false if there are none
+     */
+    bool open();
+
+    /**
+     * @brief Next record in journal order, false at the end
+     */
+    bool next(JournalRecord& record_);
+
+    /**
+     * @brief Continue from a position taken from Journal::getPosition() or getPosition()
+     */
+    bool seek(const JournalPosition& position_);
+
+    /**
+     * @brief Position of the record next() returns next
+     */
+    JournalPosition getPosition() const;
+
+    const std::vector<uint32_t>& getSegments() const { return _segments; }
+
+private:
+    std::string           _directory;
+    std::string           _prefix;
+    uint64_t              _session      = 0;   // 0 reads every segment
+    std::vector<uint32_t> _segments;
+    size_t                _segmentIndex = 0;   // Into _segments
+    const char*           _data         = nullptr;
+    size_t                _size         = 0;
+    size_t                _offset       = 0;
+
+    bool map(size_t segmentIndex_);
+    void unmap();
+};
+
+} // namespace MarketDataProvider
@@ -1,16 +1,35 @@
 #pragma once
 
+#include "MarketDataProvider/MarketByOrder.hpp"
+#include "MarketDataProvider/PriceLadder.hpp"
 #include "MarketDataProvider/Structure.hpp"
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace MarketDataProvider {
 
+using DepthUpdateCallbackT = std::function<void(const DepthUpdate&)>;
+
 /**
  * @brief Builds and maintains order book ladder
+ *
+ * The price level backend is chosen per builder: FLAT_MAP keeps sorted
+ * flat_maps, TICK_ARRAY keeps a dense array indexed by tick (tickSize_ comes
+ * from the contract's tick size). Resting orders are kept in a
+ * market-by-order book preallocated for orderCapacity_ orders, which also
+ * records each order's side so modify/cancel/trade never rely on the
+ * side carried by the incoming message.
+ *
+ * After every event the visible top LADDER_DEPTH levels are diffed against
+ * the last published depth; real changes bump the version and are pushed to
+ * subscribers as DepthDelta events. The same diff keeps BookAnalytics up to
+ * date in constant time, so readers never recompute it from snapshots.
  */
 class LadderBuilder {
 public:
-    explicit LadderBuilder(TokenT token_);
+    explicit LadderBuilder(TokenT token_, BookType bookType_ = FLAT_MAP, PriceT tickSize_ = 1,
+                           size_t orderCapacity_ = ORDER_TABLE_CAPACITY);
     ~LadderBuilder() = default;
 
     /**
@@ -32,23 +51,124 @@ public:
      * @brief Process trade execution
      */
     void processTrade(const TradeMessage& trade_);
+
+    /**
+     * @brief Side that crossed the spread in trade_, call before processTrade()
+     *
+     * The order not resting in the book is the aggressor; if both rest, the
+     * later one; if neither does, the side of the mid the price is on.
+     */
+    Side getAggressor(const TradeMessage& trade_) const;
     
     /**
      * @brief Get current market depth
      */
     LadderDepth getLadderDepth() const;
 
+    /**
+     * @brief Current depth N levels per side, instantiated for N of 1, 5, 10 and 20
+     *
+     * Up to LADDER_DEPTH the levels come from the published depth, deeper
+     * books are read from the ladders.
+     */
+    template <int N>
+    BasicLadderDepth<N> getLadderDepth() const;
+
+    /**
+     * @brief Mid, microprice, imbalance, spread and session VWAP as of the last event
+     */
+    const BookAnalytics& getAnalytics() const { return _analytics; }
+
+    /**
+     * @brief Register for top-of-book delta events
+     */
+    void subscribe(DepthUpdateCallbackT callback_);
+
+    /**
+     * @brief Version of the published depth, increments on every change
+     */
+    uint64_t getVersion() const { return _version; }
+
+    /**
+     * @brief Levels changed by the last published update
+     */
+    uint32_t getChangedMask() const { return _changedMask; }
+
+    /**
+     * @brief Get an order's position in its price level queue
+     */
+    QueuePosition getQueuePosition(OrderIdT orderId_) const;
+
+    /**
+     * @brief Get the order-level (L3) book
+     */
+    const MarketByOrderBook& getOrderBook() const { return _orderBook; }
+
+    /**
+     * @brief Hint the cache about an order an upcoming message refers to
+     */
+    void prefetch(OrderIdT orderId_) const { _orderBook.prefetch(orderId_); }
+
+    BookType getBookType() const { return _bidLadder.type(); }
+
+    TokenT getToken() const { return _token; }
+
+    /**
+     * @brief Visit every resting order, each price level in time priority
+     */
+    template <typename FunctionT>
+    void forEachOrder(FunctionT&& function_) const {
+        _bidLadder.forEach([&](PriceT price_, QuantityT) { _orderBook.forEachOrder(BUY, price_, function_); });
+        _askLadder.forEach([&](PriceT price_, QuantityT) { _orderBook.forEachOrder(SELL, price_, function_); });
+    }
+
+    /**
+     * @brief Drop every order and the published depth, before a restore
+     */
+    void clear();
+
+    /**
+     * @brief Queue an order behind those already at its level without publishing
+     */
+    void restoreOrder(OrderKeyT orderId_, Side side_, PriceT price_, QuantityT quantity_);
+
+    /**
+     * @brief Publish the restored book to subscribers as version_
+     */
+    void publishRestored(uint64_t version_);
+
+    /**
+     * @brief Restore the session trade totals behind the VWAP
+     */
+    void restoreTrades(uint64_t volume_, double notional_);
+
+    /**
+     * @brief Write TscClock::now() to stamp_ whenever the depth changes, before subscribers run; nullptr stops
+     */
+    void setUpdateStamp(uint64_t* stamp_) { _updateStamp = stamp_; }
+
 private:
     TokenT _token;
-    ContainerT<std::less<PriceT>>    _bidLadder;    // Bids (descending order)
-    ContainerT<std::greater<PriceT>> _askLadder;    // Asks (ascending order)
-    OrderContainerT                  _orderBook;    // Order tracking
+    PriceLadder<BUY>  _bidLadder;    // Bids (descending order)
+    PriceLadder<SELL> _askLadder;    // Asks (ascending order)
+    MarketByOrderBook _orderBook;    // Order tracking
+    LadderDepth       _depth;        // Last published depth
+    BookAnalytics     _analytics;
+    PriceT            _tickSize;
+    int64_t           _bidQuantity = 0;   // Summed over the published levels
+    int64_t           _askQuantity = 0;
+    uint64_t          _version     = 0;
+    uint32_t          _changedMask = 0;
+    bool              _bidDirty    = false;
+    bool              _askDirty    = false;
+    std::vector<DepthUpdateCallbackT> _subscribers;
+    uint64_t*         _updateStamp = nullptr;   // Latency instrumentation, owned by the StreamManager
     
     void updateLadder();
-    void removeBidOrder(PriceT price_, QuantityT quantity_);
-    void removeAskOrder(PriceT price_, QuantityT quantity_);
-    void addBidOrder(PriceT price_, QuantityT quantity_);
-    void addAskOrder(PriceT price_, QuantityT quantity_);
+    void updateAnalytics();
+    void removeOrder(Side side_, PriceT price_, QuantityT quantity_);
+    void addOrder(Side side_, PriceT price_, QuantityT quantity_);
+    void markDirty(Side side_, PriceT price_);
 };
 
 } // namespace MarketDataProvider
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace MarketDataProvider {
+
+struct LatencySummary {
+    uint64_t _count     = 0;
+    double   _meanNanos = 0;
+    uint64_t _p50Nanos  = 0;
+    uint64_t _p90Nanos  = 0;
+    uint64_t _p99Nanos  = 0;
+    uint64_t _p999Nanos = 0;
+    uint64_t _maxNanos  = 0;
+};
+
+/**
+ * @brief Log-linear latency histogram, one writer and any number of live readers
+ *
+ * Values below SubBuckets nanoseconds get a bucket each; above that every
+ * power of two is split into SubBuckets equal buckets, so any value is
+ * within about 3% of its bucket's bounds from nanoseconds up to the clamp
+ * at 2^MaxExponent ns (about 18 minutes) in under 10 KB. Counters are
+ * atomics the single writer bumps with relaxed load/store, so recording
+ * costs no locked instruction and readers can summarize at any time; a
+ * live summary may lag the writer by a few values.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int    SubBucketBits = 5;
+    static constexpr size_t SubBuckets    = size_t{1} << SubBucketBits;
+    static constexpr int    MaxExponent   = 40;
+    static constexpr size_t Buckets       = (MaxExponent - SubBucketBits + 1) * SubBuckets;
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Writer: count one value
+     */
+    void record(uint64_t nanos_) {
+        bump(_counts[bucketIndex(nanos_)], 1);
+        bump(_count, 1);
+        bump(_sum, nanos_);
+        if (nanos_ > _max.load(std::memory_order_relaxed)) {
+            _max.store(nanos_, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t getCount() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return _max.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Upper bound of the bucket holding the fraction_ quantile, at most the maximum
+     */
+    uint64_t percentile(double fraction_) const;
+
+    LatencySummary summarize() const;
+
+    /**
+     * @brief Add other_'s counts to this histogram (both quiet, e.g. at shutdown)
+     */
+    void merge(const LatencyHistogram& other_);
+
+    static size_t bucketIndex(uint64_t nanos_);
+
+    /**
+     * @brief Largest value that lands in bucket_
+     */
+    static uint64_t bucketUpperBound(size_t bucket_);
+
+private:
+    std::atomic<uint64_t> _counts[Buckets] = {};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+
+    static void bump(std::atomic<uint64_t>& counter_, uint64_t value_) {
+        counter_.store(counter_.load(std::memory_order_relaxed) + value_, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Where a message's time goes between the socket and the published book
+ */
+enum LatencyStage : int {
+    RECEIVE_STAGE = 0,   // Socket receive timestamp to the start of decoding, mostly queueing
+    DECODE_STAGE,        // Framing and decoding up to the handler
+    BOOK_STAGE,          // Order book and LadderDepth update
+    PUBLISH_STAGE,       // Depth subscribers, shared depth, trade tape and bars
+    TICK_TO_BOOK_STAGE,  // Socket receive timestamp to the end of publishing
+    LATENCY_STAGES
+};
+
+const char* latencyStageName(LatencyStage stage_);
+
+/**
+ * @brief One LatencyHistogram per stream and stage, written by one StreamManager
+ *
+ * StreamManager stamps each message with TscClock and records the stages
+ * here; stages that start at the socket are skipped for packets without a
+ * receive timestamp (tests, replays without pacing).
+ */
+class LatencyRecorder {
+public:
+    LatencyRecorder();
+
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    void record(short streamId_, LatencyStage stage_, uint64_t nanos_) {
+        _histograms[static_cast<size_t>(streamId_) * LATENCY_STAGES + stage_].record(nanos_);
+    }
+
+    const LatencyHistogram& getHistogram(short streamId_, LatencyStage stage_) const {
+        return _histograms[static_cast<size_t>(streamId_) * LATENCY_STAGES + stage_];
+    }
+
+    /**
+     * @brief A stage over every stream
+     */
+    LatencySummary summarize(LatencyStage stage_) const;
+
+    /**
+     * @brief Log a line per stream and stage that has values, at info level
+     */
+    void report(const std::string& label_) const;
+
+private:
+    std::unique_ptr<LatencyHistogram[]> _histograms;   // MaxStream * LATENCY_STAGES
+};
+
+} // namespace MarketDataProvider
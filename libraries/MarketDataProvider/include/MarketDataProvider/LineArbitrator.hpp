@@ -0,0 +1,65 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Arbitration counters for one feed line
+ */
+struct LineStats {
+    uint64_t _packets      = 0;   // Received on this line
+    uint64_t _won          = 0;   // First copy of a sequence number, forwarded
+    uint64_t _duplicates   = 0;   // Copy already forwarded, dropped
+    uint64_t _stale        = 0;   // Too far behind the other line to tell, dropped
+    uint64_t _leadSamples  = 0;   // Won packets later seen on the other line
+    uint64_t _leadNanos    = 0;   // Sum of receive-time leads over those packets
+    uint64_t _maxLeadNanos = 0;
+};
+
+/**
+ * @brief A/B line arbitration in front of StreamManager::process
+ *
+ * Both redundant lines feed accept(); the first copy of every
+ * (StreamHeader::_streamId, _sequence) is forwarded and later copies are
+ * dropped. Duplicates are found with a single compare against a per-stream
+ * window of the last ARBITRATION_WINDOW sequence numbers, never by looking
+ * at the payload. When the losing copy arrives, the winner is credited with
+ * the receive-time difference. Not thread safe: call from the stream thread.
+ */
+class LineArbitrator {
+public:
+    static constexpr size_t LineCount = 2;
+
+    explicit LineArbitrator(size_t window_ = ARBITRATION_WINDOW);
+
+    /**
+     * @brief True if the packet should be processed, false if it is a duplicate
+     *
+     * Packets without a valid header are forwarded for StreamManager to reject.
+     */
+    bool accept(size_t line_, const char* buffer_, size_t size_, uint64_t rxNanos_);
+
+    LineStats getLineStats(size_t line_) const;
+
+private:
+    struct Entry {
+        int      _sequence = 0;   // Sequence numbers start at 1
+        uint32_t _line     = 0;
+        uint64_t _rxNanos  = 0;
+    };
+
+    struct StreamWindow {
+        int                _highest = 0;
+        std::vector<Entry> _entries;   // Indexed by sequence & mask, allocated on first packet
+    };
+
+    size_t       _window;
+    size_t       _mask;
+    StreamWindow _streams[MaxStream];
+    LineStats    _lines[LineCount];
+};
+
+} // namespace MarketDataProvider
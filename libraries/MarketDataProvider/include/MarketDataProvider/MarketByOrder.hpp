@@ -0,0 +1,170 @@
+#pragma once
+
+#include "MarketDataProvider/OrderTable.hpp"
+#include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace MarketDataProvider {
+
+constexpr uint32_t NullIndex = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Fixed-type object pool addressed by 32-bit index
+ *
+ * Released slots are recycled LIFO so recently touched memory is reused
+ * first. Indices stay valid across growth; references do not.
+ */
+template <typename T>
+class Slab {
+public:
+    explicit Slab(size_t capacity_ = 0) {
+        _items.reserve(capacity_);
+        _free.reserve(capacity_);
+    }
+
+    uint32_t allocate() {
+        if (!_free.empty()) {
+            const uint32_t index = _free.back();
+            _free.pop_back();
+            return index;
+        }
+        _items.emplace_back();
+        return static_cast<uint32_t>(_items.size() - 1);
+    }
+
+    void release(uint32_t index_) { _free.push_back(index_); }
+
+    T&       operator[](uint32_t index_) { return _items[index_]; }
+    const T& operator[](uint32_t index_) const { return _items[index_]; }
+
+    size_t size() const { return _items.size() - _free.size(); }
+
+    void clear() {
+        _items.clear();
+        _free.clear();
+    }
+
+private:
+    std::vector<T>        _items;
+    std::vector<uint32_t> _free;
+};
+
+/**
+ * @brief Resting order, intrusively linked into its price level's FIFO queue
+ */
+struct OrderNode {
+    OrderKeyT _orderId  = 0;
+    PriceT    _price    = 0;
+    QuantityT _quantity = 0;
+    uint32_t  _level    = NullIndex;
+    uint32_t  _prev     = NullIndex;
+    uint32_t  _next     = NullIndex;
+    Side      _side     = BUY;
+};
+
+/**
+ * @brief Price level with the head (oldest) and tail (newest) of its queue
+ */
+struct PriceLevel {
+    PriceT    _price    = 0;
+    QuantityT _quantity = 0;
+    uint32_t  _orders   = 0;
+    uint32_t  _head     = NullIndex;
+    uint32_t  _tail     = NullIndex;
+    Side      _side     = BUY;
+};
+
+/**
+ * @brief Where an order sits in its price level's queue
+ */
+struct QueuePosition {
+    bool      _found         = false;
+    uint32_t  _ordersAhead   = 0;   // Orders with time priority over this one
+    QuantityT _quantityAhead = 0;   // Quantity that must trade before this order
+    uint32_t  _levelOrders   = 0;
+    QuantityT _levelQuantity = 0;
+};
+
+/**
+ * @brief Market-by-order (L3) book with per-level FIFO queues
+ *
+ * Orders and levels come from slabs and are found through OrderTables, so
+ * add, cancel and reduce are O(1) with no allocation once the slabs are
+ * warm. Pointers returned by find()/add() are invalidated by the next add().
+ */
+class MarketByOrderBook {
+public:
+    explicit MarketByOrderBook(size_t orderCapacity_ = ORDER_TABLE_CAPACITY);
+
+    OrderNode*       find(OrderKeyT orderId_);
+    const OrderNode* find(OrderKeyT orderId_) const;
+
+    /**
+     * @brief Append a new order to the back of its level, nullptr if the id is live
+     */
+    OrderNode* add(OrderKeyT orderId_, Side side_, PriceT price_, QuantityT quantity_);
+
+    /**
+     * @brief Unlink and release an order
+     */
+    void remove(OrderNode* order_);
+
+    /**
+     * @brief Reduce quantity keeping queue priority, removes the order at zero
+     *
+     * A quantity that is not positive leaves the order as it is.
+     * @return true if the order is still resting
+     */
+    bool reduce(OrderNode* order_, QuantityT quantity_);
+
+    /**
+     * @brief Apply a modify: a price change or quantity increase loses priority
+     * @return The order after the modify (may have moved)
+     */
+    OrderNode* replace(OrderNode* order_, PriceT price_, QuantityT quantity_);
+
+    /**
+     * @brief Queue position of an order within its level
+     */
+    QueuePosition getQueuePosition(OrderKeyT orderId_) const;
+
+    const PriceLevel* getLevel(Side side_, PriceT price_) const;
+
+    /**
+     * @brief Hint the cache about an order about to be looked up
+     */
+    void prefetch(OrderKeyT orderId_) const { _orders.prefetch(orderId_); }
+
+    /**
+     * @brief Visit the orders at a level in time priority
+     */
+    template <typename FunctionT>
+    void forEachOrder(Side side_, PriceT price_, FunctionT&& function_) const {
+        const PriceLevel* level = getLevel(side_, price_);
+        for (uint32_t index = level ? level->_head : NullIndex; index != NullIndex; index = _nodes[index]._next) {
+            function_(_nodes[index]);
+        }
+    }
+
+    size_t size() const { return _orders.size(); }
+    size_t levelCount() const { return _levelIndex.size(); }
+    void   clear();
+
+private:
+    Slab<OrderNode>      _nodes;
+    Slab<PriceLevel>     _levels;
+    OrderTable<uint32_t> _orders;      // Order id -> node
+    OrderTable<uint32_t> _levelIndex;  // (side, price) -> level
+
+    static OrderKeyT levelKey(Side side_, PriceT price_) {
+        return (static_cast<OrderKeyT>(static_cast<unsigned char>(side_)) << 32) | static_cast<uint32_t>(price_);
+    }
+
+    uint32_t findOrCreateLevel(Side side_, PriceT price_);
+    void     pushBack(uint32_t levelIndex_, uint32_t nodeIndex_);
+    void     unlink(uint32_t nodeIndex_);
+};
+
+} // namespace MarketDataProvider
@@ -2,6 +2,24 @@
 
 #include "MarketDataProvider/Structure.hpp"
 #include "MarketDataProvider/StreamManager.hpp"
+#include "MarketDataProvider/BarAggregator.hpp"
+#include "MarketDataProvider/Checkpoint.hpp"
+#include "MarketDataProvider/ConflatingPublisher.hpp"
+#include "MarketDataProvider/Journal.hpp"
+#include "MarketDataProvider/JournalReader.hpp"
+#include "MarketDataProvider/LatencyHistogram.hpp"
 #include "MarketDataProvider/LadderBuilder.hpp"
+#include "MarketDataProvider/LineArbitrator.hpp"
+#include "MarketDataProvider/MarketByOrder.hpp"
+#include "MarketDataProvider/MessageDecoder.hpp"
 #include "MarketDataProvider/NetworkSocket.hpp"
-#include "MarketDataProvider/Recovery.hpp"
\ No newline at end of file
+#include "MarketDataProvider/OrderTable.hpp"
+#include "MarketDataProvider/PriceLadder.hpp"
+#include "MarketDataProvider/Recovery.hpp"
+#include "MarketDataProvider/ReplayDriver.hpp"
+#include "MarketDataProvider/SharedDepthStore.hpp"
+#include "MarketDataProvider/ShardLayout.hpp"
+#include "MarketDataProvider/SpscRingBuffer.hpp"
+#include "MarketDataProvider/TokenIndex.hpp"
+#include "MarketDataProvider/TradeTape.hpp"
+#include "MarketDataProvider/TscClock.hpp"
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <cmath>
+
+namespace MarketDataProvider {
+
+#pragma pack(push, 1)
+
+/**
+ * @brief NSE order message body on the wire, ids and times (seconds) as doubles
+ */
+struct NseOrderWire {
+    double    _timestamp;
+    double    _orderId;
+    TokenT    _token;
+    char      _orderType;
+    PriceT    _price;
+    QuantityT _quantity;
+};
+
+/**
+ * @brief NSE trade message body on the wire
+ */
+struct NseTradeWire {
+    double    _timeStamp;
+    double    _buyOrderId;
+    double    _sellOrderId;
+    TokenT    _token;
+    PriceT    _price;
+    QuantityT _quantity;
+};
+
+#pragma pack(pop)
+
+/**
+ * @brief Decoder for the NSE tick-by-tick message body
+ *
+ * A decoder turns the message type and body that follow a StreamHeader into
+ * calls on the handler: newOrder, modifyOrder, cancelOrder and tradeOrder
+ * with the message normalized to OrderMessage/TradeMessage (integer order
+ * ids, nanosecond timestamps), or unknownMessage with the type. decode()
+ * returns false without calling the handler when size_, the body length,
+ * is too short for the type's wire struct. prefetch() passes the token and
+ * order ids a message will look up to prefetchOrder, so a batch can warm
+ * the books before decoding reaches it.
+ *
+ * The decoder is chosen at compile time through BasicStreamManager's
+ * template parameter, so the switch and the handlers are inlined into
+ * process(). Another exchange's feed gets its own decoder type with the
+ * same static interface, and one translation unit that includes
+ * StreamManager.ipp and instantiates BasicStreamManager for it.
+ */
+struct NseDecoder {
+    template <typename HandlerT>
+    static bool decode(char type_, const char* body_, size_t size_, HandlerT& handler_) {
+        switch (type_) {
+            case NEW:
+                if (size_ < sizeof(NseOrderWire)) {
+                    return false;
+                }
+                handler_.newOrder(normalize(*reinterpret_cast<const NseOrderWire*>(body_)));
+                break;
+            case REPLACE:
+                if (size_ < sizeof(NseOrderWire)) {
+                    return false;
+                }
+                handler_.modifyOrder(normalize(*reinterpret_cast<const NseOrderWire*>(body_)));
+                break;
+            case CANCEL:
+                if (size_ < sizeof(NseOrderWire)) {
+                    return false;
+                }
+                handler_.cancelOrder(normalize(*reinterpret_cast<const NseOrderWire*>(body_)));
+                break;
+            case TRADE:
+                if (size_ < sizeof(NseTradeWire)) {
+                    return false;
+                }
+                handler_.tradeOrder(normalize(*reinterpret_cast<const NseTradeWire*>(body_)));
+                break;
+            default:
+                handler_.unknownMessage(type_);
+                break;
+        }
+        return true;
+    }
+
+    template <typename HandlerT>
+    static void prefetch(char type_, const char* body_, size_t size_, HandlerT& handler_) {
+        switch (type_) {
+            case NEW:
+            case REPLACE:
+            case CANCEL: {
+                if (size_ < sizeof(NseOrderWire)) {
+                    break;
+                }
+                const auto* order = reinterpret_cast<const NseOrderWire*>(body_);
+                handler_.prefetchOrder(order->_token, toOrderId(order->_orderId));
+                break;
+            }
+            case TRADE: {
+                if (size_ < sizeof(NseTradeWire)) {
+                    break;
+                }
+                const auto* trade = reinterpret_cast<const NseTradeWire*>(body_);
+                handler_.prefetchOrder(trade->_token, toOrderId(trade->_buyOrderId));
+                handler_.prefetchOrder(trade->_token, toOrderId(trade->_sellOrderId));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    static OrderMessage normalize(const NseOrderWire& wire_) {
+        return OrderMessage{toNanos(wire_._timestamp), toOrderId(wire_._orderId), wire_._token,
+                            wire_._orderType, wire_._price, wire_._quantity};
+    }
+
+    static TradeMessage normalize(const NseTradeWire& wire_) {
+        return TradeMessage{toNanos(wire_._timeStamp), toOrderId(wire_._buyOrderId),
+                            toOrderId(wire_._sellOrderId), wire_._token, wire_._price, wire_._quantity};
+    }
+
+    /**
+     * @brief Wire form of a message, for simulators, tests and benchmarks
+     */
+    static NseOrderWire encode(const OrderMessage& order_) {
+        return NseOrderWire{toSeconds(order_._timestamp), static_cast<double>(order_._orderId), order_._token,
+                            order_._orderType, order_._price, order_._quantity};
+    }
+
+    static NseTradeWire encode(const TradeMessage& trade_) {
+        return NseTradeWire{toSeconds(trade_._timeStamp), static_cast<double>(trade_._buyOrderId),
+                            static_cast<double>(trade_._sellOrderId), trade_._token, trade_._price, trade_._quantity};
+    }
+
+private:
+    // Converting a double outside the target range is undefined, so negative,
+    // NaN and out of range wire values decode as 0
+    static OrderIdT toOrderId(double id_) {
+        return id_ >= 0 && id_ < 18446744073709551616.0 ? static_cast<OrderIdT>(id_) : 0;
+    }
+
+    static TimestampT toNanos(double seconds_) {
+        return seconds_ > 0 && seconds_ < 9.2e9 ? static_cast<TimestampT>(std::llround(seconds_ * 1e9)) : 0;
+    }
+
+    static double toSeconds(TimestampT nanos_) {
+        return static_cast<double>(nanos_) / 1e9;
+    }
+};
+
+} // namespace MarketDataProvider
@@ -1,49 +1,103 @@
 #pragma once
 
+#include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <functional>
 
 namespace MarketDataProvider {
 
+/**
+ * @brief Kernel interface used to drain the socket
+ */
+enum SocketBackend : char {
+    RECVMMSG = 'M',   // poll + recvmmsg into a preallocated pool
+    IO_URING = 'U'    // Multishot recvmsg into a registered provided-buffer ring
+};
+
+/**
+ * @brief Receive-side tuning applied in NetworkSocket::connect()
+ */
+struct SocketConfig {
+    std::string   _interface         = "0.0.0.0";          // Local interface address that joins the group
+    int           _receiveBufferSize = 16 * 1024 * 1024;   // SO_RCVBUF, the kernel may clamp it
+    int           _busyPollMicros    = 0;                  // SO_BUSY_POLL, 0 leaves it off
+    bool          _multicastLoop     = true;               // Deliver our own sends, needed on one host
+    bool          _timestamps        = true;               // SO_TIMESTAMPNS kernel receive time
+    size_t        _batchSize         = 64;                 // Datagrams drained per recvmmsg
+    size_t        _maxPacketSize     = MAX_PACKET_SIZE;    // Larger datagrams are truncated
+    int           _pollTimeoutMillis = 100;                // Bounds how long stopReceiving() waits
+    SocketBackend _backend           = RECVMMSG;
+    unsigned      _bufferCount       = 1024;               // io_uring provided buffers, power of two
+};
+
+/**
+ * @brief Receive counters, updated by the receive thread
+ */
+struct SocketStats {
+    uint64_t _packets   = 0;
+    uint64_t _bytes     = 0;
+    uint64_t _batches   = 0;   // Callbacks delivered (recvmmsg calls or completion reaps)
+    uint64_t _truncated = 0;   // Datagrams larger than _maxPacketSize
+    uint64_t _noBuffers = 0;   // io_uring ran out of provided buffers and re-armed
+};
+
 /**
  * @brief Network socket for market data reception
+ *
+ * Joins a UDP multicast group (or binds a unicast port) with a non-blocking
+ * socket and drains it on a receive thread with recvmmsg into a buffer pool
+ * allocated in connect(), so a burst costs one syscall per batch rather
+ * than per datagram. The IO_URING backend (Linux, built with
+ * MARKET_DATA_PROVIDER_IO_URING) keeps one multishot recvmsg armed and the
+ * kernel writes datagrams straight into registered buffers; it falls back to
+ * RECVMMSG when unavailable.
  */
 class NetworkSocket {
 public:
-    using DataCallback = std::function<void(const char*, size_t)>;
-    
-    NetworkSocket(const std::string& host_, int port_);
+    using DataCallback  = std::function<void(const char*, size_t)>;
+    using BatchCallback = std::function<void(const PacketView*, size_t)>;
+
+    NetworkSocket(const std::string& host_, int port_, const SocketConfig& config_ = {});
     ~NetworkSocket();
 
     /**
-     * @brief Connect to market data server
+     * @brief Open the socket and join the multicast group
      */
     bool connect();
-    
+
     /**
-     * @brief Disconnect from server
+     * @brief Leave the group and close the socket
      */
     void disconnect();
-    
+
     /**
-     * @brief Start receiving data
+     * @brief Start receiving data, one callback per datagram
      */
     void startReceiving(DataCallback callback_);
-    
+
+    /**
+     * @brief Start receiving data, one callback per recvmmsg batch
+     */
+    void startReceivingBatch(BatchCallback callback_);
+
     /**
      * @brief Stop receiving data
      */
     void stopReceiving();
-    
+
     /**
-     * @brief Send data to server
+     * @brief Send a datagram to the group
      */
     bool send(const char* data_, size_t size_);
 
+    SocketStats   getStats() const;
+    SocketBackend getBackend() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> _impl;
 };
 
-} // namespace MarketDataProvider
\ No newline at end of file
+} // namespace MarketDataProvider
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <spdlog/spdlog.h>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Open addressing hash table keyed by integer order id
+ *
+ * Linear probing over a power-of-two slot array with fibonacci hashing.
+ * Erase uses backward-shift deletion, so there are no tombstones and probe
+ * lengths do not degrade as orders churn. The slot array is allocated up
+ * front and only grows (doubling) once the load factor passes 3/4.
+ * EmptyKey marks free slots, so an order that really has that id is kept
+ * in a slot of its own beside the array.
+ */
+template <typename ValueT>
+class OrderTable {
+public:
+    static constexpr OrderKeyT EmptyKey = std::numeric_limits<OrderKeyT>::max();
+
+    explicit OrderTable(size_t capacity_ = ORDER_TABLE_CAPACITY) {
+        // Size for the requested order count at the 3/4 load factor
+        allocate(std::bit_ceil(std::max<size_t>(capacity_ + capacity_ / 3 + 1, 8)));
+    }
+
+    ValueT* find(OrderKeyT key_) {
+        if (key_ == EmptyKey) {
+            return _hasEmptyKey ? &_emptyKeyValue : nullptr;
+        }
+        for (size_t slot = home(key_);; slot = (slot + 1) & _mask) {
+            Slot& entry = _slots[slot];
+            if (entry._key == key_) {
+                return &entry._value;
+            }
+            if (entry._key == EmptyKey) {
+                return nullptr;
+            }
+        }
+    }
+
+    const ValueT* find(OrderKeyT key_) const {
+        return const_cast<OrderTable*>(this)->find(key_);
+    }
+
+    /**
+     * @brief Insert or overwrite, returns the stored value
+     */
+    ValueT& insert(OrderKeyT key_, const ValueT& value_) {
+        ValueT& stored = (*this)[key_];
+        stored = value_;
+        return stored;
+    }
+
+    /**
+     * @brief Find or default-insert
+     */
+    ValueT& operator[](OrderKeyT key_) {
+        if (key_ == EmptyKey) {
+            if (!_hasEmptyKey) {
+                _hasEmptyKey   = true;
+                _emptyKeyValue = ValueT{};
+                ++_size;
+            }
+            return _emptyKeyValue;
+        }
+        if ((_size + 1) * 4 > _slots.size() * 3) {
+            grow();
+        }
+
+        size_t slot = home(key_);
+        for (;; slot = (slot + 1) & _mask) {
+            Slot& entry = _slots[slot];
+            if (entry._key == key_) {
+                return entry._value;
+            }
+            if (entry._key == EmptyKey) {
+                break;
+            }
+        }
+
+        ++_size;
+        _slots[slot]._key   = key_;
+        _slots[slot]._value = ValueT{};
+        return _slots[slot]._value;
+    }
+
+    bool erase(OrderKeyT key_) {
+        if (key_ == EmptyKey) {
+            if (!_hasEmptyKey) {
+                return false;
+            }
+            _hasEmptyKey = false;
+            --_size;
+            return true;
+        }
+        size_t slot = home(key_);
+        for (;; slot = (slot + 1) & _mask) {
+            if (_slots[slot]._key == key_) {
+                break;
+            }
+            if (_slots[slot]._key == EmptyKey) {
+                return false;
+            }
+        }
+
+        // Backward shift: pull later entries of the cluster into the hole
+        // unless doing so would move them before their home slot.
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & _mask;; next = (next + 1) & _mask) {
+            Slot& entry = _slots[next];
+            if (entry._key == EmptyKey) {
+                break;
+            }
+            const size_t entryHome = home(entry._key);
+            if (((next - entryHome) & _mask) >= ((next - hole) & _mask)) {
+                _slots[hole] = entry;
+                hole = next;
+            }
+        }
+        _slots[hole]._key = EmptyKey;
+        --_size;
+        return true;
+    }
+
+    /**
+     * @brief Hint the cache about the home slot of an upcoming lookup
+     */
+    void prefetch(OrderKeyT key_) const {
+        __builtin_prefetch(&_slots[home(key_)]);
+    }
+
+    template <typename FunctionT>
+    void forEach(FunctionT&& function_) const {
+        for (const Slot& entry : _slots) {
+            if (entry._key != EmptyKey) {
+                function_(entry._key, entry._value);
+            }
+        }
+        if (_hasEmptyKey) {
+            function_(EmptyKey, _emptyKeyValue);
+        }
+    }
+
+    void clear() {
+        for (Slot& entry : _slots) {
+            entry._key = EmptyKey;
+        }
+        _hasEmptyKey = false;
+        _size = 0;
+    }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _slots.size(); }
+    bool   empty() const { return _size == 0; }
+
+private:
+    struct Slot {
+        OrderKeyT _key = EmptyKey;
+        ValueT    _value{};
+    };
+
+    std::vector<Slot> _slots;
+    size_t            _mask  = 0;
+    size_t            _size  = 0;
+    uint32_t          _shift = 0;
+    bool              _hasEmptyKey = false;   // An entry whose key is EmptyKey
+    ValueT            _emptyKeyValue{};
+
+    size_t home(OrderKeyT key_) const {
+        return static_cast<size_t>((key_ * 0x9E3779B97F4A7C15ull) >> _shift);
+    }
+
+    void allocate(size_t slots_) {
+        _slots.assign(slots_, Slot{});
+        _mask  = slots_ - 1;
+        _shift = static_cast<uint32_t>(64 - std::countr_zero(slots_));
+        _size  = 0;
+    }
+
+    void grow() {
+        std::vector<Slot> previous = std::move(_slots);
+        allocate(previous.size() * 2);
+        spdlog::warn("OrderTable grown to {} slots, consider raising the preallocated capacity", _slots.size());
+
+        for (const Slot& entry : previous) {
+            if (entry._key != EmptyKey) {
+                size_t slot = home(entry._key);
+                while (_slots[slot]._key != EmptyKey) {
+                    slot = (slot + 1) & _mask;
+                }
+                _slots[slot] = entry;
+                ++_size;
+            }
+        }
+        _size += _hasEmptyKey ? 1 : 0;
+    }
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,360 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Price ordering for one side of the book, best price first
+ */
+template <Side S>
+struct SideTraits;
+
+template <>
+struct SideTraits<BUY> {
+    using ComparatorT = std::greater<PriceT>;
+    static constexpr bool better(PriceT lhs_, PriceT rhs_) { return lhs_ > rhs_; }
+};
+
+template <>
+struct SideTraits<SELL> {
+    using ComparatorT = std::less<PriceT>;
+    static constexpr bool better(PriceT lhs_, PriceT rhs_) { return lhs_ < rhs_; }
+};
+
+/**
+ * @brief Price level aggregation on a sorted flat_map, best price at begin()
+ */
+template <Side S>
+class FlatMapLadder {
+public:
+    void add(PriceT price_, QuantityT quantity_) {
+        _levels[price_] += quantity_;
+    }
+
+    void remove(PriceT price_, QuantityT quantity_) {
+        auto it = _levels.find(price_);
+        if (it != _levels.end()) {
+            it->second -= quantity_;
+            if (it->second <= 0) {
+                _levels.erase(it);
+            }
+        }
+    }
+
+    int fill(Ladder* out_, int depth_) const {
+        int count = 0;
+        for (auto it = _levels.begin(); it != _levels.end() && count < depth_; ++it, ++count) {
+            out_[count]._price    = it->first;
+            out_[count]._quantity = it->second;
+        }
+        return count;
+    }
+
+    Ladder best() const {
+        return _levels.empty() ? Ladder{} : Ladder{_levels.begin()->first, _levels.begin()->second};
+    }
+
+    bool   empty() const { return _levels.empty(); }
+    size_t size() const { return _levels.size(); }
+    void   clear() { _levels.clear(); }
+
+    auto begin() const { return _levels.begin(); }
+    auto end() const { return _levels.end(); }
+
+    /**
+     * @brief Visit every non-empty level, best price first
+     */
+    template <typename FunctionT>
+    void forEach(FunctionT&& function_) const {
+        for (const auto& [price, quantity] : _levels) {
+            function_(price, quantity);
+        }
+    }
+
+private:
+    ContainerT<typename SideTraits<S>::ComparatorT> _levels;
+};
+
+/**
+ * @brief Price level aggregation on a contiguous array indexed by tick
+ *
+ * Level i holds the quantity at _anchor + i * tickSize. The index of the best
+ * level is tracked on every add/remove so reading the top of the book is a
+ * short forward scan. Prices outside the window (or off the tick grid) are
+ * kept in a flat_map overflow; when the best price leaves the window the
+ * array is recentered on it.
+ */
+template <Side S>
+class TickLadder {
+public:
+    void configure(PriceT tickSize_, int levels_) {
+        _tickSize = tickSize_ > 0 ? tickSize_ : 1;
+        _levels.assign(static_cast<size_t>(std::max(levels_, 2)), 0);
+        _overflow.clear();
+        _best     = -1;
+        _count    = 0;
+        _anchored = false;
+    }
+
+    void add(PriceT price_, QuantityT quantity_) {
+        int index = indexOf(price_);
+        if (index < 0) {
+            if (!_anchored || (!isOffGrid(price_) && (_best < 0 || SideTraits<S>::better(price_, priceAt(_best))))) {
+                recenter(price_);
+                index = indexOf(price_);
+            }
+            if (index < 0) {
+                _overflow.add(price_, quantity_);
+                return;
+            }
+        }
+
+        QuantityT& level = _levels[index];
+        if (level == 0) {
+            ++_count;
+            if (_best < 0 || isBetter(index, _best)) {
+                _best = index;
+            }
+        }
+        level += quantity_;
+    }
+
+    void remove(PriceT price_, QuantityT quantity_) {
+        const int index = indexOf(price_);
+        if (index < 0) {
+            _overflow.remove(price_, quantity_);
+            return;
+        }
+
+        QuantityT& level = _levels[index];
+        if (level == 0) {
+            return;
+        }
+
+        level -= quantity_;
+        if (level <= 0) {
+            level = 0;
+            --_count;
+            if (index == _best) {
+                _best = nextLevel(index);
+            }
+            if (_best < 0 && !_overflow.empty()) {
+                recenter(_overflow.best()._price);
+            }
+        }
+    }
+
+    int fill(Ladder* out_, int depth_) const {
+        if (_overflow.empty()) {
+            int count = 0;
+            for (int index = _best; index >= 0 && count < depth_; index = nextLevel(index), ++count) {
+                out_[count]._price    = priceAt(index);
+                out_[count]._quantity = _levels[index];
+            }
+            return count;
+        }
+
+        // Merge array and overflow levels, best price first
+        int  count = 0;
+        int  index = _best;
+        auto other = _overflow.begin();
+        while (count < depth_ && (index >= 0 || other != _overflow.end())) {
+            if (index >= 0 && (other == _overflow.end() || SideTraits<S>::better(priceAt(index), other->first))) {
+                out_[count++] = Ladder{priceAt(index), _levels[index]};
+                index = nextLevel(index);
+            } else {
+                out_[count++] = Ladder{other->first, other->second};
+                ++other;
+            }
+        }
+        return count;
+    }
+
+    Ladder best() const {
+        const Ladder overflow = _overflow.best();
+        if (_best < 0) {
+            return overflow;
+        }
+        if (!_overflow.empty() && SideTraits<S>::better(overflow._price, priceAt(_best))) {
+            return overflow;
+        }
+        return Ladder{priceAt(_best), _levels[_best]};
+    }
+
+    bool   empty() const { return _count == 0 && _overflow.empty(); }
+    size_t size() const { return _count + _overflow.size(); }
+    void   clear() { configure(_tickSize, static_cast<int>(_levels.size())); }
+
+    template <typename FunctionT>
+    void forEach(FunctionT&& function_) const {
+        std::vector<Ladder> levels(size());
+        const int count = fill(levels.data(), static_cast<int>(levels.size()));
+        for (int i = 0; i < count; ++i) {
+            function_(levels[i]._price, levels[i]._quantity);
+        }
+    }
+
+private:
+    PriceT                 _tickSize = 1;
+    PriceT                 _anchor   = 0;
+    int                    _best     = -1;
+    size_t                 _count    = 0;
+    bool                   _anchored = false;
+    std::vector<QuantityT> _levels;
+    FlatMapLadder<S>       _overflow;
+
+    PriceT priceAt(int index_) const { return _anchor + index_ * _tickSize; }
+
+    bool isOffGrid(PriceT price_) const { return price_ % _tickSize != 0; }
+
+    int indexOf(PriceT price_) const {
+        if (!_anchored) {
+            return -1;
+        }
+        const int64_t offset = static_cast<int64_t>(price_) - _anchor;
+        if (offset < 0 || offset % _tickSize != 0) {
+            return -1;
+        }
+        const int64_t index = offset / _tickSize;
+        return index < static_cast<int64_t>(_levels.size()) ? static_cast<int>(index) : -1;
+    }
+
+    static constexpr bool isBetter(int lhs_, int rhs_) {
+        return S == BUY ? lhs_ > rhs_ : lhs_ < rhs_;
+    }
+
+    // Next non-empty level walking away from the top of the book, -1 if none
+    int nextLevel(int index_) const {
+        if (_count == 0) {
+            return -1;
+        }
+        if constexpr (S == BUY) {
+            for (int index = index_ - 1; index >= 0; --index) {
+                if (_levels[index] != 0) {
+                    return index;
+                }
+            }
+        } else {
+            const int size = static_cast<int>(_levels.size());
+            for (int index = index_ + 1; index < size; ++index) {
+                if (_levels[index] != 0) {
+                    return index;
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Move the window so that price_ sits in the middle and rehome every level
+    void recenter(PriceT price_) {
+        std::vector<std::pair<PriceT, QuantityT>> levels;
+        levels.reserve(_count + _overflow.size());
+        for (int index = 0; index < static_cast<int>(_levels.size()); ++index) {
+            if (_levels[index] != 0) {
+                levels.emplace_back(priceAt(index), _levels[index]);
+            }
+        }
+        _overflow.forEach([&levels](PriceT price, QuantityT quantity) { levels.emplace_back(price, quantity); });
+
+        std::fill(_levels.begin(), _levels.end(), 0);
+        _overflow.clear();
+        _best  = -1;
+        _count = 0;
+
+        const PriceT remainder = ((price_ % _tickSize) + _tickSize) % _tickSize;
+        _anchor   = price_ - remainder - static_cast<PriceT>(_levels.size() / 2) * _tickSize;
+        _anchored = true;
+
+        for (const auto& [price, quantity] : levels) {
+            const int index = indexOf(price);
+            if (index < 0) {
+                _overflow.add(price, quantity);
+                continue;
+            }
+            _levels[index] = quantity;
+            ++_count;
+            if (_best < 0 || isBetter(index, _best)) {
+                _best = index;
+            }
+        }
+    }
+};
+
+/**
+ * @brief One side of the book on the backend selected at construction
+ */
+template <Side S>
+class PriceLadder {
+public:
+    explicit PriceLadder(BookType type_ = FLAT_MAP, PriceT tickSize_ = 1, int tickLevels_ = TICK_LADDER_LEVELS)
+        : _type(type_) {
+        if (_type == TICK_ARRAY) {
+            _tick.configure(tickSize_, tickLevels_);
+        }
+    }
+
+    void add(PriceT price_, QuantityT quantity_) {
+        if (_type == TICK_ARRAY) {
+            _tick.add(price_, quantity_);
+        } else {
+            _flat.add(price_, quantity_);
+        }
+    }
+
+    void remove(PriceT price_, QuantityT quantity_) {
+        if (_type == TICK_ARRAY) {
+            _tick.remove(price_, quantity_);
+        } else {
+            _flat.remove(price_, quantity_);
+        }
+    }
+
+    int fill(Ladder* out_, int depth_) const {
+        return _type == TICK_ARRAY ? _tick.fill(out_, depth_) : _flat.fill(out_, depth_);
+    }
+
+    /**
+     * @brief fill() with the depth fixed at compile time, so the level loop has a constant bound
+     */
+    template <int N>
+    int fill(Ladder (&out_)[N]) const {
+        return _type == TICK_ARRAY ? _tick.fill(out_, N) : _flat.fill(out_, N);
+    }
+
+    Ladder best() const { return _type == TICK_ARRAY ? _tick.best() : _flat.best(); }
+
+    bool   empty() const { return _type == TICK_ARRAY ? _tick.empty() : _flat.empty(); }
+    size_t size() const { return _type == TICK_ARRAY ? _tick.size() : _flat.size(); }
+
+    void clear() {
+        if (_type == TICK_ARRAY) {
+            _tick.clear();
+        } else {
+            _flat.clear();
+        }
+    }
+
+    template <typename FunctionT>
+    void forEach(FunctionT&& function_) const {
+        if (_type == TICK_ARRAY) {
+            _tick.forEach(std::forward<FunctionT>(function_));
+        } else {
+            _flat.forEach(std::forward<FunctionT>(function_));
+        }
+    }
+
+    BookType type() const { return _type; }
+
+private:
+    BookType         _type;
+    FlatMapLadder<S> _flat;
+    TickLadder<S>    _tick;
+};
+
+} // namespace MarketDataProvider
@@ -1,16 +1,48 @@
 #pragma once
 
 #include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
 namespace MarketDataProvider {
 
+/**
+ * @brief Result of a recovery request handed back to the stream thread
+ */
+struct RecoveryEvent {
+    short          _streamId = 0;
+    int            _startSeq = 0;    // Requested range
+    int            _endSeq   = 0;
+    RecoveryStatus _status   = RECOVERY_DATA;
+    PacketSlot     _packet;          // Original packet for RECOVERY_DATA
+};
+
+/**
+ * @brief Recovery counters
+ */
+struct RecoveryStats {
+    uint64_t _requests  = 0;
+    uint64_t _packets   = 0;   // RECOVERY_DATA frames received
+    uint64_t _completed = 0;
+    uint64_t _rejected  = 0;
+};
+
 /**
  * @brief Market data recovery mechanism
+ *
+ * Missing ranges are fetched over TCP on a worker thread so the stream
+ * thread never blocks on the network. Requests go out as RecoveryRequest;
+ * the server answers with RecoveryResponse frames, one per recovered packet
+ * and a final RECOVERY_COMPLETE. Results reach the stream thread through a
+ * single-producer/single-consumer ring drained with pollEvents().
  */
 class Recovery {
 public:
+    using EventCallbackT  = std::function<void(const RecoveryEvent&)>;
+    using NotifyCallbackT = std::function<void()>;
+
     Recovery(const std::string& host_, int port_);
     ~Recovery();
 
@@ -18,20 +50,37 @@ public:
      * @brief Request recovery for missing sequence numbers
      */
     bool requestRecovery(short streamId_, int startSeq_, int endSeq_);
-    
+
     /**
      * @brief Process recovery response
      */
     void processRecoveryResponse(const RecoveryResponse& response_);
-    
+
     /**
      * @brief Check if recovery is needed
      */
     bool isRecoveryNeeded(short streamId_, int expectedSeq_, int receivedSeq_);
 
+    /**
+     * @brief Requests for the stream not yet completed or rejected
+     */
+    int getOutstanding(short streamId_) const;
+
+    /**
+     * @brief Drain up to max_ results on the consuming (stream) thread
+     */
+    size_t pollEvents(const EventCallbackT& callback_, size_t max_ = 64);
+
+    /**
+     * @brief Called from the worker after results are queued, e.g. to wake the consumer
+     */
+    void setNotify(NotifyCallbackT notify_);
+
+    RecoveryStats getStats() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> _impl;
 };
 
-} // namespace MarketDataProvider
\ No newline at end of file
+} // namespace MarketDataProvider
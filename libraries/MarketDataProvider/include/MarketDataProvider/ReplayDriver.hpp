@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MarketDataProvider/StreamManager.hpp"
+#include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace MarketDataProvider {
+
+class JournalReader;
+
+struct ReplayConfig {
+    double _speed            = 0.0;    // 0 replays as fast as possible, 1 at recorded pacing, 2 twice as fast
+    bool   _includeRecovered = true;   // Also replay packets the live session got from Recovery
+    bool   _measureLatency   = true;   // Time every process() call
+};
+
+struct ReplayStats {
+    uint64_t _packets           = 0;   // Journal records replayed
+    uint64_t _messages          = 0;   // Framed messages in them, a packet may carry several
+    uint64_t _bytes             = 0;
+    uint64_t _elapsedNanos      = 0;
+    double   _messagesPerSecond = 0.0;
+    uint64_t _p50Nanos          = 0;   // StreamManager::process latency percentiles, per packet
+    uint64_t _p90Nanos          = 0;
+    uint64_t _p99Nanos          = 0;
+    uint64_t _p999Nanos         = 0;
+    uint64_t _maxNanos          = 0;
+};
+
+/**
+ * @brief Final book of one token, for comparing runs
+ */
+struct LadderChecksum {
+    TokenT   _token    = 0;
+    uint64_t _checksum = 0;
+};
+
+/**
+ * @brief Pushes a recorded journal through StreamManager::process
+ *
+ * Runs flat out or paced on the recorded receive timestamps, scaled by
+ * ReplayConfig::_speed, and reports message throughput and per-packet latency.
+ * Packets are fed in journal order and no Recovery is attached, so a gap
+ * that recovery filled live is only refilled if the recovered packets are
+ * replayed and arrive before the stream moves past it.
+ */
+class ReplayDriver {
+public:
+    explicit ReplayDriver(StreamManager& manager_, const ReplayConfig& config_ = {});
+
+    ReplayStats run(JournalReader& reader_);
+
+    /**
+     * @brief FNV-1a of each token's current LadderDepth, tokens without a book are skipped
+     */
+    static std::vector<LadderChecksum> checksums(const StreamManager& manager_, const std::vector<TokenT>& tokens_);
+
+    static uint64_t checksum(const LadderDepth& depth_);
+
+private:
+    StreamManager& _manager;
+    ReplayConfig   _config;
+};
+
+} // namespace MarketDataProvider
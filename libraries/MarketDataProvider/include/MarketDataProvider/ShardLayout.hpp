@@ -0,0 +1,33 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Which worker owns each stream and which tokens each worker builds
+ *
+ * Every stream belongs to exactly one worker and every token to the worker
+ * of the streams that carry it, so no book, publisher or log is shared
+ * between workers.
+ */
+struct ShardLayout {
+    std::vector<size_t>              _streamWorkers;   // Worker of each stream
+    std::vector<std::vector<size_t>> _workerStreams;   // Streams of each worker, ascending
+    std::vector<std::vector<TokenT>> _workerTokens;    // Tokens of each worker, disjoint
+};
+
+/**
+ * @brief Deal streamCount_ streams round-robin over workerCount_ workers, each taking its streams' tokens
+ *
+ * streamTokens_ maps a stream index to the tokens it carries. Fails, and
+ * logs why, if a stream index is out of range or a token is carried by
+ * streams of two different workers, since both would then build its book.
+ */
+bool planShards(size_t streamCount_, size_t workerCount_, const std::map<size_t, std::vector<TokenT>>& streamTokens_,
+                ShardLayout& layout_);
+
+} // namespace MarketDataProvider
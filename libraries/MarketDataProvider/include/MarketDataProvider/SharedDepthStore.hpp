@@ -0,0 +1,136 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MarketDataProvider {
+
+class LadderBuilder;
+
+constexpr uint64_t SHARED_DEPTH_MAGIC   = 0x48545045444D444DULL;   // "MDMDEPTH"
+constexpr uint32_t SHARED_DEPTH_VERSION = 3;
+
+/**
+ * @brief One token's published book as seen by readers
+ */
+struct SharedDepth {
+    uint64_t      _version           = 0;     // LadderBuilder depth version
+    uint64_t      _updateNanos       = 0;     // Receive time of the packet behind the last write
+    LadderDepth   _depth;
+    BookAnalytics _analytics;
+    PriceT        _lastTradePrice    = 0;
+    QuantityT     _lastTradeQuantity = 0;
+    TimestampT    _lastTradeNanos    = 0;     // TradeMessage::_timeStamp
+    uint64_t      _tradeCount        = 0;
+    uint64_t      _tradeVolume       = 0;
+};
+
+/**
+ * @brief Seqlock-protected slot, one per token, never straddling another token's cache lines
+ */
+struct alignas(64) SharedDepthSlot {
+    std::atomic<uint64_t> _sequence{0};     // Odd while a write is in progress
+    TokenT                _token = 0;       // Fixed when the region is created
+    SharedDepth           _data;
+};
+
+/**
+ * @brief Start of the region, followed by _capacity slots
+ */
+struct alignas(64) SharedDepthHeader {
+    uint64_t              _magic;
+    uint32_t              _version;
+    uint32_t              _capacity;
+    uint32_t              _slotSize;
+    std::atomic<uint32_t> _live;            // Cleared when the writer closes
+    uint64_t              _createdNanos;
+};
+
+/**
+ * @brief LadderDepth and last trade per token in POSIX shared memory
+ *
+ * MarketDataApp creates the region (/dev/shm/<name>) and its StreamManagers
+ * write each token's slot after every book update; any local process
+ * attaches read-only and reads a slot without locks or system calls. Each
+ * slot is a seqlock: the writer makes the sequence odd, copies the data and
+ * makes it even again; a reader copies the data and retries if the sequence
+ * was odd or moved meanwhile, so readers never delay the writer. Writers
+ * claim the slot with a compare-exchange, which keeps a slot consistent
+ * should two stream threads ever carry the same token.
+ *
+ * A restarted writer creates a fresh region; readers of the old one see
+ * isLive() turn false and should attach again.
+ */
+class SharedDepthStore {
+public:
+    explicit SharedDepthStore(const std::string& name_);
+    ~SharedDepthStore();
+
+    SharedDepthStore(const SharedDepthStore&) = delete;
+    SharedDepthStore& operator=(const SharedDepthStore&) = delete;
+
+    /**
+     * @brief Writer: create the region with one slot per token, replacing any old one
+     */
+    bool create(const std::vector<TokenT>& tokens_);
+
+    /**
+     * @brief Reader: map an existing region read-only
+     */
+    bool attach();
+
+    /**
+     * @brief Unmap; the writer also marks the region closed and removes its name
+     */
+    void close();
+
+    bool isOpen() const { return _header != nullptr; }
+    bool isLive() const;
+
+    /**
+     * @brief Writer: copy builder_'s depth, and trade_ if given, into its token's slot
+     *
+     * rxNanos_ is the receive time of the packet that caused the change; the
+     * wall clock is read only when it is 0.
+     */
+    void publish(const LadderBuilder& builder_, uint64_t rxNanos_ = 0, const TradeMessage* trade_ = nullptr);
+
+    /**
+     * @brief Slot index for token_, -1 if not in the region
+     */
+    int findSlot(TokenT token_) const;
+
+    /**
+     * @brief Consistent copy of a slot; retries while the writer is inside it
+     */
+    void readSlot(int slot_, SharedDepth& depth_) const;
+
+    /**
+     * @brief Single attempt, false if a write overlapped
+     */
+    bool tryRead(int slot_, SharedDepth& depth_) const;
+
+    /**
+     * @brief readSlot() by token, false if token_ is not in the region
+     */
+    bool read(TokenT token_, SharedDepth& depth_) const;
+
+    const std::vector<TokenT>& getTokens() const { return _tokens; }
+
+private:
+    std::string                     _name;
+    SharedDepthHeader*              _header = nullptr;
+    SharedDepthSlot*                _slots  = nullptr;
+    size_t                          _size   = 0;
+    bool                            _writer = false;
+    std::vector<TokenT>             _tokens;
+    std::unordered_map<TokenT, int> _slotIndex;
+
+    bool map(int fd_, size_t size_, bool writable_);
+};
+
+} // namespace MarketDataProvider
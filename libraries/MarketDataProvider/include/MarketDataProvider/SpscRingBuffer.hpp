@@ -0,0 +1,251 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace MarketDataProvider {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief How the consumer waits for an empty ring to fill
+ */
+enum WaitStrategy : char {
+    BUSY_SPIN = 'S',   // Spin on the producer index, lowest latency, burns a core
+    BLOCKING  = 'B'    // Sleep on a futex, producer pays a fence per publish
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * @brief Single-producer/single-consumer ring of fixed-size slots
+ *
+ * Capacity is rounded up to a power of two. Producer and consumer indices
+ * live on separate cache lines and each side caches the other's index so
+ * the shared line is only read when the cached view says full/empty. The
+ * producer writes straight into a claimed slot and the consumer processes
+ * slots in place, so a packet is never copied between the two threads.
+ * When the ring is full the packet is dropped and counted rather than
+ * blocking the producer.
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity_, WaitStrategy waitStrategy_ = BUSY_SPIN)
+        : _capacity(std::bit_ceil(std::max<size_t>(capacity_, 2)))
+        , _mask(_capacity - 1)
+        , _waitStrategy(waitStrategy_)
+        , _slots(std::make_unique<T[]>(_capacity)) {
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // ---- Producer ----
+
+    /**
+     * @brief Slot to fill for the next publish(), nullptr (and a drop) if full
+     */
+    T* claim() {
+        const uint64_t tail = _producer._tail.load(std::memory_order_relaxed);
+        if (tail - _producer._cachedHead >= _capacity) {
+            _producer._cachedHead = _consumer._head.load(std::memory_order_acquire);
+            if (tail - _producer._cachedHead >= _capacity) {
+                _producer._drops.store(_producer._drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &_slots[tail & _mask];
+    }
+
+    /**
+     * @brief Make the claimed slot visible to the consumer
+     */
+    void publish() {
+        _producer._tail.store(_producer._tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        if (_waitStrategy == BLOCKING) {
+            notify();
+        }
+    }
+
+    bool tryPush(const T& item_) {
+        T* slot = claim();
+        if (!slot) {
+            return false;
+        }
+        *slot = item_;
+        publish();
+        return true;
+    }
+
+    // ---- Consumer ----
+
+    /**
+     * @brief Process up to max_ slots in place, returns the number consumed
+     */
+    template <typename FunctionT>
+    size_t popBatch(FunctionT&& function_, size_t max_) {
+        const uint64_t head = _consumer._head.load(std::memory_order_relaxed);
+        if (_consumer._cachedTail - head < max_) {
+            _consumer._cachedTail = _producer._tail.load(std::memory_order_acquire);
+            if (_consumer._cachedTail == head) {
+                return 0;
+            }
+        }
+
+        const size_t count = std::min<size_t>(_consumer._cachedTail - head, max_);
+        for (size_t i = 0; i < count; ++i) {
+            function_(_slots[(head + i) & _mask]);
+        }
+        _consumer._head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief popBatch handing the slots over as contiguous spans, two when the batch wraps
+     *
+     * Lets the consumer look ahead across the batch (e.g. to prefetch)
+     * while the slots are still its own.
+     */
+    template <typename FunctionT>
+    size_t popSpans(FunctionT&& function_, size_t max_) {
+        const uint64_t head = _consumer._head.load(std::memory_order_relaxed);
+        if (_consumer._cachedTail - head < max_) {
+            _consumer._cachedTail = _producer._tail.load(std::memory_order_acquire);
+            if (_consumer._cachedTail == head) {
+                return 0;
+            }
+        }
+
+        const size_t count = std::min<size_t>(_consumer._cachedTail - head, max_);
+        const size_t first = head & _mask;
+        const size_t run = std::min(count, _capacity - first);
+        function_(std::span<T>(&_slots[first], run));
+        if (run < count) {
+            function_(std::span<T>(&_slots[0], count - run));
+        }
+        _consumer._head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief popBatch after waiting with the ring's strategy while empty
+     *
+     * Returns early (possibly with nothing consumed) once running_ clears or
+     * interrupt() is called, so callers can service other work.
+     */
+    template <typename FunctionT>
+    size_t waitPopBatch(FunctionT&& function_, size_t max_, const std::atomic<bool>& running_) {
+        return waitPopBatch(std::forward<FunctionT>(function_), max_, running_, interrupts());
+    }
+
+    /**
+     * @brief waitPopBatch that also returns for any interrupt() after interrupts() read signal_
+     *
+     * Lets a consumer check other sources between reading interrupts() and
+     * waiting without missing a wake-up from them.
+     */
+    template <typename FunctionT>
+    size_t waitPopBatch(FunctionT&& function_, size_t max_, const std::atomic<bool>& running_, uint32_t signal_) {
+        auto ready = [&] {
+            return !empty() || !running_.load(std::memory_order_relaxed)
+                || _wait._signal.load(std::memory_order_acquire) != signal_;
+        };
+        if (_waitStrategy == BLOCKING) {
+            if (!ready()) {
+                // Store, fence, re-check: the mirror of notify(), so one side always sees the other
+                _wait._sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!ready()) {
+                    _wait._signal.wait(signal_, std::memory_order_acquire);
+                }
+                _wait._sleeping.store(false, std::memory_order_relaxed);
+            }
+        } else {
+            while (!ready()) {
+                cpuRelax();
+            }
+        }
+        return popBatch(std::forward<FunctionT>(function_), max_);
+    }
+
+    /**
+     * @brief Wake the consumer out of waitPopBatch
+     */
+    void interrupt() {
+        _wait._signal.fetch_add(1, std::memory_order_release);
+        _wait._signal.notify_all();
+    }
+
+    uint32_t interrupts() const { return _wait._signal.load(std::memory_order_acquire); }
+
+    // ---- Statistics, readable from any thread ----
+
+    bool empty() const {
+        return _producer._tail.load(std::memory_order_acquire) == _consumer._head.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        const uint64_t head = _consumer._head.load(std::memory_order_acquire);
+        return static_cast<size_t>(_producer._tail.load(std::memory_order_acquire) - head);
+    }
+
+    size_t       capacity() const { return _capacity; }
+    uint64_t     pushed() const { return _producer._tail.load(std::memory_order_relaxed); }
+    uint64_t     drops() const { return _producer._drops.load(std::memory_order_relaxed); }
+    WaitStrategy waitStrategy() const { return _waitStrategy; }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) ProducerState {
+        std::atomic<uint64_t> _tail{0};
+        std::atomic<uint64_t> _drops{0};
+        uint64_t              _cachedHead = 0;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) ConsumerState {
+        std::atomic<uint64_t> _head{0};
+        uint64_t              _cachedTail = 0;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) WaitState {
+        std::atomic<uint32_t> _signal{0};
+        std::atomic<bool>     _sleeping{false};
+    };
+
+    const size_t         _capacity;
+    const size_t         _mask;
+    const WaitStrategy   _waitStrategy;
+    std::unique_ptr<T[]> _slots;
+    ProducerState        _producer;
+    ConsumerState        _consumer;
+    WaitState            _wait;
+
+    void notify() {
+        // Pairs with the consumer's fence after it sets _sleeping: either it
+        // sees the new tail before sleeping or we see it sleeping and wake it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_wait._sleeping.load(std::memory_order_relaxed)) {
+            _wait._signal.fetch_add(1, std::memory_order_release);
+            _wait._signal.notify_one();
+        }
+    }
+};
+
+} // namespace MarketDataProvider
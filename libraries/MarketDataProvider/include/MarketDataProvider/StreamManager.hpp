@@ -1,45 +1,207 @@
 #pragma once
 
+#include "MarketDataProvider/MessageDecoder.hpp"
+#include "MarketDataProvider/Structure.hpp"
+#include "MarketDataProvider/TokenIndex.hpp"
+#include "MarketDataProvider/TscClock.hpp"
 #include <functional>
 #include <memory>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 namespace MarketDataProvider {
 
 class LadderBuilder;
+class Journal;
+class Recovery;
+class SharedDepthStore;
+class BarAggregator;
+class TradeTape;
+class LatencyRecorder;
+struct RecoveryEvent;
 using LadderBuilderPtrT = std::unique_ptr<LadderBuilder>;
 using LadderContainerT  = std::vector<LadderBuilderPtrT>;
 using TokenListT        = std::vector<int>;
 
-using FunctionPointerT = std::function<void(const char*)>;
+/**
+ * @brief Ladder backend selection applied to every builder in init()
+ */
+struct BookConfig {
+    BookType                           _type            = FLAT_MAP;
+    PriceT                             _defaultTickSize = 1;
+    std::unordered_map<TokenT, PriceT> _tickSizes;      // Contract tick size per token
+    size_t                             _orderCapacity   = ORDER_TABLE_CAPACITY;
+    std::unordered_map<TokenT, size_t> _orderCapacities; // Preallocated orders per token
+};
+
+/**
+ * @brief Sequencing counters for one stream
+ */
+struct StreamStats {
+    int      _expected   = 1;   // Next sequence number to apply
+    size_t   _buffered   = 0;   // Packets held in the reorder window
+    uint64_t _gaps       = 0;   // Gaps detected
+    uint64_t _duplicates = 0;   // Old or repeated packets dropped
+    uint64_t _recovered  = 0;   // Packets applied from recovery
+    uint64_t _skipped    = 0;   // Sequence numbers given up on
+    uint64_t _malformed  = 0;   // Messages too short for their type, dropped
+};
 
 /**
  * @brief Manages market data streams and processes incoming messages
+ *
+ * A packet may carry several messages back to back, each starting with a
+ * StreamHeader whose _len covers the header, type and body. Sequence
+ * numbers are tracked per message and StreamHeader::_streamId. With a Recovery
+ * attached, packets after a gap wait in a bounded reorder window while the
+ * missing range is fetched, then everything is applied in order; packets of
+ * other streams keep flowing. If the gap cannot be filled (recovery rejected
+ * or incomplete, or the window overflows) the missing numbers are skipped
+ * and the held packets applied. Without a Recovery gaps are logged and
+ * skipped immediately.
+ *
+ * Message bodies are decoded by DecoderT (see NseDecoder). Member
+ * definitions live in StreamManager.ipp, so any decoder, including one
+ * outside this library, is instantiated by including it.
  */
-class StreamManager final {
+template <typename DecoderT>
+class BasicStreamManager final {
 public:
-    explicit StreamManager(int size_);
+    explicit BasicStreamManager(int size_);
     
     /**
-     * @brief Process incoming market data buffer
+     * @brief Process incoming market data buffer received at rxNanos_
      */
-    void process(const char* buffer_, size_t size_);
+    void process(const char* buffer_, size_t size_, uint64_t rxNanos_ = 0);
+
+    /**
+     * @brief process() every packet in order, prefetching the books of packets
+     *        PREFETCH_DISTANCE ahead; recovery is polled once per batch
+     */
+    void processBatch(std::span<const PacketView> packets_);
     
     /**
      * @brief Initialize with token list
      */
-    void init(const TokenListT& tokenList_);
+    void init(const TokenListT& tokenList_, const BookConfig& config_ = {});
+
+    /**
+     * @brief Get the ladder builder for a token, nullptr if not subscribed
+     */
+    const LadderBuilder* getLadderBuilder(TokenT token_) const;
+    LadderBuilder*       getLadderBuilder(TokenT token_);
+
+    /**
+     * @brief Visit every subscribed token's builder
+     */
+    void forEachLadderBuilder(const std::function<void(const LadderBuilder&)>& function_) const;
+
+    /**
+     * @brief Register for top-of-book delta events on every token
+     */
+    void subscribe(const std::function<void(const DepthUpdate&)>& callback_);
+
+    /**
+     * @brief Fill gaps through recovery_ (not owned), nullptr to skip gaps
+     */
+    void setRecovery(Recovery* recovery_);
+
+    /**
+     * @brief Record every packet passed to process() and every recovered packet in journal_ (not owned)
+     */
+    void setJournal(Journal* journal_);
+
+    /**
+     * @brief Write every book change and trade into store_ (not owned)
+     */
+    void setDepthStore(SharedDepthStore* store_);
+
+    /**
+     * @brief Feed every trade of a subscribed token to bars_ (not owned)
+     */
+    void setBarAggregator(BarAggregator* bars_);
+
+    /**
+     * @brief Record every trade of a subscribed token on tape_ (not owned)
+     */
+    void setTradeTape(TradeTape* tape_);
+
+    /**
+     * @brief Time every message's stages into recorder_ (not owned), nullptr to stop
+     *
+     * Costs a few TSC reads per message while attached and one branch when not.
+     */
+    void setLatencyRecorder(LatencyRecorder* recorder_);
+
+    /**
+     * @brief Apply recovered packets; process() also does this on every call
+     */
+    size_t pollRecovery();
+
+    StreamStats getStreamStats(short streamId_) const;
+    bool        isRecovering(short streamId_) const;
+
+    /**
+     * @brief Continue a stream at sequence expected_, dropping held packets (e.g. after a restore)
+     */
+    void resetStream(short streamId_, int expected_);
 
 protected:
-    void newOrder(const char* buffer_);
-    void modifyOrder(const char* buffer_);
-    void cancelOrder(const char* buffer_);
-    void tradeOrder(const char* buffer_);
+    friend DecoderT;
+
+    void newOrder(const OrderMessage& order_);
+    void modifyOrder(const OrderMessage& order_);
+    void cancelOrder(const OrderMessage& order_);
+    void tradeOrder(const TradeMessage& trade_);
+    void unknownMessage(char type_);
+    void prefetchOrder(TokenT token_, OrderIdT orderId_) const;
 
 private:
-    int              _sequence = 0;
+    struct StreamState {
+        int                     _expected = 1;
+        int                     _highest  = 0;   // Highest sequence applied or held
+        size_t                  _buffered = 0;
+        int                     _requests = 0;   // Recovery requests not yet completed
+        std::vector<PacketSlot> _window;         // Indexed by sequence % REORDER_WINDOW, allocated on first gap
+        StreamStats             _stats;
+    };
+
     LadderContainerT _manager;
-    FunctionPointerT _function[26];
+    TokenIndex       _tokenIndex;
+    StreamState      _streams[MaxStream];
+    Recovery*        _recovery    = nullptr;
+    Journal*         _journal     = nullptr;
+    SharedDepthStore* _depthStore = nullptr;
+    BarAggregator*   _bars        = nullptr;
+    TradeTape*       _tape        = nullptr;
+    LatencyRecorder* _latency     = nullptr;
+    uint64_t         _decodedTicks = 0;        // TscClock stamps of the message being dispatched
+    uint64_t         _bookTicks    = 0;        // Written by the LadderBuilder when its depth changes
+    uint64_t         _rxNanos     = 0;         // Receive time of the packet being processed
+    TscClock::WallAnchor _wallAnchor;          // Wall clock read when _rxNanos was set, for the receive stages
+    int              _outstanding = 0;         // Recovery requests across all streams
+
+    void receive(const char* buffer_, size_t size_, uint64_t rxNanos_);
+    void frame(const char* buffer_, size_t size_, bool recovered_);
+    void setReceiveTime(uint64_t rxNanos_);
+    void prefetch(const char* buffer_, size_t size_) const;
+    void sequence(short streamId_, const char* buffer_, size_t size_, bool recovered_);
+    bool dispatch(const char* buffer_, size_t size_);
+    bool dispatchTimed(const char* buffer_, size_t length_);
+    bool decode(const char* buffer_, size_t length_);
+    void markDecoded();
+    void apply(StreamState& stream_, const char* buffer_, size_t size_);
+    bool hold(StreamState& stream_, int sequence_, const char* buffer_, size_t size_);
+    void releaseHeld(StreamState& stream_);
+    void skipGap(short streamId_);
+    void onRecoveryEvent(const RecoveryEvent& event_);
+    void publishDepth(const LadderBuilder& builder_, uint64_t version_);
 };
 
+// Compiled once into the library; saves every includer instantiating it
+extern template class BasicStreamManager<NseDecoder>;
+
+using StreamManager = BasicStreamManager<NseDecoder>;
+
 } // namespace MarketDataProvider
\ No newline at end of file
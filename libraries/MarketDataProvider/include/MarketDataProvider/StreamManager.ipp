@@ -0,0 +1,543 @@
+#pragma once
+
+// Member definitions of BasicStreamManager. Include this instead of
+// StreamManager.hpp in the one translation unit that instantiates it for a
+// new decoder: template class MarketDataProvider::BasicStreamManager<MyDecoder>;
+
+#include "MarketDataProvider/StreamManager.hpp"
+#include "MarketDataProvider/BarAggregator.hpp"
+#include "MarketDataProvider/Journal.hpp"
+#include "MarketDataProvider/LatencyHistogram.hpp"
+#include "MarketDataProvider/LadderBuilder.hpp"
+#include "MarketDataProvider/Recovery.hpp"
+#include "MarketDataProvider/SharedDepthStore.hpp"
+#include "MarketDataProvider/Structure.hpp"
+#include "MarketDataProvider/TradeTape.hpp"
+#include "MarketDataProvider/TscClock.hpp"
+
+#include <Profiling/Profiling.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace MarketDataProvider {
+
+template <typename DecoderT>
+BasicStreamManager<DecoderT>::BasicStreamManager(int size_) : _manager(size_) {}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::process(const char* buffer_, size_t size_, uint64_t rxNanos_) {
+    PROFILE_ZONE();
+    if (_outstanding > 0) {
+        pollRecovery();
+    }
+    receive(buffer_, size_, rxNanos_);
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::processBatch(std::span<const PacketView> packets_) {
+    PROFILE_ZONE();
+    if (_outstanding > 0) {
+        pollRecovery();
+    }
+
+    for (size_t i = 0; i < std::min(PREFETCH_DISTANCE, packets_.size()); ++i) {
+        prefetch(packets_[i]._data, packets_[i]._size);
+    }
+    for (size_t i = 0; i < packets_.size(); ++i) {
+        if (i + PREFETCH_DISTANCE < packets_.size()) {
+            prefetch(packets_[i + PREFETCH_DISTANCE]._data, packets_[i + PREFETCH_DISTANCE]._size);
+        }
+        receive(packets_[i]._data, packets_[i]._size, packets_[i]._rxNanos);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::receive(const char* buffer_, size_t size_, uint64_t rxNanos_) {
+    if (_journal) {
+        const short streamId = size_ >= sizeof(StreamHeader) ? reinterpret_cast<const StreamHeader*>(buffer_)->_streamId : -1;
+        _journal->append(buffer_, size_, streamId, rxNanos_);
+    }
+
+    if (size_ < sizeof(StreamHeader) + 1) {
+        spdlog::error("Invalid buffer size: {}", size_);
+        return;
+    }
+
+    setReceiveTime(rxNanos_);
+    frame(buffer_, size_, false);
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::frame(const char* buffer_, size_t size_, bool recovered_) {
+    // A datagram, live or recovered, may carry several messages back to back
+    for (size_t offset = 0; offset < size_;) {
+        const auto* header = reinterpret_cast<const StreamHeader*>(buffer_ + offset);
+        const size_t length = size_ - offset >= sizeof(StreamHeader) ? static_cast<size_t>(header->_len) : 0;
+        if (length < sizeof(StreamHeader) + 1 || length > size_ - offset) {
+            spdlog::error("Invalid message length {} at offset {} of {}", length, offset, size_);
+            return;
+        }
+
+        if (header->_streamId < 0 || header->_streamId >= MaxStream) {
+            spdlog::error("Invalid stream id: {}", header->_streamId);
+        } else {
+            sequence(header->_streamId, buffer_ + offset, length, recovered_);
+        }
+        offset += length;
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setReceiveTime(uint64_t rxNanos_) {
+    _rxNanos = rxNanos_;
+    // Fresh per packet, so TSC rate error and NTP slewing never accumulate into the receive stages
+    if (_latency && _rxNanos) {
+        _wallAnchor = TscClock::anchor();
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::prefetch(const char* buffer_, size_t size_) const {
+    for (size_t offset = 0; size_ - offset >= sizeof(StreamHeader) + 1;) {
+        const auto* header = reinterpret_cast<const StreamHeader*>(buffer_ + offset);
+        const size_t length = static_cast<size_t>(header->_len);
+        if (length < sizeof(StreamHeader) + 1 || length > size_ - offset) {
+            return;
+        }
+        DecoderT::prefetch(buffer_[offset + sizeof(StreamHeader)], buffer_ + offset + sizeof(StreamHeader) + 1,
+                           length - sizeof(StreamHeader) - 1, *this);
+        offset += length;
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::sequence(short streamId_, const char* buffer_, size_t size_, bool recovered_) {
+    StreamState& stream = _streams[streamId_];
+    const int sequence = reinterpret_cast<const StreamHeader*>(buffer_)->_sequence;
+
+    if (sequence < stream._expected) {
+        ++stream._stats._duplicates;
+        return;
+    }
+
+    if (sequence == stream._expected) {
+        apply(stream, buffer_, size_);
+        if (recovered_) {
+            ++stream._stats._recovered;
+        }
+        if (stream._buffered) {
+            releaseHeld(stream);
+        }
+        return;
+    }
+
+    // Gap. Recovered packets only ever fill holes, they never open new ones
+    if (recovered_) {
+        if (sequence - stream._expected < REORDER_WINDOW && hold(stream, sequence, buffer_, size_)) {
+            ++stream._stats._recovered;
+        }
+        return;
+    }
+
+    if (!_recovery || sequence - stream._expected >= REORDER_WINDOW) {
+        if (_recovery) {
+            spdlog::error("Stream {} is {} packets ahead of sequence {}, reorder window exceeded",
+                          streamId_, sequence - stream._expected, stream._expected);
+        } else {
+            spdlog::warn("Sequence gap on stream {}. Expected: {}, Received: {}",
+                         streamId_, stream._expected, sequence);
+        }
+        ++stream._stats._gaps;
+        while (stream._buffered) {
+            skipGap(streamId_);
+        }
+        stream._stats._skipped += sequence - stream._expected;
+        stream._expected = sequence;
+        apply(stream, buffer_, size_);
+        return;
+    }
+
+    if (!hold(stream, sequence, buffer_, size_)) {
+        return;
+    }
+
+    // Request only the numbers not already covered by an earlier request
+    if (sequence > stream._highest + 1) {
+        const int first = std::max(stream._expected, stream._highest + 1);
+        ++stream._stats._gaps;
+        spdlog::warn("Sequence gap on stream {}. Missing [{}, {}]", streamId_, first, sequence - 1);
+        if (_recovery->requestRecovery(streamId_, first, sequence - 1)) {
+            ++stream._requests;
+            ++_outstanding;
+        }
+    }
+    stream._highest = std::max(stream._highest, sequence);
+
+    if (stream._requests == 0) {
+        while (stream._buffered) {
+            skipGap(streamId_);
+        }
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::apply(StreamState& stream_, const char* buffer_, size_t size_) {
+    if (!dispatch(buffer_, size_)) {
+        ++stream_._stats._malformed;
+    }
+    stream_._highest = std::max(stream_._highest, stream_._expected);
+    ++stream_._expected;
+}
+
+template <typename DecoderT>
+bool BasicStreamManager<DecoderT>::hold(StreamState& stream_, int sequence_, const char* buffer_, size_t size_) {
+    if (size_ > MAX_PACKET_SIZE) {
+        spdlog::error("Cannot hold packet of {} bytes, sequence {}", size_, sequence_);
+        return false;
+    }
+    if (stream_._window.empty()) {
+        stream_._window.resize(REORDER_WINDOW);
+    }
+
+    // Held sequences lie in (expected, expected + window), so slots never collide
+    PacketSlot& slot = stream_._window[sequence_ % REORDER_WINDOW];
+    if (slot._size != 0) {
+        ++stream_._stats._duplicates;
+        return false;
+    }
+    std::memcpy(slot._data, buffer_, size_);
+    slot._size = static_cast<uint32_t>(size_);
+    ++stream_._buffered;
+    return true;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::releaseHeld(StreamState& stream_) {
+    while (stream_._buffered) {
+        PacketSlot& slot = stream_._window[stream_._expected % REORDER_WINDOW];
+        if (slot._size == 0) {
+            return;
+        }
+        const size_t size = slot._size;
+        slot._size = 0;
+        --stream_._buffered;
+        apply(stream_, slot._data, size);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::skipGap(short streamId_) {
+    StreamState& stream = _streams[streamId_];
+    if (!stream._buffered) {
+        return;
+    }
+
+    int next = stream._expected;
+    while (stream._window[next % REORDER_WINDOW]._size == 0) {
+        ++next;
+    }
+    spdlog::warn("Stream {} skipping unrecoverable sequence numbers [{}, {}]", streamId_, stream._expected, next - 1);
+    stream._stats._skipped += next - stream._expected;
+    stream._expected = next;
+    releaseHeld(stream);
+}
+
+template <typename DecoderT>
+size_t BasicStreamManager<DecoderT>::pollRecovery() {
+    if (!_recovery) {
+        return 0;
+    }
+    return _recovery->pollEvents([this](const RecoveryEvent& event_) { onRecoveryEvent(event_); });
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::onRecoveryEvent(const RecoveryEvent& event_) {
+    if (event_._streamId < 0 || event_._streamId >= MaxStream) {
+        return;
+    }
+
+    if (event_._status == RECOVERY_DATA) {
+        if (_journal) {
+            _journal->append(event_._packet._data, event_._packet._size, event_._streamId,
+                             event_._packet._rxNanos, JOURNAL_RECOVERED);
+        }
+        if (event_._packet._size >= sizeof(StreamHeader) + 1) {
+            setReceiveTime(event_._packet._rxNanos);
+            frame(event_._packet._data, event_._packet._size, true);
+        }
+        return;
+    }
+
+    // Everything the server had for the range has been applied or held, so
+    // a hole still inside it will not be filled
+    StreamState& stream = _streams[event_._streamId];
+    // A completion for a request made before resetStream() has nothing left to count against
+    if (stream._requests > 0) {
+        --stream._requests;
+        --_outstanding;
+    }
+    while (stream._buffered && stream._expected >= event_._startSeq && stream._expected <= event_._endSeq) {
+        skipGap(event_._streamId);
+    }
+    if (stream._requests == 0) {
+        while (stream._buffered) {
+            skipGap(event_._streamId);
+        }
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setRecovery(Recovery* recovery_) {
+    _recovery = recovery_;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setJournal(Journal* journal_) {
+    _journal = journal_;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setDepthStore(SharedDepthStore* store_) {
+    _depthStore = store_;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setBarAggregator(BarAggregator* bars_) {
+    _bars = bars_;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setTradeTape(TradeTape* tape_) {
+    _tape = tape_;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::setLatencyRecorder(LatencyRecorder* recorder_) {
+    if (recorder_) {
+        TscClock::calibrate();
+    }
+    _latency = recorder_;
+    for (auto& builder : _manager) {
+        builder->setUpdateStamp(_latency ? &_bookTicks : nullptr);
+    }
+}
+
+template <typename DecoderT>
+StreamStats BasicStreamManager<DecoderT>::getStreamStats(short streamId_) const {
+    if (streamId_ < 0 || streamId_ >= MaxStream) {
+        return {};
+    }
+    StreamStats stats = _streams[streamId_]._stats;
+    stats._expected = _streams[streamId_]._expected;
+    stats._buffered = _streams[streamId_]._buffered;
+    return stats;
+}
+
+template <typename DecoderT>
+bool BasicStreamManager<DecoderT>::isRecovering(short streamId_) const {
+    if (streamId_ < 0 || streamId_ >= MaxStream) {
+        return false;
+    }
+    return _streams[streamId_]._requests > 0 || _streams[streamId_]._buffered > 0;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::resetStream(short streamId_, int expected_) {
+    if (streamId_ < 0 || streamId_ >= MaxStream) {
+        return;
+    }
+    StreamState& stream = _streams[streamId_];
+    _outstanding -= stream._requests;
+    stream = StreamState{};
+    stream._expected = std::max(expected_, 1);
+    stream._highest  = stream._expected - 1;
+}
+
+template <typename DecoderT>
+bool BasicStreamManager<DecoderT>::dispatch(const char* buffer_, size_t size_) {
+    // Every message reaches here through frame(), so size_ is its checked length
+    if (size_ < sizeof(StreamHeader) + 1) {
+        spdlog::error("Message of {} bytes has no body", size_);
+        return false;
+    }
+    if (_latency) {
+        return dispatchTimed(buffer_, size_);
+    }
+    return decode(buffer_, size_);
+}
+
+template <typename DecoderT>
+bool BasicStreamManager<DecoderT>::decode(const char* buffer_, size_t length_) {
+    if (DecoderT::decode(buffer_[sizeof(StreamHeader)], buffer_ + sizeof(StreamHeader) + 1,
+                         length_ - sizeof(StreamHeader) - 1, *this)) {
+        return true;
+    }
+    spdlog::error("Message type {} too short at {} bytes", buffer_[sizeof(StreamHeader)], length_);
+    return false;
+}
+
+template <typename DecoderT>
+bool BasicStreamManager<DecoderT>::dispatchTimed(const char* buffer_, size_t length_) {
+    _decodedTicks = 0;
+    _bookTicks    = 0;
+    const uint64_t start = TscClock::now();
+    const bool decoded = decode(buffer_, length_);
+    const uint64_t end = TscClock::now();
+
+    const short streamId = reinterpret_cast<const StreamHeader*>(buffer_)->_streamId;
+    if (_decodedTicks) {
+        _latency->record(streamId, DECODE_STAGE, TscClock::toNanos(_decodedTicks - start));
+        // Without a depth change nothing was published, the whole handler is book work
+        const uint64_t bookEnd = _bookTicks ? _bookTicks : end;
+        _latency->record(streamId, BOOK_STAGE, TscClock::toNanos(bookEnd - _decodedTicks));
+        if (_bookTicks) {
+            _latency->record(streamId, PUBLISH_STAGE, TscClock::toNanos(end - _bookTicks));
+        }
+    }
+    // Socket stamps are wall clock, a stamp ahead of our clock would only be clock skew
+    if (_rxNanos) {
+        const uint64_t startWall = TscClock::toWallNanos(start, _wallAnchor);
+        const uint64_t endWall = TscClock::toWallNanos(end, _wallAnchor);
+        _latency->record(streamId, RECEIVE_STAGE, startWall > _rxNanos ? startWall - _rxNanos : 0);
+        _latency->record(streamId, TICK_TO_BOOK_STAGE, endWall > _rxNanos ? endWall - _rxNanos : 0);
+    }
+    return decoded;
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::markDecoded() {
+    if (_latency) {
+        _decodedTicks = TscClock::now();
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::init(const TokenListT& tokenList_, const BookConfig& config_) {
+    _manager.clear();
+    _manager.reserve(tokenList_.size());
+
+    std::vector<std::pair<TokenT, LadderBuilder*>> entries;
+    entries.reserve(tokenList_.size());
+    std::unordered_set<TokenT> seen(tokenList_.size());
+
+    for (int token : tokenList_) {
+        if (!seen.insert(token).second) {
+            spdlog::warn("Duplicate token {} in token list, ignoring", token);
+            continue;
+        }
+        auto tickSize = config_._tickSizes.find(token);
+        auto orderCapacity = config_._orderCapacities.find(token);
+        _manager.emplace_back(std::make_unique<LadderBuilder>(
+            token, config_._type,
+            tickSize != config_._tickSizes.end() ? tickSize->second : config_._defaultTickSize,
+            orderCapacity != config_._orderCapacities.end() ? orderCapacity->second : config_._orderCapacity));
+        entries.emplace_back(token, _manager.back().get());
+        if (_latency) {
+            _manager.back()->setUpdateStamp(&_bookTicks);
+        }
+    }
+
+    _tokenIndex.build(entries);
+
+    spdlog::info("StreamManager initialized with {} tokens ({} index)",
+                 _manager.size(), _tokenIndex.isDense() ? "dense" : "hashed");
+}
+
+template <typename DecoderT>
+const LadderBuilder* BasicStreamManager<DecoderT>::getLadderBuilder(TokenT token_) const {
+    return _tokenIndex.find(token_);
+}
+
+template <typename DecoderT>
+LadderBuilder* BasicStreamManager<DecoderT>::getLadderBuilder(TokenT token_) {
+    return _tokenIndex.find(token_);
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::forEachLadderBuilder(const std::function<void(const LadderBuilder&)>& function_) const {
+    for (const auto& builder : _manager) {
+        if (builder) {
+            function_(*builder);
+        }
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::subscribe(const std::function<void(const DepthUpdate&)>& callback_) {
+    for (auto& builder : _manager) {
+        if (builder) {
+            builder->subscribe(callback_);
+        }
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::newOrder(const OrderMessage& order_) {
+    markDecoded();
+    if (LadderBuilder* builder = _tokenIndex.find(order_._token)) {
+        const uint64_t version = builder->getVersion();
+        builder->processNewOrder(order_);
+        publishDepth(*builder, version);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::modifyOrder(const OrderMessage& order_) {
+    markDecoded();
+    if (LadderBuilder* builder = _tokenIndex.find(order_._token)) {
+        const uint64_t version = builder->getVersion();
+        builder->processModifyOrder(order_);
+        publishDepth(*builder, version);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::cancelOrder(const OrderMessage& order_) {
+    markDecoded();
+    if (LadderBuilder* builder = _tokenIndex.find(order_._token)) {
+        const uint64_t version = builder->getVersion();
+        builder->processCancelOrder(order_);
+        publishDepth(*builder, version);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::tradeOrder(const TradeMessage& trade_) {
+    markDecoded();
+    if (LadderBuilder* builder = _tokenIndex.find(trade_._token)) {
+        // The aggressor is read off the book before the trade changes it
+        if (_tape) {
+            _tape->record(trade_, builder->getAggressor(trade_));
+        }
+        builder->processTrade(trade_);
+        if (_depthStore) {
+            _depthStore->publish(*builder, _rxNanos, &trade_);
+        }
+        if (_bars) {
+            _bars->onTrade(trade_);
+        }
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::unknownMessage(char type_) {
+    spdlog::error("Unknown message type: {}", type_);
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::prefetchOrder(TokenT token_, OrderIdT orderId_) const {
+    if (const LadderBuilder* builder = _tokenIndex.find(token_)) {
+        builder->prefetch(orderId_);
+    }
+}
+
+template <typename DecoderT>
+void BasicStreamManager<DecoderT>::publishDepth(const LadderBuilder& builder_, uint64_t version_) {
+    if (_depthStore && builder_.getVersion() != version_) {
+        _depthStore->publish(builder_, _rxNanos);
+    }
+}
+
+} // namespace MarketDataProvider
@@ -3,19 +3,31 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <utility>
 
 namespace MarketDataProvider {
 
 using PriceT    = int;
 using QuantityT = int;
-using OrderIdT  = double;
-using TokenT    = int;
+using OrderIdT   = uint64_t;
+using OrderKeyT  = OrderIdT;
+using TimestampT = uint64_t;   // Nanoseconds since the epoch
+using TokenT     = int;
 
 constexpr int MaxStream = 16;
 constexpr int LADDER_DEPTH = 5;
-
-using ComparatorT = std::less<>;
+constexpr int TICK_LADDER_LEVELS = 1024;
+constexpr size_t ORDER_TABLE_CAPACITY = 128;   // Default resting orders per token
+constexpr size_t MAX_PACKET_SIZE = 1472;       // Ethernet MTU less IPv4 and UDP headers
+constexpr size_t PACKET_QUEUE_CAPACITY = 8192; // Default packets queued per stream
+constexpr int REORDER_WINDOW = 256;            // Out-of-order packets held per stream while recovering
+constexpr size_t PREFETCH_DISTANCE = 4;        // Packets ahead processBatch() prefetches books for
+constexpr int ARBITRATION_WINDOW = 4096;       // Recent sequence numbers remembered per stream for A/B arbitration
+constexpr size_t CONFLATION_LOG_CAPACITY = 65536; // Changed tokens a conflated subscriber may fall behind by
+constexpr size_t BAR_HISTORY = 512;               // Closed bars kept per token and bar spec
+constexpr size_t TRADE_TAPE_CAPACITY = 1024;      // Recent trades kept per token, rounded up to a power of two
 
 // Allocator for price-quantity pairs in ladder
 using LadderAllocatorT = boost::fast_pool_allocator<
@@ -36,16 +48,6 @@ struct Order {
     QuantityT _quantity;
 };
 
-// Allocator for order ID to order pairs
-using OrderAllocatorT = boost::fast_pool_allocator<
-    std::pair<OrderIdT, Order>,
-    boost::default_user_allocator_malloc_free, 
-    boost::details::pool::null_mutex, 
-    8, 32
->;
-
-using OrderContainerT = boost::container::flat_map<OrderIdT, Order, ComparatorT, OrderAllocatorT>;
-
 #pragma pack(push, 1)
 
 /**
@@ -57,14 +59,22 @@ struct Ladder {
 };
 
 /**
- * @brief Market depth structure
+ * @brief Market depth structure, the best N levels per side
  */
-struct LadderDepth {
+template <int N>
+struct BasicLadderDepth {
+    static constexpr int Depth = N;
+
     TokenT  _token = 0;
-    Ladder  _bid[LADDER_DEPTH];
-    Ladder  _ask[LADDER_DEPTH];
+    Ladder  _bid[N];
+    Ladder  _ask[N];
 };
 
+/**
+ * @brief Depth published by LadderBuilder, shared memory and conflation
+ */
+using LadderDepth = BasicLadderDepth<LADDER_DEPTH>;
+
 /**
  * @brief Stream message header
  */
@@ -75,30 +85,6 @@ struct StreamHeader {
     char  _type;
 };
 
-/**
- * @brief Order message structure
- */
-struct OrderMessage {
-    double _timestamp;
-    double _orderId;
-    TokenT _token;
-    char   _orderType;
-    PriceT _price;
-    QuantityT _quantity;
-};
-
-/**
- * @brief Trade message structure
- */
-struct TradeMessage {
-    double _timeStamp;
-    double _buyOrderId;
-    double _sellOrderId;
-    TokenT _token;
-    PriceT _price;
-    QuantityT _quantity;
-};
-
 /**
  * @brief Stream data packet
  */
@@ -121,6 +107,10 @@ struct RecoveryRequest {
 
 /**
  * @brief Recovery response structure
+ *
+ * Each frame on the recovery connection starts with one; _msgLen covers the
+ * frame, so a RECOVERY_DATA frame is followed by the original packet, which
+ * like a live datagram may hold several messages.
  */
 struct RecoveryResponse {
     short _msgLen;
@@ -132,6 +122,30 @@ struct RecoveryResponse {
 
 #pragma pack(pop)
 
+/**
+ * @brief Order message structure, as normalized by the feed's decoder
+ */
+struct OrderMessage {
+    TimestampT _timestamp;
+    OrderIdT   _orderId;
+    TokenT     _token;
+    char       _orderType;
+    PriceT     _price;
+    QuantityT  _quantity;
+};
+
+/**
+ * @brief Trade message structure, as normalized by the feed's decoder
+ */
+struct TradeMessage {
+    TimestampT _timeStamp;
+    OrderIdT   _buyOrderId;
+    OrderIdT   _sellOrderId;
+    TokenT     _token;
+    PriceT     _price;
+    QuantityT  _quantity;
+};
+
 /**
  * @brief Message types for market data
  */
@@ -143,4 +157,84 @@ enum MessageType : char {
     RECOVERY = 'R'
 };
 
+/**
+ * @brief RecoveryResponse::_requestStatus values
+ */
+enum RecoveryStatus : char {
+    RECOVERY_DATA     = 'D',   // Carries one recovered packet
+    RECOVERY_COMPLETE = 'C',   // Requested range done, missing packets are unavailable
+    RECOVERY_REJECTED = 'J'    // Request refused or the connection failed
+};
+
+/**
+ * @brief Order side as carried in OrderMessage::_orderType
+ */
+enum Side : char {
+    BUY  = 'B',
+    SELL = 'S'
+};
+
+/**
+ * @brief One changed level of the published depth
+ */
+struct DepthDelta {
+    uint8_t   _level    = 0;     // 0 is the best level
+    Side      _side     = BUY;
+    PriceT    _price    = 0;
+    QuantityT _quantity = 0;     // 0 when the level is now empty
+};
+
+/**
+ * @brief Top-of-book changes produced by a single book event
+ */
+struct DepthUpdate {
+    TokenT     _token       = 0;
+    uint64_t   _version     = 0;     // Per-token, increments on every published change
+    uint32_t   _changedMask = 0;     // Bit i: bid level i, bit LADDER_DEPTH + i: ask level i
+    uint8_t    _count       = 0;
+    DepthDelta _deltas[2 * LADDER_DEPTH];
+};
+
+/**
+ * @brief Microstructure figures LadderBuilder keeps current with its book
+ *
+ * Book figures are zero while either side is empty; trade figures cover
+ * every trade since the builder started (or was restored).
+ */
+struct BookAnalytics {
+    double   _mid           = 0;
+    double   _microprice    = 0;   // Best prices weighted by the opposite side's quantity
+    double   _imbalance     = 0;   // (bid - ask) / (bid + ask) quantity over the published levels, -1 to 1
+    PriceT   _spreadTicks   = 0;
+    uint64_t _tradeVolume   = 0;
+    double   _tradeNotional = 0;   // Sum of price * quantity
+    double   _vwap          = 0;
+};
+
+/**
+ * @brief Price level storage backend used by LadderBuilder
+ */
+enum BookType : char {
+    FLAT_MAP   = 'F',   // Sorted flat_map per side
+    TICK_ARRAY = 'T'    // Dense array indexed by (price - anchor) / tick
+};
+
+/**
+ * @brief Received datagram queued between the socket and book building threads
+ */
+struct alignas(64) PacketSlot {
+    uint64_t _rxNanos = 0;     // Receive timestamp
+    uint32_t _size    = 0;
+    char     _data[MAX_PACKET_SIZE];
+};
+
+/**
+ * @brief One received datagram, borrowed from a socket callback or a queue slot
+ */
+struct PacketView {
+    const char* _data    = nullptr;
+    size_t      _size    = 0;
+    uint64_t    _rxNanos = 0;   // Kernel receive time (CLOCK_REALTIME), user space if unavailable
+};
+
 } // namespace MarketDataProvider
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace MarketDataProvider {
+
+class LadderBuilder;
+
+/**
+ * @brief Constant time token to LadderBuilder lookup
+ *
+ * Built once from the subscribed token list. When the token range is compact
+ * the index is a flat array offset by the smallest token, otherwise it falls
+ * back to a power-of-two open addressing table with fibonacci hashing.
+ */
+class TokenIndex final {
+public:
+    /**
+     * @brief Rebuild the index from (token, builder) pairs
+     */
+    void build(const std::vector<std::pair<TokenT, LadderBuilder*>>& entries_);
+
+    /**
+     * @brief Find the builder for a token, nullptr if not subscribed
+     */
+    LadderBuilder* find(TokenT token_) const noexcept {
+        if (_dense) {
+            const uint32_t slot = static_cast<uint32_t>(token_) - static_cast<uint32_t>(_minToken);
+            return slot < _denseSlots.size() ? _denseSlots[slot] : nullptr;
+        }
+
+        if (_slots.empty()) {
+            return nullptr;
+        }
+
+        for (uint32_t slot = hash(token_);; slot = (slot + 1) & _mask) {
+            const Slot& entry = _slots[slot];
+            if (entry._builder == nullptr || entry._token == token_) {
+                return entry._builder;
+            }
+        }
+    }
+
+    size_t size() const noexcept { return _size; }
+    bool   isDense() const noexcept { return _dense; }
+
+private:
+    struct Slot {
+        TokenT         _token   = 0;
+        LadderBuilder* _builder = nullptr;
+    };
+
+    bool                        _dense    = true;
+    TokenT                      _minToken = 0;
+    uint32_t                    _mask     = 0;
+    uint32_t                    _shift    = 0;
+    size_t                      _size     = 0;
+    std::vector<LadderBuilder*> _denseSlots;
+    std::vector<Slot>           _slots;
+
+    uint32_t hash(TokenT token_) const noexcept {
+        return (static_cast<uint32_t>(token_) * 0x9E3779B1u) >> _shift;
+    }
+};
+
+} // namespace MarketDataProvider
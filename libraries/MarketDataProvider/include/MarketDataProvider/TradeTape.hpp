@@ -0,0 +1,104 @@
+#pragma once
+
+#include "MarketDataProvider/Structure.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief One trade as kept on the tape
+ */
+struct TradePrint {
+    TimestampT _timestamp = 0;     // TradeMessage::_timeStamp
+    PriceT     _price     = 0;
+    QuantityT  _quantity  = 0;
+    Side       _aggressor = BUY;
+};
+
+/**
+ * @brief Figures over the most recent trades of a token
+ */
+struct TapeSummary {
+    uint64_t   _trades           = 0;
+    uint64_t   _buyVolume        = 0;   // Bought by aggressors
+    uint64_t   _sellVolume       = 0;   // Sold by aggressors
+    double     _realizedVariance = 0;   // Sum of squared log returns between consecutive prints
+    TimestampT _firstNanos       = 0;
+    TimestampT _lastNanos        = 0;
+};
+
+/**
+ * @brief Fixed ring of the latest trades per token, one writer and any number of readers
+ *
+ * The stream thread records every trade; other threads copy prints out
+ * without locks or allocation. Each entry is a seqlock stamped with the
+ * trade number it holds: the writer makes the stamp odd, copies the print
+ * and publishes 2 * (number + 1). A reader copies an entry and keeps it
+ * only if the stamp was that value before and after, so an entry the
+ * writer lapped while it was being read is dropped rather than returned
+ * torn. Readers that fall more than a capacity behind lose the oldest
+ * trades, never the writer's time.
+ */
+class TradeTape {
+public:
+    TradeTape(const std::vector<TokenT>& tokens_, size_t capacity_ = TRADE_TAPE_CAPACITY);
+
+    TradeTape(const TradeTape&) = delete;
+    TradeTape& operator=(const TradeTape&) = delete;
+
+    /**
+     * @brief Writer: append trade_ to its token's ring, ignored for unknown tokens
+     */
+    void record(const TradeMessage& trade_, Side aggressor_);
+
+    /**
+     * @brief Copy up to count_ of the newest prints, oldest first; returns how many
+     */
+    size_t read(TokenT token_, TradePrint* prints_, size_t count_) const;
+
+    /**
+     * @brief Summarize up to count_ of the newest prints, false for unknown tokens
+     */
+    bool summarize(TokenT token_, size_t count_, TapeSummary& summary_) const;
+
+    /**
+     * @brief Trades recorded for token_ since the tape was created
+     */
+    uint64_t getTradeCount(TokenT token_) const;
+
+    size_t getCapacity() const { return _capacity; }
+    const std::vector<TokenT>& getTokens() const { return _tokens; }
+
+private:
+    // Two to a cache line, never straddling one
+    struct alignas(32) Entry {
+        std::atomic<uint64_t> _stamp{0};   // Odd while written, 2 * (trade number + 1) once published
+        TradePrint            _print;
+    };
+
+    // Written once per trade, kept off the entries' cache lines
+    struct alignas(64) Head {
+        std::atomic<uint64_t> _count{0};
+    };
+
+    size_t                             _capacity;   // Power of two
+    size_t                             _mask;
+    std::vector<TokenT>                _tokens;
+    std::unordered_map<TokenT, size_t> _tapeIndex;
+    std::unique_ptr<Head[]>            _heads;
+    std::unique_ptr<Entry[]>           _entries;    // _capacity per token
+
+    const Entry* ring(size_t tape_) const { return _entries.get() + tape_ * _capacity; }
+
+    /**
+     * @brief Call function_(print) for each intact print among the newest count_, oldest first
+     */
+    template <typename FunctionT>
+    size_t forEachRecent(size_t tape_, size_t count_, FunctionT&& function_) const;
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Cheap monotonic ticks for latency stamps, converted to nanoseconds after the fact
+ *
+ * On x86 a tick is one cycle of the invariant TSC, read with rdtsc and
+ * calibrated once against the steady clock; elsewhere ticks are steady clock
+ * nanoseconds. Calibration runs on first use and takes about 10 ms, so call
+ * calibrate() at startup rather than from a hot path.
+ *
+ * The measured rate is only good to a few ppm and the wall clock is slewed by
+ * NTP, so ticks are never mapped to wall time through a process-wide anchor.
+ * Take a fresh anchor() per packet and extrapolate only within it.
+ */
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Measure the tick rate if not done yet
+     */
+    static void calibrate() { calibration(); }
+
+    static double nanosPerTick() { return calibration()._nanosPerTick; }
+
+    /**
+     * @brief Length of an interval of ticks_ in nanoseconds
+     */
+    static uint64_t toNanos(uint64_t ticks_) {
+        return static_cast<uint64_t>(static_cast<double>(ticks_) * calibration()._nanosPerTick);
+    }
+
+    /**
+     * @brief A tick reading paired with the wall clock at the same instant
+     */
+    struct WallAnchor {
+        uint64_t _ticks     = 0;
+        uint64_t _wallNanos = 0;
+    };
+
+    /**
+     * @brief Read CLOCK_REALTIME (vdso) and the ticks around it, comparable with socket receive timestamps
+     */
+    static WallAnchor anchor() {
+        WallAnchor result;
+        const uint64_t before = now();
+        result._wallNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        result._ticks = before + (now() - before) / 2;
+        return result;
+    }
+
+    /**
+     * @brief Wall clock time of a tick reading taken shortly after anchor_
+     */
+    static uint64_t toWallNanos(uint64_t ticks_, const WallAnchor& anchor_) {
+        const auto offset = static_cast<double>(static_cast<int64_t>(ticks_ - anchor_._ticks));
+        return anchor_._wallNanos + static_cast<uint64_t>(static_cast<int64_t>(offset * nanosPerTick()));
+    }
+
+private:
+    struct Calibration {
+        double _nanosPerTick = 1.0;
+    };
+
+    static const Calibration& calibration();
+};
+
+} // namespace MarketDataProvider
@@ -0,0 +1,393 @@
+#include "MarketDataProvider/BarAggregator.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace MarketDataProvider {
+
+namespace {
+
+template <typename FieldT>
+void appendColumn(std::vector<char>& buffer_, const Bar* bars_, size_t count_, FieldT Bar::*field_) {
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + count_ * sizeof(FieldT));
+    for (size_t i = 0; i < count_; ++i) {
+        std::memcpy(buffer_.data() + offset, &(bars_[i].*field_), sizeof(FieldT));
+        offset += sizeof(FieldT);
+    }
+}
+
+template <typename FieldT>
+bool readColumn(const std::vector<char>& buffer_, size_t& offset_, Bar* bars_, size_t count_, FieldT Bar::*field_) {
+    if (offset_ + count_ * sizeof(FieldT) > buffer_.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < count_; ++i) {
+        std::memcpy(&(bars_[i].*field_), buffer_.data() + offset_, sizeof(FieldT));
+        offset_ += sizeof(FieldT);
+    }
+    return true;
+}
+
+// Every Bar field, in the order the columns are stored
+template <typename VisitorT>
+bool forEachColumn(VisitorT&& visit_) {
+    return visit_(&Bar::_token) && visit_(&Bar::_spec) && visit_(&Bar::_startNanos) && visit_(&Bar::_endNanos) &&
+           visit_(&Bar::_open) && visit_(&Bar::_high) && visit_(&Bar::_low) && visit_(&Bar::_close) &&
+           visit_(&Bar::_volume) && visit_(&Bar::_trades) && visit_(&Bar::_notional);
+}
+
+} // namespace
+
+bool parseBarSpec(const std::string& text_, BarSpec& spec_) {
+    const auto count = [](const std::string& digits_, uint64_t& value_) {
+        if (digits_.empty() || digits_.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        value_ = std::stoull(digits_);
+        return value_ > 0;
+    };
+
+    if (text_.starts_with("volume:")) {
+        spec_._type = VOLUME_BAR;
+        return count(text_.substr(7), spec_._size);
+    }
+    if (text_.starts_with("ticks:")) {
+        spec_._type = TICK_BAR;
+        return count(text_.substr(6), spec_._size);
+    }
+
+    const size_t unitStart = text_.find_first_not_of("0123456789");
+    if (unitStart == std::string::npos) {
+        return false;
+    }
+    const std::string unit = text_.substr(unitStart);
+    uint64_t nanosPerUnit = 0;
+    if (unit == "ms") {
+        nanosPerUnit = 1'000'000ULL;
+    } else if (unit == "s") {
+        nanosPerUnit = 1'000'000'000ULL;
+    } else if (unit == "m") {
+        nanosPerUnit = 60'000'000'000ULL;
+    } else if (unit == "h") {
+        nanosPerUnit = 3'600'000'000'000ULL;
+    } else {
+        return false;
+    }
+    uint64_t units = 0;
+    if (!count(text_.substr(0, unitStart), units)) {
+        return false;
+    }
+    spec_._type = TIME_BAR;
+    spec_._size = units * nanosPerUnit;
+    return true;
+}
+
+BarFile::~BarFile() {
+    close();
+}
+
+bool BarFile::open(const std::string& path_) {
+    close();
+    _file = std::fopen(path_.c_str(), "ab");
+    if (!_file) {
+        spdlog::error("Cannot open bar file {}: {}", path_, std::strerror(errno));
+        return false;
+    }
+    if (std::ftell(_file) == 0) {
+        const BarFileHeader header{BAR_FILE_MAGIC, BAR_FILE_VERSION};
+        std::fwrite(&header, sizeof(header), 1, _file);
+        std::fflush(_file);
+    }
+    if (!_blocks) {
+        _blocks = std::make_unique<Bar[]>(BlockCount * BlockSize);
+    }
+    _filling = 0;
+    _handed  = 0;
+    _drained = 0;
+    _running = true;
+    _writer  = std::thread([this] { writerLoop(); });
+    spdlog::info("Bars writing to {}", path_);
+    return true;
+}
+
+void BarFile::append(const Bar& bar_) {
+    if (!_file) {
+        return;
+    }
+    if (_filling == BlockSize && !handOver(false)) {
+        _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    _blocks[(_handed % BlockCount) * BlockSize + _filling] = bar_;
+    ++_filling;
+}
+
+void BarFile::flush() {
+    if (_file && _filling > 0) {
+        handOver(false);
+    }
+}
+
+void BarFile::close() {
+    if (!_file) {
+        return;
+    }
+    if (_filling > 0) {
+        handOver(true);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_all();
+    _writer.join();
+
+    std::fclose(_file);
+    _file = nullptr;
+    if (const uint64_t dropped = getBarsDropped()) {
+        spdlog::warn("Bar file dropped {} bars, the writer fell behind", dropped);
+    }
+}
+
+bool BarFile::handOver(bool wait_) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // The block after this one must not still be queued for writing
+    const auto free = [this] { return _handed + 1 - _drained < BlockCount; };
+    if (!free()) {
+        if (!wait_) {
+            return false;
+        }
+        _condition.wait(lock, free);
+    }
+    _counts[_handed % BlockCount] = _filling;
+    ++_handed;
+    _filling = 0;
+    lock.unlock();
+    _condition.notify_all();
+    return true;
+}
+
+void BarFile::writerLoop() {
+    std::vector<char> buffer;
+    buffer.reserve(sizeof(uint32_t) + BlockSize * sizeof(Bar));
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _condition.wait(lock, [this] { return !_running || _drained != _handed; });
+
+        while (_drained != _handed) {
+            const size_t block = _drained % BlockCount;
+            lock.unlock();
+            writeBlock(_blocks.get() + block * BlockSize, _counts[block], buffer);
+            lock.lock();
+            ++_drained;
+            _condition.notify_all();
+        }
+
+        if (!_running) {
+            return;
+        }
+    }
+}
+
+void BarFile::writeBlock(const Bar* bars_, size_t count_, std::vector<char>& buffer_) {
+    const auto count = static_cast<uint32_t>(count_);
+    buffer_.resize(sizeof(count));
+    std::memcpy(buffer_.data(), &count, sizeof(count));
+    forEachColumn([&](auto field_) {
+        appendColumn(buffer_, bars_, count_, field_);
+        return true;
+    });
+
+    if (std::fwrite(buffer_.data(), 1, buffer_.size(), _file) != buffer_.size()) {
+        spdlog::error("Bar file write failed: {}", std::strerror(errno));
+    }
+    std::fflush(_file);
+    _written.store(_written.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+bool BarFile::read(const std::string& path_, std::vector<Bar>& bars_) {
+    std::ifstream file(path_, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    BarFileHeader header;
+    if (buffer.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (header._magic != BAR_FILE_MAGIC || header._version != BAR_FILE_VERSION) {
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset < buffer.size()) {
+        uint32_t count = 0;
+        if (offset + sizeof(count) > buffer.size()) {
+            return false;
+        }
+        std::memcpy(&count, buffer.data() + offset, sizeof(count));
+        offset += sizeof(count);
+
+        const size_t first = bars_.size();
+        bars_.resize(first + count);
+        const bool complete = forEachColumn([&](auto field_) {
+            return readColumn(buffer, offset, bars_.data() + first, count, field_);
+        });
+        if (!complete) {
+            bars_.resize(first);
+            return false;
+        }
+    }
+    return true;
+}
+
+BarAggregator::BarAggregator(const std::vector<TokenT>& tokens_, std::vector<BarSpec> specs_, size_t history_)
+    : _specs(std::move(specs_)), _history(std::max<size_t>(history_, 1)) {
+    for (const auto token : tokens_) {
+        if (_tokenIndex.emplace(token, _series.size()).second) {
+            _series.resize(_series.size() + _specs.size());
+        }
+    }
+    _ring.resize(_series.size() * _history);
+}
+
+void BarAggregator::onTrade(const TradeMessage& trade_) {
+    const auto found = _tokenIndex.find(trade_._token);
+    if (found == _tokenIndex.end()) {
+        return;
+    }
+
+    const auto quantity = static_cast<uint64_t>(std::max(trade_._quantity, 0));
+    for (size_t spec = 0; spec < _specs.size(); ++spec) {
+        const size_t index = found->second + spec;
+        Series& series = _series[index];
+        const BarSpec& barSpec = _specs[spec];
+
+        if (series._active && barSpec._type == TIME_BAR && trade_._timeStamp >= series._open._endNanos) {
+            closeBar(index);
+        }
+
+        Bar& bar = series._open;
+        if (!series._active) {
+            bar = Bar{};
+            bar._token = trade_._token;
+            bar._spec  = static_cast<uint8_t>(spec);
+            bar._open  = bar._high = bar._low = trade_._price;
+            if (barSpec._type == TIME_BAR) {
+                bar._startNanos = trade_._timeStamp - trade_._timeStamp % barSpec._size;
+                bar._endNanos   = bar._startNanos + barSpec._size;
+                _nextExpiry     = std::min(_nextExpiry, bar._endNanos);
+            } else {
+                bar._startNanos = trade_._timeStamp;
+            }
+            series._active = true;
+        }
+
+        bar._high  = std::max(bar._high, trade_._price);
+        bar._low   = std::min(bar._low, trade_._price);
+        bar._close = trade_._price;
+        bar._volume   += quantity;
+        bar._notional += static_cast<double>(trade_._price) * static_cast<double>(quantity);
+        ++bar._trades;
+        if (barSpec._type != TIME_BAR) {
+            bar._endNanos = trade_._timeStamp;
+        }
+
+        if ((barSpec._type == VOLUME_BAR && bar._volume >= barSpec._size) ||
+            (barSpec._type == TICK_BAR && bar._trades >= barSpec._size)) {
+            closeBar(index);
+        }
+    }
+}
+
+size_t BarAggregator::closeExpired(TimestampT now_) {
+    if (now_ < _nextExpiry) {
+        return 0;
+    }
+
+    // Bars closed by trades since leave _nextExpiry early, the scan corrects it
+    size_t closed = 0;
+    _nextExpiry = UINT64_MAX;
+    for (size_t index = 0; index < _series.size(); ++index) {
+        const Series& series = _series[index];
+        if (!series._active || _specs[index % _specs.size()]._type != TIME_BAR) {
+            continue;
+        }
+        if (now_ >= series._open._endNanos) {
+            closeBar(index);
+            ++closed;
+        } else {
+            _nextExpiry = std::min(_nextExpiry, series._open._endNanos);
+        }
+    }
+    return closed;
+}
+
+void BarAggregator::subscribe(CallbackT callback_) {
+    _subscribers.push_back(std::move(callback_));
+}
+
+void BarAggregator::setBarFile(BarFile* file_) {
+    _file = file_;
+}
+
+size_t BarAggregator::getBars(TokenT token_, size_t spec_, std::vector<Bar>& bars_, size_t count_) const {
+    size_t index = 0;
+    const Series* series = findSeries(token_, spec_, index);
+    if (!series) {
+        return 0;
+    }
+
+    const uint64_t available = std::min<uint64_t>(series->_closed, _history);
+    const uint64_t wanted = std::min<uint64_t>(available, count_);
+    const Bar* ring = _ring.data() + index * _history;
+    for (uint64_t closed = series->_closed - wanted; closed < series->_closed; ++closed) {
+        bars_.push_back(ring[closed % _history]);
+    }
+    return static_cast<size_t>(wanted);
+}
+
+bool BarAggregator::getOpenBar(TokenT token_, size_t spec_, Bar& bar_) const {
+    size_t index = 0;
+    const Series* series = findSeries(token_, spec_, index);
+    if (!series || !series->_active) {
+        return false;
+    }
+    bar_ = series->_open;
+    return true;
+}
+
+const BarAggregator::Series* BarAggregator::findSeries(TokenT token_, size_t spec_, size_t& index_) const {
+    const auto found = _tokenIndex.find(token_);
+    if (found == _tokenIndex.end() || spec_ >= _specs.size()) {
+        return nullptr;
+    }
+    index_ = found->second + spec_;
+    return &_series[index_];
+}
+
+void BarAggregator::closeBar(size_t index_) {
+    Series& series = _series[index_];
+    const Bar& bar = series._open;
+    _ring[index_ * _history + series._closed % _history] = bar;
+    ++series._closed;
+    series._active = false;
+
+    for (const auto& subscriber : _subscribers) {
+        subscriber(bar);
+    }
+    if (_file) {
+        _file->append(bar);
+    }
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,275 @@
+#include "MarketDataProvider/Checkpoint.hpp"
+#include "MarketDataProvider/LadderBuilder.hpp"
+#include "MarketDataProvider/StreamManager.hpp"
+#include "FileDetail.hpp"
+#include "SocketDetail.hpp"
+
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <fmt/format.h>
+
+namespace MarketDataProvider {
+
+namespace {
+
+constexpr std::string_view SnapshotSuffix = ".snapshot";
+
+template <typename T>
+void appendRecord(std::vector<char>& buffer_, const T& record_) {
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + sizeof(T));
+    std::memcpy(buffer_.data() + offset, &record_, sizeof(T));
+}
+
+template <typename T>
+T readRecord(const std::vector<char>& buffer_, size_t offset_) {
+    T record;
+    std::memcpy(&record, buffer_.data() + offset_, sizeof(T));
+    return record;
+}
+
+bool writeAll(int fd_, const char* data_, size_t size_) {
+    while (size_ > 0) {
+        const ssize_t written = ::write(fd_, data_, size_);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data_ += written;
+        size_ -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Header, books and orders fit in the file and the checksum matches
+bool verify(const std::vector<char>& snapshot_) {
+    if (snapshot_.size() < sizeof(CheckpointHeader) + sizeof(uint64_t)) {
+        return false;
+    }
+    const size_t end = snapshot_.size() - sizeof(uint64_t);
+    if (fnv1a(snapshot_.data(), end) != readRecord<uint64_t>(snapshot_, end)) {
+        return false;
+    }
+    const auto header = readRecord<CheckpointHeader>(snapshot_, 0);
+    if (header._magic != CHECKPOINT_MAGIC || header._version != CHECKPOINT_VERSION) {
+        return false;
+    }
+
+    size_t offset = sizeof(CheckpointHeader);
+    for (uint32_t book = 0; book < header._books; ++book) {
+        if (offset + sizeof(CheckpointBook) > end) {
+            return false;
+        }
+        const auto orders = readRecord<CheckpointBook>(snapshot_, offset)._orders;
+        offset += sizeof(CheckpointBook) + static_cast<size_t>(orders) * sizeof(CheckpointOrder);
+    }
+    return offset == end;
+}
+
+} // namespace
+
+Checkpoint::Checkpoint(const CheckpointConfig& config_) : _config(config_) {
+    std::error_code error;
+    std::filesystem::create_directories(_config._directory, error);
+    if (error) {
+        spdlog::error("Cannot create checkpoint directory {}: {}", _config._directory, error.message());
+    }
+    const auto existing = listIndexedFiles(_config._directory, _config._prefix, SnapshotSuffix);
+    _nextIndex = existing.empty() ? 0 : existing.back() + 1;
+    _worker = std::thread([this] { workerLoop(); });
+}
+
+Checkpoint::~Checkpoint() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_all();
+    _worker.join();
+}
+
+bool Checkpoint::save(const StreamManager& manager_, const JournalPosition& position_) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_writing) {
+            _skipped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    CheckpointHeader header{};
+    header._magic          = CHECKPOINT_MAGIC;
+    header._version        = CHECKPOINT_VERSION;
+    header._createdNanos   = wallClockNanos();
+    header._session        = _config._session;
+    header._journalSegment = position_._segment;
+    header._journalOffset  = position_._offset;
+    for (short streamId = 0; streamId < MaxStream; ++streamId) {
+        if (manager_.isRecovering(streamId)) {
+            _skipped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        header._expected[streamId] = manager_.getStreamStats(streamId)._expected;
+    }
+
+    _buffer.clear();
+    appendRecord(_buffer, header);
+    manager_.forEachLadderBuilder([this, &header](const LadderBuilder& builder_) {
+        const size_t bookOffset = _buffer.size();
+        const BookAnalytics& analytics = builder_.getAnalytics();
+        CheckpointBook book{builder_.getToken(), builder_.getVersion(), analytics._tradeVolume, analytics._tradeNotional, 0};
+        appendRecord(_buffer, book);
+        builder_.forEachOrder([this, &book](const OrderNode& order_) {
+            appendRecord(_buffer, CheckpointOrder{order_._orderId, order_._price, order_._quantity, order_._side});
+            ++book._orders;
+        });
+        std::memcpy(_buffer.data() + bookOffset, &book, sizeof(book));
+        ++header._books;
+    });
+    std::memcpy(_buffer.data(), &header, sizeof(header));
+    appendRecord(_buffer, fnv1a(_buffer.data(), _buffer.size()));
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending.swap(_buffer);
+        _writing = true;
+    }
+    _condition.notify_all();
+
+    _captureNanos.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+    return true;
+}
+
+bool Checkpoint::restore(StreamManager& manager_, JournalPosition& position_) {
+    const auto indices = listIndexedFiles(_config._directory, _config._prefix, SnapshotSuffix);
+    for (auto index = indices.rbegin(); index != indices.rend(); ++index) {
+        const std::string path = snapshotPath(*index);
+        std::ifstream file(path, std::ios::binary);
+        const std::vector<char> snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!verify(snapshot)) {
+            spdlog::warn("Ignoring invalid snapshot {}", path);
+            continue;
+        }
+
+        const auto header = readRecord<CheckpointHeader>(snapshot, 0);
+        if (header._session != _config._session) {
+            spdlog::info("Ignoring snapshot {} of session {}", path, header._session);
+            continue;
+        }
+        size_t offset = sizeof(CheckpointHeader);
+        uint64_t orders = 0;
+        for (uint32_t bookIndex = 0; bookIndex < header._books; ++bookIndex) {
+            const auto book = readRecord<CheckpointBook>(snapshot, offset);
+            offset += sizeof(CheckpointBook);
+            LadderBuilder* builder = manager_.getLadderBuilder(book._token);
+            if (!builder) {
+                spdlog::warn("Snapshot has token {} which is no longer subscribed", book._token);
+                offset += static_cast<size_t>(book._orders) * sizeof(CheckpointOrder);
+                continue;
+            }
+
+            builder->clear();
+            for (uint32_t i = 0; i < book._orders; ++i, offset += sizeof(CheckpointOrder)) {
+                const auto order = readRecord<CheckpointOrder>(snapshot, offset);
+                builder->restoreOrder(order._orderId, static_cast<Side>(order._side), order._price, order._quantity);
+            }
+            builder->restoreTrades(book._tradeVolume, book._tradeNotional);
+            builder->publishRestored(book._version);
+            orders += book._orders;
+        }
+
+        for (short streamId = 0; streamId < MaxStream; ++streamId) {
+            manager_.resetStream(streamId, header._expected[streamId]);
+        }
+        position_ = JournalPosition{header._journalSegment, header._journalOffset};
+
+        spdlog::info("Restored {} books and {} orders from {} (journal segment {} offset {})",
+                     header._books, orders, path, position_._segment, position_._offset);
+        return true;
+    }
+    return false;
+}
+
+void Checkpoint::flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [this] { return !_writing; });
+}
+
+CheckpointStats Checkpoint::getStats() const {
+    CheckpointStats stats;
+    stats._saved        = _saved.load(std::memory_order_relaxed);
+    stats._skipped      = _skipped.load(std::memory_order_relaxed);
+    stats._failed       = _failed.load(std::memory_order_relaxed);
+    stats._bytes        = _bytes.load(std::memory_order_relaxed);
+    stats._captureNanos = _captureNanos.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Checkpoint::workerLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _condition.wait(lock, [this] { return !_running || _writing; });
+        if (!_writing) {
+            return;
+        }
+
+        std::vector<char> snapshot;
+        snapshot.swap(_pending);
+        lock.unlock();
+        if (write(snapshot, _nextIndex)) {
+            ++_nextIndex;
+            _saved.fetch_add(1, std::memory_order_relaxed);
+            _bytes.store(snapshot.size(), std::memory_order_relaxed);
+        } else {
+            _failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        lock.lock();
+
+        // Hand the storage back for the next save()
+        snapshot.clear();
+        _pending.swap(snapshot);
+        _writing = false;
+        _condition.notify_all();
+    }
+}
+
+bool Checkpoint::write(const std::vector<char>& snapshot_, uint32_t index_) {
+    const std::string path = snapshotPath(index_);
+    const std::string temporary = path + ".tmp";
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Cannot create snapshot {}: {}", temporary, std::strerror(errno));
+        return false;
+    }
+
+    // Only a complete, durable file is ever renamed into place
+    const bool written = writeAll(fd, snapshot_.data(), snapshot_.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!written || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        spdlog::error("Cannot write snapshot {}: {}", path, std::strerror(errno));
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    const auto indices = listIndexedFiles(_config._directory, _config._prefix, SnapshotSuffix);
+    for (size_t i = 0; i + _config._keep < indices.size(); ++i) {
+        ::unlink(snapshotPath(indices[i]).c_str());
+    }
+    spdlog::info("Snapshot {} written ({} bytes)", path, snapshot_.size());
+    return true;
+}
+
+std::string Checkpoint::snapshotPath(uint32_t index_) const {
+    return fmt::format("{}/{}.{:06}{}", _config._directory, _config._prefix, index_, SnapshotSuffix);
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,170 @@
+#include "MarketDataProvider/ConflatingPublisher.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace MarketDataProvider {
+
+namespace {
+
+constexpr uint64_t NeverDelivered = UINT64_MAX;
+
+} // namespace
+
+ConflatingPublisher::ConflatingPublisher(const std::vector<TokenT>& tokens_, size_t logCapacity_)
+    : _tokens(tokens_),
+      _slots(std::make_unique<Slot[]>(tokens_.size())),
+      _log(std::make_unique<LogEntry[]>(std::bit_ceil(std::max<size_t>(logCapacity_, 2)))),
+      _logMask(std::bit_ceil(std::max<size_t>(logCapacity_, 2)) - 1) {
+    for (size_t i = 0; i < _tokens.size(); ++i) {
+        _slotIndex[_tokens[i]] = static_cast<uint32_t>(i);
+        _slots[i]._depth._token = _tokens[i];
+    }
+}
+
+void ConflatingPublisher::onUpdate(const DepthUpdate& update_) {
+    const auto it = _slotIndex.find(update_._token);
+    if (it == _slotIndex.end()) {
+        return;
+    }
+    Slot& slot = _slots[it->second];
+
+    const uint64_t sequence = slot._sequence.load(std::memory_order_relaxed);
+    slot._sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint8_t i = 0; i < update_._count; ++i) {
+        const DepthDelta& delta = update_._deltas[i];
+        Ladder& level = delta._side == BUY ? slot._depth._bid[delta._level] : slot._depth._ask[delta._level];
+        level._price    = delta._price;
+        level._quantity = delta._quantity;
+    }
+    slot._version = update_._version;
+    slot._sequence.store(sequence + 2, std::memory_order_release);
+
+    // One log entry per update, however many subscribers will read it
+    const uint64_t position = _head.fetch_add(1, std::memory_order_relaxed);
+    LogEntry& entry = _log[position & _logMask];
+    entry._slot.store(it->second, std::memory_order_relaxed);
+    entry._stamp.store(position + 1, std::memory_order_release);
+}
+
+std::unique_ptr<ConflatedSubscriber> ConflatingPublisher::subscribe(const std::string& name_,
+                                                                    std::chrono::nanoseconds minInterval_) const {
+    return std::make_unique<ConflatedSubscriber>(*this, name_, minInterval_);
+}
+
+bool ConflatingPublisher::read(TokenT token_, ConflatedDepth& depth_) const {
+    const auto it = _slotIndex.find(token_);
+    if (it == _slotIndex.end()) {
+        return false;
+    }
+    readSlot(it->second, depth_);
+    return true;
+}
+
+void ConflatingPublisher::readSlot(uint32_t slot_, ConflatedDepth& depth_) const {
+    const Slot& slot = _slots[slot_];
+    while (true) {
+        const uint64_t before = slot._sequence.load(std::memory_order_acquire);
+        if (!(before & 1)) {
+            depth_._version = slot._version;
+            depth_._depth   = slot._depth;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot._sequence.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+ConflatedSubscriber::ConflatedSubscriber(const ConflatingPublisher& publisher_, std::string name_,
+                                         std::chrono::nanoseconds minInterval_)
+    : _publisher(publisher_),
+      _name(std::move(name_)),
+      _minInterval(minInterval_),
+      _cursor(publisher_._head.load(std::memory_order_acquire)),
+      _dirty(publisher_._tokens.size(), 0),
+      _lastVersions(publisher_._tokens.size(), NeverDelivered) {
+    _dirtySlots.reserve(publisher_._tokens.size());
+    markAll();
+}
+
+size_t ConflatedSubscriber::poll(const CallbackT& callback_) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < _nextDelivery) {
+        return 0;
+    }
+    collect();
+    if (_dirtySlots.empty()) {
+        return 0;
+    }
+
+    ConflatedDepth depth;
+    for (uint32_t slot : _dirtySlots) {
+        _dirty[slot] = 0;
+        _publisher.readSlot(slot, depth);
+        const uint64_t last = _lastVersions[slot];
+        depth._skipped = last != NeverDelivered && depth._version > last + 1 ? depth._version - last - 1 : 0;
+        _lastVersions[slot] = depth._version;
+        _stats._conflated += depth._skipped;
+        callback_(depth);
+    }
+
+    const size_t delivered = _dirtySlots.size();
+    _dirtySlots.clear();
+    _stats._delivered += delivered;
+    ++_stats._polls;
+    _nextDelivery = now + _minInterval;
+    return delivered;
+}
+
+size_t ConflatedSubscriber::pending() {
+    collect();
+    return _dirtySlots.size();
+}
+
+void ConflatedSubscriber::collect() {
+    const uint64_t head = _publisher._head.load(std::memory_order_acquire);
+    while (_cursor < head) {
+        if (head - _cursor > _publisher._logMask) {
+            break;
+        }
+        const auto& entry = _publisher._log[_cursor & _publisher._logMask];
+        const uint64_t stamp = entry._stamp.load(std::memory_order_acquire);
+        if (stamp < _cursor + 1) {
+            // Claimed but not written yet, pick it up next time
+            return;
+        }
+        const uint32_t slot = entry._slot.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (stamp != _cursor + 1 || entry._stamp.load(std::memory_order_relaxed) != stamp) {
+            break;
+        }
+        if (!_dirty[slot]) {
+            _dirty[slot] = 1;
+            _dirtySlots.push_back(slot);
+        }
+        ++_cursor;
+    }
+    if (_cursor < head) {
+        // Entries were overwritten before this subscriber read them
+        ++_stats._overruns;
+        spdlog::warn("Conflated subscriber {} fell {} updates behind, refreshing every token", _name, head - _cursor);
+        _cursor = head;
+        markAll();
+    }
+}
+
+void ConflatedSubscriber::markAll() {
+    for (uint32_t slot = 0; slot < _dirty.size(); ++slot) {
+        if (!_dirty[slot]) {
+            _dirty[slot] = 1;
+            _dirtySlots.push_back(slot);
+        }
+    }
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief Indices of the files named <prefix_>.<index><suffix_> in directory_, ascending
+ */
+inline std::vector<uint32_t> listIndexedFiles(const std::string& directory_, const std::string& prefix_,
+                                              std::string_view suffix_) {
+    std::vector<uint32_t> indices;
+    std::error_code error;
+    const std::string prefix = prefix_ + ".";
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > prefix.size() + suffix_.size() && name.starts_with(prefix) && name.ends_with(suffix_)) {
+            const std::string index = name.substr(prefix.size(), name.size() - prefix.size() - suffix_.size());
+            if (index.find_first_not_of("0123456789") == std::string::npos) {
+                indices.push_back(static_cast<uint32_t>(std::stoul(index)));
+            }
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+/**
+ * @brief FNV-1a over size_ bytes, continuing from hash_
+ */
+inline uint64_t fnv1a(const void* data_, size_t size_, uint64_t hash_ = 14695981039346656037ull) {
+    const auto* bytes = static_cast<const unsigned char*>(data_);
+    for (size_t i = 0; i < size_; ++i) {
+        hash_ = (hash_ ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash_;
+}
+
+} // namespace MarketDataProvider
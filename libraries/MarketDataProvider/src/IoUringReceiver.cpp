@@ -0,0 +1,311 @@
+#include "IoUringReceiver.hpp"
+#include "SocketDetail.hpp"
+
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+namespace MarketDataProvider {
+
+namespace {
+
+constexpr unsigned SubmissionEntries = 8;
+constexpr uint16_t BufferGroup       = 0;
+
+int ioUringSetup(unsigned entries_, io_uring_params* params_) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries_, params_));
+}
+
+int ioUringEnter(int ringFd_, unsigned submit_, unsigned wait_, unsigned flags_, const void* arg_, size_t argSize_) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, submit_, wait_, flags_, arg_, argSize_));
+}
+
+int ioUringRegister(int ringFd_, unsigned opcode_, const void* arg_, unsigned count_) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd_, opcode_, arg_, count_));
+}
+
+// Ring indices are shared with the kernel: acquire what it produces, release what we produce
+unsigned loadAcquire(unsigned* index_) {
+    return std::atomic_ref<unsigned>(*index_).load(std::memory_order_acquire);
+}
+
+void storeRelease(unsigned* index_, unsigned value_) {
+    std::atomic_ref<unsigned>(*index_).store(value_, std::memory_order_release);
+}
+
+template <typename T>
+T* offset(void* base_, uint32_t offset_) {
+    return reinterpret_cast<T*>(static_cast<char*>(base_) + offset_);
+}
+
+} // namespace
+
+IoUringReceiver::IoUringReceiver(int socket_, const SocketConfig& config_)
+    : _socket(socket_), _config(config_) {
+}
+
+IoUringReceiver::~IoUringReceiver() {
+    // Closing the ring cancels the armed multishot request
+    if (_ringFd >= 0) {
+        ::close(_ringFd);
+    }
+    if (_bufferRing) {
+        ::munmap(_bufferRing, _bufferRingSize);
+    }
+    if (_sqes) {
+        ::munmap(_sqes, _sqesSize);
+    }
+    if (_ring) {
+        ::munmap(_ring, _ringSize);
+    }
+}
+
+bool IoUringReceiver::init() {
+    const unsigned bufferCount = std::bit_ceil(std::clamp(_config._bufferCount, 2u, 32768u));
+
+    io_uring_params params{};
+    params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = bufferCount * 2;
+    _ringFd = ioUringSetup(SubmissionEntries, &params);
+    if (_ringFd < 0 && errno == EINVAL) {
+        params = io_uring_params{};
+        params.flags      = IORING_SETUP_CQSIZE;
+        params.cq_entries = bufferCount * 2;
+        _ringFd = ioUringSetup(SubmissionEntries, &params);
+    }
+    if (_ringFd < 0) {
+        spdlog::warn("io_uring_setup failed: {}", std::strerror(errno));
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        spdlog::warn("io_uring on this kernel lacks SINGLE_MMAP/EXT_ARG");
+        return false;
+    }
+
+    _ringSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                 params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    void* ring = ::mmap(nullptr, _ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        spdlog::warn("io_uring ring mmap failed: {}", std::strerror(errno));
+        return false;
+    }
+    _ring = ring;
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        spdlog::warn("io_uring sqe mmap failed: {}", std::strerror(errno));
+        return false;
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    _sqHead  = offset<unsigned>(_ring, params.sq_off.head);
+    _sqTail  = offset<unsigned>(_ring, params.sq_off.tail);
+    _sqArray = offset<unsigned>(_ring, params.sq_off.array);
+    _sqMask  = *offset<unsigned>(_ring, params.sq_off.ring_mask);
+    _cqHead  = offset<unsigned>(_ring, params.cq_off.head);
+    _cqTail  = offset<unsigned>(_ring, params.cq_off.tail);
+    _cqes    = offset<io_uring_cqe>(_ring, params.cq_off.cqes);
+    _cqMask  = *offset<unsigned>(_ring, params.cq_off.ring_mask);
+
+    // Each buffer holds the recvmsg header, the timestamp control block and the payload
+    _message = msghdr{};
+    _message.msg_controllen = _config._timestamps ? TIMESTAMP_CONTROL_SIZE : 0;
+    _bufferSize = (sizeof(io_uring_recvmsg_out) + _message.msg_controllen + _config._maxPacketSize + 63) & ~size_t{63};
+    _buffers.assign(bufferCount * _bufferSize, 0);
+
+    _bufferRingSize = bufferCount * sizeof(io_uring_buf);
+    void* bufferRing = ::mmap(nullptr, _bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (bufferRing == MAP_FAILED) {
+        spdlog::warn("io_uring buffer ring mmap failed: {}", std::strerror(errno));
+        return false;
+    }
+    _bufferRing = static_cast<io_uring_buf_ring*>(bufferRing);
+    _bufferMask = bufferCount - 1;
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr    = reinterpret_cast<uint64_t>(_bufferRing);
+    registration.ring_entries = bufferCount;
+    registration.bgid         = BufferGroup;
+    if (ioUringRegister(_ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+        spdlog::warn("IORING_REGISTER_PBUF_RING failed: {}", std::strerror(errno));
+        return false;
+    }
+
+    for (unsigned i = 0; i < bufferCount; ++i) {
+        recycle(static_cast<uint16_t>(i));
+    }
+    publishBuffers();
+
+    _views.resize(bufferCount);
+    _bufferIds.resize(bufferCount);
+    if (!probe()) {
+        return false;
+    }
+    spdlog::info("io_uring receiver ready: {} buffers of {} bytes", bufferCount, _bufferSize);
+    return true;
+}
+
+bool IoUringReceiver::probe() {
+    std::vector<char> storage(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op), 0);
+    auto* table = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (ioUringRegister(_ringFd, IORING_REGISTER_PROBE, table, IORING_OP_LAST) != 0 ||
+        table->last_op < IORING_OP_RECVMSG || !(table->ops[IORING_OP_RECVMSG].flags & IO_URING_OP_SUPPORTED)) {
+        spdlog::warn("io_uring on this kernel does not support recvmsg");
+        return false;
+    }
+
+    // The opcode table does not cover multishot (kernel 6.0+): arm once and
+    // see whether the kernel rejects it. Older kernels fail the request with
+    // EINVAL as it is submitted; otherwise it stays armed for run().
+    arm();
+    if (ioUringEnter(_ringFd, 1, 0, 0, nullptr, 0) != 1) {
+        spdlog::warn("io_uring submit failed: {}", std::strerror(errno));
+        return false;
+    }
+    const unsigned head = *_cqHead;
+    if (loadAcquire(_cqTail) != head) {
+        const io_uring_cqe& cqe = _cqes[head & _cqMask];
+        if (cqe.res == -EINVAL) {
+            storeRelease(_cqHead, head + 1);
+            spdlog::warn("io_uring on this kernel does not support multishot recvmsg");
+            return false;
+        }
+    }
+    return true;
+}
+
+void IoUringReceiver::run(const std::atomic<bool>& running_, const DeliverT& deliver_) {
+    while (running_.load(std::memory_order_relaxed)) {
+        if (!_armed) {
+            arm();
+        }
+        if (!wait(_config._pollTimeoutMillis)) {
+            break;
+        }
+
+        uint64_t truncated = 0;
+        const size_t count = reap(truncated);
+        if (count == 0) {
+            continue;
+        }
+
+        deliver_(_views.data(), count, truncated);
+        for (size_t i = 0; i < count; ++i) {
+            recycle(_bufferIds[i]);
+        }
+        publishBuffers();
+    }
+}
+
+void IoUringReceiver::recycle(uint16_t bufferId_) {
+    // Entries start at offset 0, overlapping the tail. io_uring_buf_ring::bufs
+    // cannot be used from C++: the empty struct in __DECLARE_FLEX_ARRAY has
+    // size 1 there, which moves the array to offset 8.
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(_bufferRing)[_bufferTail & _bufferMask];
+    entry.addr = reinterpret_cast<uint64_t>(buffer(bufferId_));
+    entry.len  = static_cast<uint32_t>(_bufferSize);
+    entry.bid  = bufferId_;
+    ++_bufferTail;
+}
+
+void IoUringReceiver::publishBuffers() {
+    std::atomic_ref<uint16_t>(_bufferRing->tail).store(static_cast<uint16_t>(_bufferTail), std::memory_order_release);
+}
+
+void IoUringReceiver::arm() {
+    const unsigned tail = *_sqTail;
+    const unsigned index = tail & _sqMask;
+    io_uring_sqe& sqe = _sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode    = IORING_OP_RECVMSG;
+    sqe.fd        = _socket;
+    sqe.addr      = reinterpret_cast<uint64_t>(&_message);
+    sqe.len       = 1;
+    sqe.ioprio    = IORING_RECV_MULTISHOT;
+    sqe.flags     = IOSQE_BUFFER_SELECT;
+    sqe.buf_group = BufferGroup;
+
+    _sqArray[index] = index;
+    storeRelease(_sqTail, tail + 1);
+    _armed = true;
+}
+
+bool IoUringReceiver::wait(int timeoutMillis_) {
+    __kernel_timespec timeout{};
+    timeout.tv_sec  = timeoutMillis_ / 1000;
+    timeout.tv_nsec = static_cast<long long>(timeoutMillis_ % 1000) * 1'000'000;
+
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts         = reinterpret_cast<uint64_t>(&timeout);
+
+    // Completions already queued need no syscall at all
+    const bool pending = loadAcquire(_cqTail) != *_cqHead;
+    const unsigned submit = *_sqTail - loadAcquire(_sqHead);
+    if (pending && submit == 0) {
+        return true;
+    }
+
+    const int result = ioUringEnter(_ringFd, submit, pending ? 0 : 1,
+                                    IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    if (result < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+        spdlog::error("io_uring_enter failed: {}", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+size_t IoUringReceiver::reap(uint64_t& truncated_) {
+    const uint64_t now = wallClockNanos();
+    unsigned head = *_cqHead;
+    const unsigned tail = loadAcquire(_cqTail);
+    size_t count = 0;
+
+    for (; head != tail && count < _views.size(); ++head) {
+        const io_uring_cqe& cqe = _cqes[head & _cqMask];
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            _armed = false;
+        }
+        if (cqe.res < 0) {
+            if (cqe.res == -ENOBUFS) {
+                _noBuffers.store(_noBuffers.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            } else if (cqe.res != -ECANCELED) {
+                spdlog::warn("io_uring recvmsg failed: {}", std::strerror(-cqe.res));
+            }
+            continue;
+        }
+        if (!(cqe.flags & IORING_CQE_F_BUFFER)) {
+            continue;
+        }
+
+        const auto bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        char* data = buffer(bufferId);
+        const auto* out = reinterpret_cast<const io_uring_recvmsg_out*>(data);
+        char* control = data + sizeof(io_uring_recvmsg_out) + _message.msg_namelen;
+        const char* payload = control + _message.msg_controllen;
+
+        msghdr message{};
+        message.msg_control    = control;
+        message.msg_controllen = out->controllen;
+        if (out->flags & MSG_TRUNC) {
+            ++truncated_;
+        }
+
+        _views[count]     = PacketView{payload, std::min<size_t>(out->payloadlen, _config._maxPacketSize),
+                                       receiveTimestamp(message, now)};
+        _bufferIds[count] = bufferId;
+        ++count;
+    }
+
+    storeRelease(_cqHead, head);
+    return count;
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "MarketDataProvider/NetworkSocket.hpp"
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace MarketDataProvider {
+
+/**
+ * @brief io_uring receive engine behind NetworkSocket's IO_URING backend
+ *
+ * Talks to the kernel through the raw syscalls (no liburing). One multishot
+ * recvmsg stays armed on the socket and the kernel picks a buffer from a
+ * registered provided-buffer ring for every datagram, so under load the
+ * receive thread only enters the kernel to wait for completions. Buffers go
+ * back to the ring after the batch callback returns; if the ring runs dry the
+ * request terminates with ENOBUFS and is re-armed once buffers are returned.
+ */
+class IoUringReceiver {
+public:
+    using DeliverT = std::function<void(const PacketView*, size_t, uint64_t)>;
+
+    IoUringReceiver(int socket_, const SocketConfig& config_);
+    ~IoUringReceiver();
+
+    IoUringReceiver(const IoUringReceiver&) = delete;
+    IoUringReceiver& operator=(const IoUringReceiver&) = delete;
+
+    /**
+     * @brief Create the ring, register the buffers and arm the receive, false if unsupported
+     *
+     * Fails on kernels without multishot recvmsg so the socket falls back to recvmmsg.
+     */
+    bool init();
+
+    /**
+     * @brief Receive until running_ clears; deliver_(packets, count, truncated)
+     */
+    void run(const std::atomic<bool>& running_, const DeliverT& deliver_);
+
+    uint64_t noBuffers() const { return _noBuffers.load(std::memory_order_relaxed); }
+
+private:
+    int          _socket;
+    SocketConfig _config;
+    int          _ringFd = -1;
+
+    // Submission and completion rings shared with the kernel
+    void*         _ring     = nullptr;
+    size_t        _ringSize = 0;
+    io_uring_sqe* _sqes     = nullptr;
+    size_t        _sqesSize = 0;
+    unsigned*     _sqHead   = nullptr;
+    unsigned*     _sqTail   = nullptr;
+    unsigned*     _sqArray  = nullptr;
+    unsigned      _sqMask   = 0;
+    unsigned*     _cqHead   = nullptr;
+    unsigned*     _cqTail   = nullptr;
+    io_uring_cqe* _cqes     = nullptr;
+    unsigned      _cqMask   = 0;
+
+    // Provided buffers
+    io_uring_buf_ring* _bufferRing     = nullptr;
+    size_t             _bufferRingSize = 0;
+    unsigned           _bufferMask     = 0;
+    unsigned           _bufferTail     = 0;
+    size_t             _bufferSize     = 0;
+    std::vector<char>  _buffers;
+
+    msghdr                  _message{};
+    bool                    _armed = false;
+    std::vector<PacketView> _views;
+    std::vector<uint16_t>   _bufferIds;
+    std::atomic<uint64_t>   _noBuffers{0};
+
+    char*  buffer(uint16_t bufferId_) { return _buffers.data() + static_cast<size_t>(bufferId_) * _bufferSize; }
+    bool   probe();
+    void   recycle(uint16_t bufferId_);
+    void   publishBuffers();
+    void   arm();
+    bool   wait(int timeoutMillis_);
+    size_t reap(uint64_t& truncated_);
+};
+
+} // namespace MarketDataProvider
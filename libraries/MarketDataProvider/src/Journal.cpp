@@ -0,0 +1,275 @@
+#include "MarketDataProvider/Journal.hpp"
+#include "FileDetail.hpp"
+#include "SocketDetail.hpp"
+
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+
+namespace MarketDataProvider {
+
+std::string journalSegmentPath(const std::string& directory_, const std::string& prefix_, uint32_t segment_) {
+    return fmt::format("{}/{}.{:06}.journal", directory_, prefix_, segment_);
+}
+
+std::vector<uint32_t> listJournalSegments(const std::string& directory_, const std::string& prefix_,
+                                          uint64_t session_) {
+    auto segments = listIndexedFiles(directory_, prefix_, ".journal");
+    if (session_ != 0) {
+        std::erase_if(segments, [&](uint32_t segment_) {
+            JournalSegmentHeader header{};
+            const int fd = ::open(journalSegmentPath(directory_, prefix_, segment_).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                if (::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                    header = JournalSegmentHeader{};
+                }
+                ::close(fd);
+            }
+            return header._magic != JOURNAL_MAGIC || header._session != session_;
+        });
+    }
+    return segments;
+}
+
+Journal::Journal(const JournalConfig& config_) : _config(config_) {
+    _config._segmentSize = std::max(_config._segmentSize & ~(JOURNAL_RECORD_ALIGNMENT - 1), sizeof(JournalSegmentHeader) + 4096);
+}
+
+Journal::~Journal() {
+    close();
+}
+
+std::string Journal::segmentPath(uint32_t segment_) const {
+    return journalSegmentPath(_config._directory, _config._prefix, segment_);
+}
+
+bool Journal::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(_config._directory, error);
+    if (error) {
+        spdlog::error("Cannot create journal directory {}: {}", _config._directory, error.message());
+        return false;
+    }
+
+    // Never overwrite an earlier run
+    const auto existing = listJournalSegments(_config._directory, _config._prefix);
+    const uint32_t first = existing.empty() ? 0 : existing.back() + 1;
+
+    if (!prepare(_current, first)) {
+        return false;
+    }
+    _offset = sizeof(JournalSegmentHeader);
+    _segments.store(1, std::memory_order_relaxed);
+    _positionSegment.store(first, std::memory_order_relaxed);
+    _positionOffset.store(_offset, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running    = true;
+        _nextWanted = true;
+    }
+    _worker = std::thread([this] { workerLoop(); });
+
+    spdlog::info("Journal writing to {}", segmentPath(first));
+    return true;
+}
+
+void Journal::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_all();
+    _worker.join();
+
+    // The worker has finished everything it was handed
+    _current._used = _offset;
+    finish(_current, false);
+    if (_next._data) {
+        finish(_next, true);
+    }
+    spdlog::info("Journal closed after {} records, {} dropped", _records.load(std::memory_order_relaxed),
+                 _dropped.load(std::memory_order_relaxed));
+}
+
+bool Journal::append(const char* buffer_, size_t size_, short streamId_, uint64_t rxNanos_, uint16_t flags_) {
+    const size_t recordSize = journalRecordSize(size_);
+    if (!isOpen() || recordSize > _config._segmentSize - sizeof(JournalSegmentHeader)) {
+        _rejected.store(_rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    if (_offset + recordSize > _current._size && !rotate()) {
+        _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    char* record = _current._data + _offset;
+    auto* header = reinterpret_cast<JournalRecordHeader*>(record);
+    std::memcpy(record + sizeof(JournalRecordHeader), buffer_, size_);
+    header->_streamId = streamId_;
+    header->_flags    = flags_;
+    header->_rxNanos  = rxNanos_;
+    // Publish the size last so a reader tailing the segment never sees a partial record
+    std::atomic_ref<uint32_t>(header->_size).store(static_cast<uint32_t>(size_), std::memory_order_release);
+
+    _offset += recordSize;
+    _records.store(_records.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _bytes.store(_bytes.load(std::memory_order_relaxed) + size_, std::memory_order_relaxed);
+    _positionOffset.store(_offset, std::memory_order_relaxed);
+    return true;
+}
+
+JournalPosition Journal::getPosition() const {
+    return JournalPosition{_positionSegment.load(std::memory_order_relaxed), _positionOffset.load(std::memory_order_relaxed)};
+}
+
+JournalStats Journal::getStats() const {
+    JournalStats stats;
+    stats._records  = _records.load(std::memory_order_relaxed);
+    stats._bytes    = _bytes.load(std::memory_order_relaxed);
+    stats._segments = _segments.load(std::memory_order_relaxed);
+    stats._stalls   = _stalls.load(std::memory_order_relaxed);
+    stats._rejected = _rejected.load(std::memory_order_relaxed);
+    stats._dropped  = _dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool Journal::rotate() {
+    _current._used = _offset;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_next._data) {
+        // Starved: the worker failed to prepare a segment, do not hold the feed up again until it succeeds
+        if (_starved) {
+            return false;
+        }
+        // The worker is still preparing it, only happens if segments fill faster than they can be allocated
+        _stalls.store(_stalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!_condition.wait_for(lock, _config._rotateTimeout, [this] { return _next._data != nullptr; })) {
+            _starved = true;
+            spdlog::error("Journal segment {} not ready after {}us, dropping packets until it is",
+                          _current._index + 1, _config._rotateTimeout.count());
+            return false;
+        }
+    }
+    if (_starved) {
+        spdlog::warn("Journal resumed after dropping {} packets", _dropped.load(std::memory_order_relaxed));
+        _starved = false;
+    }
+    _retired.push_back(_current);
+    _current    = _next;
+    _next       = Segment{};
+    _nextWanted = true;
+    lock.unlock();
+    _condition.notify_all();
+
+    _offset = sizeof(JournalSegmentHeader);
+    _segments.store(_segments.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _positionSegment.store(_current._index, std::memory_order_relaxed);
+    return true;
+}
+
+void Journal::workerLoop() {
+    uint32_t nextIndex = _current._index + 1;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _condition.wait(lock, [this] { return !_running || _nextWanted || !_retired.empty(); });
+
+        while (!_retired.empty()) {
+            Segment segment = _retired.front();
+            _retired.pop_front();
+            lock.unlock();
+            finish(segment, false);
+            lock.lock();
+        }
+
+        if (!_running) {
+            return;
+        }
+
+        if (_nextWanted) {
+            _nextWanted = false;
+            lock.unlock();
+            Segment segment;
+            const bool prepared = prepare(segment, nextIndex);
+            lock.lock();
+            if (prepared) {
+                _next = segment;
+                ++nextIndex;
+                _condition.notify_all();
+            } else {
+                // Retry rather than leave the writer waiting forever
+                _nextWanted = true;
+                _condition.wait_for(lock, std::chrono::seconds(1));
+            }
+        }
+    }
+}
+
+bool Journal::prepare(Segment& segment_, uint32_t index_) {
+    const std::string path = segmentPath(index_);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Cannot create journal segment {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    // Reserve the blocks up front so writing never hits a full disk or a sparse-file allocation
+    if (const int error = ::posix_fallocate(fd, 0, static_cast<off_t>(_config._segmentSize)); error != 0) {
+        if (::ftruncate(fd, static_cast<off_t>(_config._segmentSize)) != 0) {
+            spdlog::error("Cannot size journal segment {}: {}", path, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        spdlog::warn("posix_fallocate failed for {}: {}", path, std::strerror(error));
+    }
+
+    void* data = ::mmap(nullptr, _config._segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (data == MAP_FAILED) {
+        spdlog::error("Cannot map journal segment {}: {}", path, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    segment_._fd    = fd;
+    segment_._data  = static_cast<char*>(data);
+    segment_._size  = _config._segmentSize;
+    segment_._used  = 0;
+    segment_._index = index_;
+
+    JournalSegmentHeader header{};
+    header._magic        = JOURNAL_MAGIC;
+    header._version      = JOURNAL_VERSION;
+    header._segment      = index_;
+    header._createdNanos = wallClockNanos();
+    header._session      = _config._session;
+    std::memcpy(segment_._data, &header, sizeof(header));
+    return true;
+}
+
+void Journal::finish(Segment& segment_, bool remove_) {
+    ::munmap(segment_._data, segment_._size);
+    if (remove_) {
+        ::unlink(segmentPath(segment_._index).c_str());
+    } else if (::ftruncate(segment_._fd, static_cast<off_t>(segment_._used)) != 0) {
+        spdlog::warn("Cannot trim journal segment {}: {}", segmentPath(segment_._index), std::strerror(errno));
+    }
+    ::close(segment_._fd);
+    segment_ = Segment{};
+}
+
+} // namespace MarketDataProvider
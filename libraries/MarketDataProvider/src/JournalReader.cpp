@@ -0,0 +1,129 @@
+#include "MarketDataProvider/JournalReader.hpp"
+
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace MarketDataProvider {
+
+JournalReader::JournalReader(const std::string& directory_, const std::string& prefix_, uint64_t session_)
+    : _directory(directory_), _prefix(prefix_), _session(session_) {
+}
+
+JournalReader::~JournalReader() {
+    unmap();
+}
+
+bool JournalReader::open() {
+    unmap();
+    _segments = listJournalSegments(_directory, _prefix, _session);
+    if (_segments.empty()) {
+        spdlog::error("No {} journal segments in {}", _prefix, _directory);
+        return false;
+    }
+    _segmentIndex = 0;
+    return map(0);
+}
+
+bool JournalReader::next(JournalRecord& record_) {
+    while (_data) {
+        if (_offset + sizeof(JournalRecordHeader) <= _size) {
+            const auto* header = reinterpret_cast<const JournalRecordHeader*>(_data + _offset);
+            if (header->_size != 0) {
+                const size_t recordSize = journalRecordSize(header->_size);
+                if (_offset + sizeof(JournalRecordHeader) + header->_size <= _size) {
+                    record_._header = header;
+                    record_._data   = _data + _offset + sizeof(JournalRecordHeader);
+                    _offset = std::min(_offset + recordSize, _size);
+                    return true;
+                }
+                spdlog::error("Truncated record at {} in {}", _offset,
+                              journalSegmentPath(_directory, _prefix, _segments[_segmentIndex]));
+            }
+        }
+
+        // End of this segment, skip any that cannot be mapped
+        while (++_segmentIndex < _segments.size() && !map(_segmentIndex)) {
+        }
+        if (_segmentIndex >= _segments.size()) {
+            unmap();
+        }
+    }
+    return false;
+}
+
+bool JournalReader::seek(const JournalPosition& position_) {
+    const auto it = std::lower_bound(_segments.begin(), _segments.end(), position_._segment);
+    if (it == _segments.end() || *it != position_._segment) {
+        spdlog::error("Journal segment {} of {} not found", position_._segment, _prefix);
+        return false;
+    }
+    const auto segmentIndex = static_cast<size_t>(it - _segments.begin());
+    if (!map(segmentIndex)) {
+        return false;
+    }
+    _segmentIndex = segmentIndex;
+    _offset = std::clamp<size_t>(position_._offset, sizeof(JournalSegmentHeader), _size);
+    return true;
+}
+
+JournalPosition JournalReader::getPosition() const {
+    if (!_data) {
+        return JournalPosition{_segments.empty() ? 0 : _segments.back(), _offset};
+    }
+    return JournalPosition{_segments[_segmentIndex], _offset};
+}
+
+bool JournalReader::map(size_t segmentIndex_) {
+    unmap();
+    const std::string path = journalSegmentPath(_directory, _prefix, _segments[segmentIndex_]);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::error("Cannot open journal segment {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat status{};
+    if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(JournalSegmentHeader)) {
+        spdlog::error("Journal segment {} is too small", path);
+        ::close(fd);
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(status.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        spdlog::error("Cannot map journal segment {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    ::madvise(data, size, MADV_SEQUENTIAL);
+
+    JournalSegmentHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header._magic != JOURNAL_MAGIC || header._version != JOURNAL_VERSION) {
+        spdlog::error("{} is not a version {} journal segment", path, JOURNAL_VERSION);
+        ::munmap(data, size);
+        return false;
+    }
+
+    _data   = static_cast<const char*>(data);
+    _size   = size;
+    _offset = sizeof(JournalSegmentHeader);
+    return true;
+}
+
+void JournalReader::unmap() {
+    if (_data) {
+        ::munmap(const_cast<char*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+    }
+}
+
+} // namespace MarketDataProvider
@@ -1,54 +1,61 @@
 #include "MarketDataProvider/LadderBuilder.hpp"
 #include "MarketDataProvider/Structure.hpp"
+#include "MarketDataProvider/TscClock.hpp"
+#include <Profiling/Profiling.hpp>
 #include <spdlog/spdlog.h>
 #include <algorithm>
 
 namespace MarketDataProvider {
 
-LadderBuilder::LadderBuilder(TokenT token_) : _token(token_) {
-    spdlog::debug("LadderBuilder created for token: {}", _token);
+LadderBuilder::LadderBuilder(TokenT token_, BookType bookType_, PriceT tickSize_, size_t orderCapacity_)
+    : _token(token_)
+    , _bidLadder(bookType_, tickSize_)
+    , _askLadder(bookType_, tickSize_)
+    , _orderBook(orderCapacity_)
+    , _tickSize(std::max<PriceT>(tickSize_, 1)) {
+    _depth._token = _token;
+    spdlog::debug("LadderBuilder created for token: {} backend: {} tick: {}",
+                  _token, static_cast<char>(bookType_), tickSize_);
 }
 
 void LadderBuilder::processNewOrder(const OrderMessage& order_) {
+    PROFILE_ZONE();
     if (order_._token != _token) {
         return;
     }
 
-    // Store order for tracking
-    _orderBook[order_._orderId] = MarketDataProvider::Order{order_._price, order_._quantity};
-    
-    // Add to appropriate ladder
-    if (order_._orderType == 'B') { // Buy order
-        addBidOrder(order_._price, order_._quantity);
-    } else if (order_._orderType == 'S') { // Sell order
-        addAskOrder(order_._price, order_._quantity);
+    if ((order_._orderType != BUY && order_._orderType != SELL) || order_._quantity <= 0) {
+        spdlog::warn("Ignoring order {} with side {} quantity {}", order_._orderId, order_._orderType, order_._quantity);
+        return;
+    }
+
+    // A repeated order id replaces the resting order
+    const OrderKeyT key = order_._orderId;
+    if (OrderNode* existing = _orderBook.find(key)) {
+        removeOrder(existing->_side, existing->_price, existing->_quantity);
+        _orderBook.remove(existing);
     }
+
+    // Queue the order and add it to the appropriate ladder
+    const auto side = static_cast<Side>(order_._orderType);
+    _orderBook.add(key, side, order_._price, order_._quantity);
+    addOrder(side, order_._price, order_._quantity);
     
     updateLadder();
 }
 
 void LadderBuilder::processModifyOrder(const OrderMessage& order_) {
+    PROFILE_ZONE();
     if (order_._token != _token) {
         return;
     }
 
-    auto it = _orderBook.find(order_._orderId);
-    if (it != _orderBook.end()) {
-        // Remove old order
-        MarketDataProvider::Order& existingOrder = it->second;
-        if (order_._orderType == 'B') {
-            removeBidOrder(existingOrder._price, existingOrder._quantity);
-        } else {
-            removeAskOrder(existingOrder._price, existingOrder._quantity);
-        }
-        
-        // Add modified order
-        existingOrder._price = order_._price;
-        existingOrder._quantity = order_._quantity;
-        if (order_._orderType == 'B') {
-            addBidOrder(order_._price, order_._quantity);
-        } else {
-            addAskOrder(order_._price, order_._quantity);
+    if (OrderNode* existing = _orderBook.find(order_._orderId)) {
+        // Move the quantity on the side the order was placed on
+        const Side side = existing->_side;
+        removeOrder(side, existing->_price, existing->_quantity);
+        if (_orderBook.replace(existing, order_._price, order_._quantity)) {
+            addOrder(side, order_._price, order_._quantity);
         }
         
         updateLadder();
@@ -56,110 +63,221 @@ void LadderBuilder::processModifyOrder(const OrderMessage& order_) {
 }
 
 void LadderBuilder::processCancelOrder(const OrderMessage& order_) {
+    PROFILE_ZONE();
     if (order_._token != _token) {
         return;
     }
 
-    auto it = _orderBook.find(order_._orderId);
-    if (it != _orderBook.end()) {
-        const MarketDataProvider::Order& orderToCancel = it->second;
-        if (order_._orderType == 'B') {
-            removeBidOrder(orderToCancel._price, orderToCancel._quantity);
-        } else {
-            removeAskOrder(orderToCancel._price, orderToCancel._quantity);
-        }
-        
-        _orderBook.erase(it);
+    if (OrderNode* existing = _orderBook.find(order_._orderId)) {
+        removeOrder(existing->_side, existing->_price, existing->_quantity);
+        _orderBook.remove(existing);
         updateLadder();
     }
 }
 
 void LadderBuilder::processTrade(const TradeMessage& trade_) {
+    PROFILE_ZONE();
     if (trade_._token != _token) {
         return;
     }
 
-    // Remove traded quantities from both buy and sell orders
-    auto buyIt = _orderBook.find(trade_._buyOrderId);
-    auto sellIt = _orderBook.find(trade_._sellOrderId);
-    
-    if (buyIt != _orderBook.end()) {
-        MarketDataProvider::Order& buyOrder = buyIt->second;
-        removeBidOrder(buyOrder._price, trade_._quantity);
-        buyOrder._quantity -= trade_._quantity;
-        if (buyOrder._quantity <= 0) {
-            _orderBook.erase(buyIt);
-        } else {
-            addBidOrder(buyOrder._price, buyOrder._quantity);
-        }
+    if (trade_._quantity <= 0) {
+        spdlog::warn("Ignoring trade of orders {} and {} with quantity {}", trade_._buyOrderId, trade_._sellOrderId,
+                     trade_._quantity);
+        return;
     }
-    
-    if (sellIt != _orderBook.end()) {
-        MarketDataProvider::Order& sellOrder = sellIt->second;
-        removeAskOrder(sellOrder._price, trade_._quantity);
-        sellOrder._quantity -= trade_._quantity;
-        if (sellOrder._quantity <= 0) {
-            _orderBook.erase(sellIt);
-        } else {
-            addAskOrder(sellOrder._price, sellOrder._quantity);
+
+    _analytics._tradeVolume   += static_cast<uint64_t>(trade_._quantity);
+    _analytics._tradeNotional += static_cast<double>(trade_._price) * trade_._quantity;
+    _analytics._vwap           = _analytics._tradeNotional / static_cast<double>(_analytics._tradeVolume);
+
+    // Remove traded quantities from both buy and sell orders
+    for (OrderIdT orderId : {trade_._buyOrderId, trade_._sellOrderId}) {
+        if (OrderNode* order = _orderBook.find(orderId)) {
+            removeOrder(order->_side, order->_price, std::min(trade_._quantity, order->_quantity));
+            _orderBook.reduce(order, trade_._quantity);
         }
     }
     
     updateLadder();
 }
 
+Side LadderBuilder::getAggressor(const TradeMessage& trade_) const {
+    const bool buyResting  = _orderBook.find(trade_._buyOrderId) != nullptr;
+    const bool sellResting = _orderBook.find(trade_._sellOrderId) != nullptr;
+    if (buyResting != sellResting) {
+        return buyResting ? SELL : BUY;
+    }
+    if (buyResting) {
+        return trade_._buyOrderId > trade_._sellOrderId ? BUY : SELL;
+    }
+    if (_analytics._mid > 0) {
+        return trade_._price >= _analytics._mid ? BUY : SELL;
+    }
+    return BUY;
+}
+
 LadderDepth LadderBuilder::getLadderDepth() const {
-    LadderDepth depth;
+    return _depth;
+}
+
+template <int N>
+BasicLadderDepth<N> LadderBuilder::getLadderDepth() const {
+    BasicLadderDepth<N> depth;
     depth._token = _token;
-    
-    // Fill bid ladder (top 5 bids)
-    int bidIndex = 0;
-    for (auto it = _bidLadder.begin(); it != _bidLadder.end() && bidIndex < LADDER_DEPTH; ++it, ++bidIndex) {
-        depth._bid[bidIndex]._price = it->first;
-        depth._bid[bidIndex]._quantity = it->second;
-    }
-    
-    // Fill ask ladder (top 5 asks)
-    int askIndex = 0;
-    for (auto it = _askLadder.begin(); it != _askLadder.end() && askIndex < LADDER_DEPTH; ++it, ++askIndex) {
-        depth._ask[askIndex]._price = it->first;
-        depth._ask[askIndex]._quantity = it->second;
+    if constexpr (N <= LADDER_DEPTH) {
+        std::copy_n(_depth._bid, N, depth._bid);
+        std::copy_n(_depth._ask, N, depth._ask);
+    } else {
+        _bidLadder.fill(depth._bid);
+        _askLadder.fill(depth._ask);
     }
-    
     return depth;
 }
 
-void LadderBuilder::updateLadder() {
-    // This method can be used for additional processing after ladder updates
-    // For now, it's a placeholder for future enhancements
+template BasicLadderDepth<1>  LadderBuilder::getLadderDepth<1>() const;
+template BasicLadderDepth<5>  LadderBuilder::getLadderDepth<5>() const;
+template BasicLadderDepth<10> LadderBuilder::getLadderDepth<10>() const;
+template BasicLadderDepth<20> LadderBuilder::getLadderDepth<20>() const;
+
+void LadderBuilder::subscribe(DepthUpdateCallbackT callback_) {
+    _subscribers.push_back(std::move(callback_));
 }
 
-void LadderBuilder::removeBidOrder(PriceT price_, QuantityT quantity_) {
-    auto it = _bidLadder.find(price_);
-    if (it != _bidLadder.end()) {
-        it->second -= quantity_;
-        if (it->second <= 0) {
-            _bidLadder.erase(it);
+void LadderBuilder::updateLadder() {
+    PROFILE_ZONE();
+    if (!_bidDirty && !_askDirty) {
+        return;
+    }
+
+    DepthUpdate update;
+    update._token = _token;
+
+    auto diff = [&update](const Ladder* current_, Ladder* published_, Side side_, uint32_t shift_, int64_t& quantity_) {
+        for (int level = 0; level < LADDER_DEPTH; ++level) {
+            if (current_[level]._price != published_[level]._price ||
+                current_[level]._quantity != published_[level]._quantity) {
+                quantity_ += current_[level]._quantity - published_[level]._quantity;
+                published_[level] = current_[level];
+                update._changedMask |= 1u << (shift_ + level);
+                update._deltas[update._count++] = DepthDelta{
+                    static_cast<uint8_t>(level), side_, current_[level]._price, current_[level]._quantity};
+            }
         }
+    };
+
+    if (_bidDirty) {
+        Ladder bid[LADDER_DEPTH];
+        _bidLadder.fill(bid);
+        diff(bid, _depth._bid, BUY, 0, _bidQuantity);
+        _bidDirty = false;
+    }
+    if (_askDirty) {
+        Ladder ask[LADDER_DEPTH];
+        _askLadder.fill(ask);
+        diff(ask, _depth._ask, SELL, LADDER_DEPTH, _askQuantity);
+        _askDirty = false;
+    }
+
+    if (update._changedMask == 0) {
+        return;
+    }
+
+    updateAnalytics();
+    _changedMask = update._changedMask;
+    update._version = ++_version;
+    if (_updateStamp) {
+        *_updateStamp = TscClock::now();
+    }
+    for (const auto& subscriber : _subscribers) {
+        subscriber(update);
     }
 }
 
-void LadderBuilder::removeAskOrder(PriceT price_, QuantityT quantity_) {
-    auto it = _askLadder.find(price_);
-    if (it != _askLadder.end()) {
-        it->second -= quantity_;
-        if (it->second <= 0) {
-            _askLadder.erase(it);
-        }
+void LadderBuilder::updateAnalytics() {
+    const Ladder& bid = _depth._bid[0];
+    const Ladder& ask = _depth._ask[0];
+    if (bid._quantity <= 0 || ask._quantity <= 0) {
+        _analytics._mid = _analytics._microprice = _analytics._imbalance = 0;
+        _analytics._spreadTicks = 0;
+        return;
+    }
+
+    _analytics._mid         = (static_cast<double>(bid._price) + ask._price) / 2;
+    _analytics._microprice  = (static_cast<double>(bid._price) * ask._quantity + static_cast<double>(ask._price) * bid._quantity)
+                            / (static_cast<double>(bid._quantity) + ask._quantity);
+    _analytics._imbalance   = static_cast<double>(_bidQuantity - _askQuantity) / static_cast<double>(_bidQuantity + _askQuantity);
+    _analytics._spreadTicks = (ask._price - bid._price) / _tickSize;
+}
+
+void LadderBuilder::clear() {
+    _orderBook.clear();
+    _bidLadder.clear();
+    _askLadder.clear();
+    _depth = LadderDepth{};
+    _depth._token = _token;
+    _analytics   = BookAnalytics{};
+    _bidQuantity = 0;
+    _askQuantity = 0;
+    _version     = 0;
+    _changedMask = 0;
+    _bidDirty    = false;
+    _askDirty    = false;
+}
+
+void LadderBuilder::restoreOrder(OrderKeyT orderId_, Side side_, PriceT price_, QuantityT quantity_) {
+    if ((side_ != BUY && side_ != SELL) || quantity_ <= 0 || !_orderBook.add(orderId_, side_, price_, quantity_)) {
+        spdlog::warn("Token {} skipping restored order {} side {} quantity {}", _token, orderId_, static_cast<char>(side_), quantity_);
+        return;
+    }
+    addOrder(side_, price_, quantity_);
+}
+
+void LadderBuilder::publishRestored(uint64_t version_) {
+    // The restored depth is the one last published as version_
+    _version = version_ > 0 ? version_ - 1 : 0;
+    updateLadder();
+    _version = version_;
+}
+
+void LadderBuilder::restoreTrades(uint64_t volume_, double notional_) {
+    _analytics._tradeVolume   = volume_;
+    _analytics._tradeNotional = notional_;
+    _analytics._vwap          = volume_ ? notional_ / static_cast<double>(volume_) : 0;
+}
+
+QueuePosition LadderBuilder::getQueuePosition(OrderIdT orderId_) const {
+    return _orderBook.getQueuePosition(orderId_);
+}
+
+void LadderBuilder::removeOrder(Side side_, PriceT price_, QuantityT quantity_) {
+    markDirty(side_, price_);
+    if (side_ == BUY) {
+        _bidLadder.remove(price_, quantity_);
+    } else {
+        _askLadder.remove(price_, quantity_);
     }
 }
 
-void LadderBuilder::addBidOrder(PriceT price_, QuantityT quantity_) {
-    _bidLadder[price_] += quantity_;
+void LadderBuilder::addOrder(Side side_, PriceT price_, QuantityT quantity_) {
+    markDirty(side_, price_);
+    if (side_ == BUY) {
+        _bidLadder.add(price_, quantity_);
+    } else {
+        _askLadder.add(price_, quantity_);
+    }
 }
 
-void LadderBuilder::addAskOrder(PriceT price_, QuantityT quantity_) {
-    _askLadder[price_] += quantity_;
+void LadderBuilder::markDirty(Side side_, PriceT price_) {
+    // Only prices inside the published levels (or while they are not all
+    // filled) can change what subscribers see
+    if (side_ == BUY) {
+        const Ladder& last = _depth._bid[LADDER_DEPTH - 1];
+        _bidDirty = _bidDirty || last._quantity == 0 || price_ >= last._price;
+    } else {
+        const Ladder& last = _depth._ask[LADDER_DEPTH - 1];
+        _askDirty = _askDirty || last._quantity == 0 || price_ <= last._price;
+    }
 }
 
 } // namespace MarketDataProvider
\ No newline at end of file
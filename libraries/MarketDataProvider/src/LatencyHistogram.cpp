@@ -0,0 +1,107 @@
+#include "MarketDataProvider/LatencyHistogram.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+
+namespace MarketDataProvider {
+
+size_t LatencyHistogram::bucketIndex(uint64_t nanos_) {
+    if (nanos_ < SubBuckets) {
+        return static_cast<size_t>(nanos_);
+    }
+    nanos_ = std::min(nanos_, (uint64_t{1} << MaxExponent) - 1);
+    const int exponent = std::bit_width(nanos_) - 1;
+    const int shift = exponent - SubBucketBits;
+    return static_cast<size_t>(shift + 1) * SubBuckets + static_cast<size_t>((nanos_ >> shift) - SubBuckets);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket_) {
+    if (bucket_ < SubBuckets) {
+        return bucket_;
+    }
+    const size_t shift = bucket_ / SubBuckets - 1;
+    const uint64_t mantissa = bucket_ % SubBuckets + SubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction_) const {
+    const uint64_t count = getCount();
+    const uint64_t max = getMax();
+    if (count == 0) {
+        return 0;
+    }
+    const auto rank = static_cast<uint64_t>(fraction_ * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < Buckets; ++bucket) {
+        seen += _counts[bucket].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            return std::min(bucketUpperBound(bucket), max);
+        }
+    }
+    return max;
+}
+
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary summary;
+    summary._count = getCount();
+    if (summary._count == 0) {
+        return summary;
+    }
+    summary._meanNanos = static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(summary._count);
+    summary._p50Nanos  = percentile(0.50);
+    summary._p90Nanos  = percentile(0.90);
+    summary._p99Nanos  = percentile(0.99);
+    summary._p999Nanos = percentile(0.999);
+    summary._maxNanos  = getMax();
+    return summary;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other_) {
+    for (size_t bucket = 0; bucket < Buckets; ++bucket) {
+        bump(_counts[bucket], other_._counts[bucket].load(std::memory_order_relaxed));
+    }
+    bump(_count, other_.getCount());
+    bump(_sum, other_._sum.load(std::memory_order_relaxed));
+    _max.store(std::max(getMax(), other_.getMax()), std::memory_order_relaxed);
+}
+
+const char* latencyStageName(LatencyStage stage_) {
+    switch (stage_) {
+        case RECEIVE_STAGE:      return "receive";
+        case DECODE_STAGE:       return "decode";
+        case BOOK_STAGE:         return "book";
+        case PUBLISH_STAGE:      return "publish";
+        case TICK_TO_BOOK_STAGE: return "tick-to-book";
+        default:                 return "unknown";
+    }
+}
+
+LatencyRecorder::LatencyRecorder()
+    : _histograms(std::make_unique<LatencyHistogram[]>(static_cast<size_t>(MaxStream) * LATENCY_STAGES)) {
+}
+
+LatencySummary LatencyRecorder::summarize(LatencyStage stage_) const {
+    LatencyHistogram total;
+    for (short stream = 0; stream < MaxStream; ++stream) {
+        total.merge(getHistogram(stream, stage_));
+    }
+    return total.summarize();
+}
+
+void LatencyRecorder::report(const std::string& label_) const {
+    for (short stream = 0; stream < MaxStream; ++stream) {
+        for (int stage = 0; stage < LATENCY_STAGES; ++stage) {
+            const auto summary = getHistogram(stream, static_cast<LatencyStage>(stage)).summarize();
+            if (summary._count == 0) {
+                continue;
+            }
+            spdlog::info("{} stream {} {}: {} messages, mean {:.0f}ns, p50 {}ns, p90 {}ns, p99 {}ns, p99.9 {}ns, max {}ns",
+                         label_, stream, latencyStageName(static_cast<LatencyStage>(stage)), summary._count,
+                         summary._meanNanos, summary._p50Nanos, summary._p90Nanos, summary._p99Nanos,
+                         summary._p999Nanos, summary._maxNanos);
+        }
+    }
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,71 @@
+#include "MarketDataProvider/LineArbitrator.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+
+namespace MarketDataProvider {
+
+LineArbitrator::LineArbitrator(size_t window_)
+    : _window(std::bit_ceil(std::max<size_t>(window_, 2)))
+    , _mask(_window - 1) {
+}
+
+bool LineArbitrator::accept(size_t line_, const char* buffer_, size_t size_, uint64_t rxNanos_) {
+    if (line_ >= LineCount) {
+        spdlog::error("Invalid feed line: {}", line_);
+        return false;
+    }
+    if (size_ < sizeof(StreamHeader)) {
+        return true;
+    }
+
+    const auto* header = reinterpret_cast<const StreamHeader*>(buffer_);
+    if (header->_streamId < 0 || header->_streamId >= MaxStream) {
+        return true;
+    }
+
+    LineStats& line = _lines[line_];
+    ++line._packets;
+
+    StreamWindow& stream = _streams[header->_streamId];
+    if (stream._entries.empty()) {
+        stream._entries.resize(_window);
+    }
+
+    const int sequence = header->_sequence;
+    Entry& entry = stream._entries[static_cast<uint32_t>(sequence) & _mask];
+    if (entry._sequence == sequence) {
+        ++line._duplicates;
+        if (entry._line != line_) {
+            // Receive times come from the same clock; a copy that was
+            // stamped earlier but dequeued later counts as no lead
+            const uint64_t lead = rxNanos_ > entry._rxNanos ? rxNanos_ - entry._rxNanos : 0;
+            LineStats& winner = _lines[entry._line];
+            ++winner._leadSamples;
+            winner._leadNanos += lead;
+            winner._maxLeadNanos = std::max(winner._maxLeadNanos, lead);
+        }
+        return false;
+    }
+
+    // Its slot has been reused, so whether it was seen cannot be told. The
+    // stream is that far ahead already and StreamManager would drop it too.
+    if (static_cast<int64_t>(stream._highest) - sequence >= static_cast<int64_t>(_window)) {
+        ++line._stale;
+        return false;
+    }
+
+    entry._sequence = sequence;
+    entry._line     = static_cast<uint32_t>(line_);
+    entry._rxNanos  = rxNanos_;
+    stream._highest = std::max(stream._highest, sequence);
+    ++line._won;
+    return true;
+}
+
+LineStats LineArbitrator::getLineStats(size_t line_) const {
+    return line_ < LineCount ? _lines[line_] : LineStats{};
+}
+
+} // namespace MarketDataProvider
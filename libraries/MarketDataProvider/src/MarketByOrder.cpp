@@ -0,0 +1,163 @@
+#include "MarketDataProvider/MarketByOrder.hpp"
+
+#include <algorithm>
+
+namespace MarketDataProvider {
+
+MarketByOrderBook::MarketByOrderBook(size_t orderCapacity_)
+    : _nodes(orderCapacity_)
+    , _levels(std::max<size_t>(orderCapacity_ / 4, 64))
+    , _orders(orderCapacity_)
+    , _levelIndex(std::max<size_t>(orderCapacity_ / 4, 64)) {
+}
+
+OrderNode* MarketByOrderBook::find(OrderKeyT orderId_) {
+    const uint32_t* index = _orders.find(orderId_);
+    return index ? &_nodes[*index] : nullptr;
+}
+
+const OrderNode* MarketByOrderBook::find(OrderKeyT orderId_) const {
+    const uint32_t* index = _orders.find(orderId_);
+    return index ? &_nodes[*index] : nullptr;
+}
+
+OrderNode* MarketByOrderBook::add(OrderKeyT orderId_, Side side_, PriceT price_, QuantityT quantity_) {
+    if (_orders.find(orderId_)) {
+        return nullptr;
+    }
+
+    const uint32_t nodeIndex = _nodes.allocate();
+    OrderNode& node = _nodes[nodeIndex];
+    node._orderId  = orderId_;
+    node._price    = price_;
+    node._quantity = quantity_;
+    node._side     = side_;
+
+    _orders.insert(orderId_, nodeIndex);
+    pushBack(findOrCreateLevel(side_, price_), nodeIndex);
+    return &_nodes[nodeIndex];
+}
+
+void MarketByOrderBook::remove(OrderNode* order_) {
+    const uint32_t nodeIndex = *_orders.find(order_->_orderId);
+    _orders.erase(order_->_orderId);
+    unlink(nodeIndex);
+    _nodes.release(nodeIndex);
+}
+
+bool MarketByOrderBook::reduce(OrderNode* order_, QuantityT quantity_) {
+    if (quantity_ <= 0) {
+        return true;
+    }
+    const QuantityT reduceBy = std::min(quantity_, order_->_quantity);
+    if (reduceBy >= order_->_quantity) {
+        remove(order_);
+        return false;
+    }
+
+    order_->_quantity -= reduceBy;
+    _levels[order_->_level]._quantity -= reduceBy;
+    return true;
+}
+
+OrderNode* MarketByOrderBook::replace(OrderNode* order_, PriceT price_, QuantityT quantity_) {
+    if (price_ == order_->_price && quantity_ <= order_->_quantity) {
+        if (quantity_ < order_->_quantity) {
+            reduce(order_, order_->_quantity - quantity_);
+        }
+        return quantity_ > 0 ? order_ : nullptr;
+    }
+
+    // Loses time priority: requeue at the back of the (possibly new) level
+    const OrderKeyT orderId = order_->_orderId;
+    const Side side = order_->_side;
+    remove(order_);
+    return quantity_ > 0 ? add(orderId, side, price_, quantity_) : nullptr;
+}
+
+QueuePosition MarketByOrderBook::getQueuePosition(OrderKeyT orderId_) const {
+    QueuePosition position;
+    const uint32_t* nodeIndex = _orders.find(orderId_);
+    if (!nodeIndex) {
+        return position;
+    }
+
+    const OrderNode& node = _nodes[*nodeIndex];
+    const PriceLevel& level = _levels[node._level];
+    position._found         = true;
+    position._levelOrders   = level._orders;
+    position._levelQuantity = level._quantity;
+
+    for (uint32_t index = node._prev; index != NullIndex; index = _nodes[index]._prev) {
+        ++position._ordersAhead;
+        position._quantityAhead += _nodes[index]._quantity;
+    }
+    return position;
+}
+
+const PriceLevel* MarketByOrderBook::getLevel(Side side_, PriceT price_) const {
+    const uint32_t* levelIndex = _levelIndex.find(levelKey(side_, price_));
+    return levelIndex ? &_levels[*levelIndex] : nullptr;
+}
+
+void MarketByOrderBook::clear() {
+    _nodes.clear();
+    _levels.clear();
+    _orders.clear();
+    _levelIndex.clear();
+}
+
+uint32_t MarketByOrderBook::findOrCreateLevel(Side side_, PriceT price_) {
+    const OrderKeyT key = levelKey(side_, price_);
+    if (const uint32_t* levelIndex = _levelIndex.find(key)) {
+        return *levelIndex;
+    }
+
+    const uint32_t levelIndex = _levels.allocate();
+    _levels[levelIndex] = PriceLevel{price_, 0, 0, NullIndex, NullIndex, side_};
+    _levelIndex.insert(key, levelIndex);
+    return levelIndex;
+}
+
+void MarketByOrderBook::pushBack(uint32_t levelIndex_, uint32_t nodeIndex_) {
+    PriceLevel& level = _levels[levelIndex_];
+    OrderNode& node = _nodes[nodeIndex_];
+
+    node._level = levelIndex_;
+    node._prev  = level._tail;
+    node._next  = NullIndex;
+    if (level._tail != NullIndex) {
+        _nodes[level._tail]._next = nodeIndex_;
+    } else {
+        level._head = nodeIndex_;
+    }
+    level._tail = nodeIndex_;
+    ++level._orders;
+    level._quantity += node._quantity;
+}
+
+void MarketByOrderBook::unlink(uint32_t nodeIndex_) {
+    OrderNode& node = _nodes[nodeIndex_];
+    PriceLevel& level = _levels[node._level];
+
+    if (node._prev != NullIndex) {
+        _nodes[node._prev]._next = node._next;
+    } else {
+        level._head = node._next;
+    }
+    if (node._next != NullIndex) {
+        _nodes[node._next]._prev = node._prev;
+    } else {
+        level._tail = node._prev;
+    }
+
+    --level._orders;
+    level._quantity -= node._quantity;
+    if (level._orders == 0) {
+        _levelIndex.erase(levelKey(level._side, level._price));
+        _levels.release(node._level);
+    }
+    node._level = NullIndex;
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,416 @@
+#include "MarketDataProvider/NetworkSocket.hpp"
+#include "SocketDetail.hpp"
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+#include "IoUringReceiver.hpp"
+#endif
+
+#include <spdlog/spdlog.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace MarketDataProvider {
+
+namespace {
+
+template <typename ValueT>
+bool setOption(int fd_, int level_, int name_, ValueT value_, const char* label_) {
+    if (::setsockopt(fd_, level_, name_, &value_, sizeof(value_)) != 0) {
+        spdlog::warn("setsockopt({}) failed: {}", label_, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+class NetworkSocket::Impl {
+public:
+    Impl(const std::string& host_, int port_, const SocketConfig& config_)
+        : _host(host_), _port(port_), _config(config_) {
+    }
+
+    ~Impl() {
+        stopReceiving();
+        disconnect();
+    }
+
+    bool connect() {
+        if (_fd >= 0) {
+            return true;
+        }
+
+        std::memset(&_group, 0, sizeof(_group));
+        _group.sin_family = AF_INET;
+        _group.sin_port   = htons(static_cast<uint16_t>(_port));
+        if (::inet_pton(AF_INET, _host.c_str(), &_group.sin_addr) != 1) {
+            spdlog::error("Invalid IPv4 address: {}", _host);
+            return false;
+        }
+        _multicast = IN_MULTICAST(ntohl(_group.sin_addr.s_addr));
+
+        _fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (_fd < 0) {
+            spdlog::error("socket() failed: {}", std::strerror(errno));
+            return false;
+        }
+        ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+
+        setOption(_fd, SOL_SOCKET, SO_REUSEADDR, 1, "SO_REUSEADDR");
+#ifdef SO_REUSEPORT
+        setOption(_fd, SOL_SOCKET, SO_REUSEPORT, 1, "SO_REUSEPORT");
+#endif
+        setReceiveBuffer();
+#ifdef SO_BUSY_POLL
+        if (_config._busyPollMicros > 0) {
+            setOption(_fd, SOL_SOCKET, SO_BUSY_POLL, _config._busyPollMicros, "SO_BUSY_POLL");
+        }
+#endif
+#ifdef SO_TIMESTAMPNS
+        if (_config._timestamps) {
+            setOption(_fd, SOL_SOCKET, SO_TIMESTAMPNS, 1, "SO_TIMESTAMPNS");
+        }
+#endif
+
+        // Binding the group address keeps other groups on the same port out
+        sockaddr_in local = _group;
+        if (!_multicast) {
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+        }
+        if (::bind(_fd, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+            spdlog::error("bind({}:{}) failed: {}", _host, _port, std::strerror(errno));
+            closeSocket();
+            return false;
+        }
+
+        if (_multicast && !joinGroup()) {
+            closeSocket();
+            return false;
+        }
+
+        allocateBuffers();
+        selectBackend();
+        spdlog::info("Listening on {}:{} ({}, {})", _host, _port, _multicast ? "multicast" : "unicast",
+                     _config._backend == IO_URING ? "io_uring" : "recvmmsg");
+        return true;
+    }
+
+    void disconnect() {
+        if (_fd < 0) {
+            return;
+        }
+        stopReceiving();
+        if (_multicast) {
+            ::setsockopt(_fd, IPPROTO_IP, IP_DROP_MEMBERSHIP, &_membership, sizeof(_membership));
+        }
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+        _uring.reset();
+#endif
+        closeSocket();
+    }
+
+    void startReceiving(BatchCallback callback_) {
+        if (_fd < 0) {
+            spdlog::error("startReceiving called before connect");
+            return;
+        }
+        stopReceiving();
+        _running = true;
+        _thread = std::thread([this, callback = std::move(callback_)] { receiveLoop(callback); });
+    }
+
+    void stopReceiving() {
+        _running = false;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    bool send(const char* data_, size_t size_) {
+        if (_fd < 0) {
+            return false;
+        }
+        const ssize_t sent = ::sendto(_fd, data_, size_, 0, reinterpret_cast<const sockaddr*>(&_group), sizeof(_group));
+        if (sent != static_cast<ssize_t>(size_)) {
+            spdlog::warn("sendto failed: {}", std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    SocketStats getStats() const {
+        SocketStats stats;
+        stats._packets   = _packets.load(std::memory_order_relaxed);
+        stats._bytes     = _bytes.load(std::memory_order_relaxed);
+        stats._batches   = _batches.load(std::memory_order_relaxed);
+        stats._truncated = _truncated.load(std::memory_order_relaxed);
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+        stats._noBuffers = _uring ? _uring->noBuffers() : 0;
+#endif
+        return stats;
+    }
+
+    SocketBackend getBackend() const {
+        return _config._backend;
+    }
+
+private:
+    std::string  _host;
+    int          _port;
+    SocketConfig _config;
+    int          _fd = -1;
+    bool         _multicast = false;
+    sockaddr_in  _group{};
+    ip_mreq      _membership{};
+
+    // Receive pool, one slot per datagram in a batch
+    std::vector<char>       _buffers;
+    std::vector<char>       _control;
+    std::vector<iovec>      _iovecs;
+#ifdef __linux__
+    std::vector<mmsghdr>    _messages;
+#else
+    std::vector<msghdr>     _messages;
+#endif
+    std::vector<size_t>     _lengths;
+    std::vector<PacketView> _views;
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+    std::unique_ptr<IoUringReceiver> _uring;
+#endif
+
+    std::thread           _thread;
+    std::atomic<bool>     _running{false};
+    std::atomic<uint64_t> _packets{0};
+    std::atomic<uint64_t> _bytes{0};
+    std::atomic<uint64_t> _batches{0};
+    std::atomic<uint64_t> _truncated{0};
+
+    void closeSocket() {
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    void setReceiveBuffer() {
+        const int requested = _config._receiveBufferSize;
+#ifdef SO_RCVBUFFORCE
+        // Exceeds net.core.rmem_max when we have CAP_NET_ADMIN
+        if (::setsockopt(_fd, SOL_SOCKET, SO_RCVBUFFORCE, &requested, sizeof(requested)) != 0)
+#endif
+        {
+            setOption(_fd, SOL_SOCKET, SO_RCVBUF, requested, "SO_RCVBUF");
+        }
+
+        int actual = 0;
+        socklen_t length = sizeof(actual);
+        ::getsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &actual, &length);
+        if (actual < requested) {
+            spdlog::warn("SO_RCVBUF is {} bytes, requested {} (raise net.core.rmem_max)", actual, requested);
+        }
+    }
+
+    bool joinGroup() {
+        _membership.imr_multiaddr = _group.sin_addr;
+        if (::inet_pton(AF_INET, _config._interface.c_str(), &_membership.imr_interface) != 1) {
+            spdlog::error("Invalid interface address: {}", _config._interface);
+            return false;
+        }
+        if (::setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &_membership, sizeof(_membership)) != 0) {
+            spdlog::error("IP_ADD_MEMBERSHIP {} on {} failed: {}", _host, _config._interface, std::strerror(errno));
+            return false;
+        }
+        setOption(_fd, IPPROTO_IP, IP_MULTICAST_IF, _membership.imr_interface, "IP_MULTICAST_IF");
+        setOption(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, static_cast<unsigned char>(_config._multicastLoop), "IP_MULTICAST_LOOP");
+        return true;
+    }
+
+    void allocateBuffers() {
+        const size_t batch = std::max<size_t>(_config._batchSize, 1);
+        _buffers.assign(batch * _config._maxPacketSize, 0);
+        _control.assign(batch * TIMESTAMP_CONTROL_SIZE, 0);
+        _iovecs.resize(batch);
+        _messages.resize(batch);
+        _lengths.resize(batch);
+        _views.resize(batch);
+
+        for (size_t i = 0; i < batch; ++i) {
+            _iovecs[i].iov_base = _buffers.data() + i * _config._maxPacketSize;
+            _iovecs[i].iov_len  = _config._maxPacketSize;
+        }
+    }
+
+    msghdr& header(size_t index_) {
+#ifdef __linux__
+        return _messages[index_].msg_hdr;
+#else
+        return _messages[index_];
+#endif
+    }
+
+    // recvmmsg rewrites the lengths, so they are reset before every call
+    void resetHeaders() {
+        for (size_t i = 0; i < _messages.size(); ++i) {
+            msghdr& message = header(i);
+            message = msghdr{};
+            message.msg_iov        = &_iovecs[i];
+            message.msg_iovlen     = 1;
+            message.msg_control    = _control.data() + i * TIMESTAMP_CONTROL_SIZE;
+            message.msg_controllen = TIMESTAMP_CONTROL_SIZE;
+        }
+    }
+
+    int receiveBatch() {
+        resetHeaders();
+#ifdef __linux__
+        const int received = ::recvmmsg(_fd, _messages.data(), static_cast<unsigned>(_messages.size()), MSG_DONTWAIT, nullptr);
+        for (int i = 0; i < received; ++i) {
+            _lengths[i] = _messages[i].msg_len;
+        }
+        return received;
+#else
+        // No recvmmsg: drain the same batch one datagram at a time
+        int received = 0;
+        while (received < static_cast<int>(_messages.size())) {
+            const ssize_t size = ::recvmsg(_fd, &_messages[received], MSG_DONTWAIT);
+            if (size < 0) {
+                break;
+            }
+            _lengths[received++] = static_cast<size_t>(size);
+        }
+        return received > 0 ? received : -1;
+#endif
+    }
+
+    void selectBackend() {
+        if (_config._backend != IO_URING) {
+            return;
+        }
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+        _uring = std::make_unique<IoUringReceiver>(_fd, _config);
+        if (_uring->init()) {
+            return;
+        }
+        _uring.reset();
+        spdlog::warn("io_uring backend unavailable, falling back to recvmmsg");
+#else
+        spdlog::warn("Built without io_uring support, falling back to recvmmsg");
+#endif
+        _config._backend = RECVMMSG;
+    }
+
+    void receiveLoop(const BatchCallback& callback_) {
+#ifdef MARKET_DATA_PROVIDER_IO_URING
+        if (_uring) {
+            _uring->run(_running, [this, &callback_](const PacketView* packets_, size_t count_, uint64_t truncated_) {
+                deliver(callback_, packets_, count_, truncated_);
+            });
+            return;
+        }
+#endif
+        pollfd descriptor{_fd, POLLIN, 0};
+        while (_running.load(std::memory_order_relaxed)) {
+            descriptor.revents = 0;
+            const int ready = ::poll(&descriptor, 1, _config._pollTimeoutMillis);
+            if (ready < 0 && errno != EINTR) {
+                spdlog::error("poll failed: {}", std::strerror(errno));
+                break;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+
+            // Drain everything queued before going back to poll
+            while (_running.load(std::memory_order_relaxed)) {
+                const int received = receiveBatch();
+                if (received <= 0) {
+                    if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        spdlog::error("recvmmsg failed: {}", std::strerror(errno));
+                    }
+                    break;
+                }
+                collect(callback_, static_cast<size_t>(received));
+            }
+        }
+    }
+
+    void collect(const BatchCallback& callback_, size_t received_) {
+        const uint64_t now = wallClockNanos();
+        uint64_t truncated = 0;
+        for (size_t i = 0; i < received_; ++i) {
+            if (header(i).msg_flags & MSG_TRUNC) {
+                ++truncated;
+            }
+            _views[i] = PacketView{static_cast<const char*>(_iovecs[i].iov_base),
+                                   std::min(_lengths[i], _config._maxPacketSize),
+                                   receiveTimestamp(header(i), now)};
+        }
+        deliver(callback_, _views.data(), received_, truncated);
+    }
+
+    void deliver(const BatchCallback& callback_, const PacketView* packets_, size_t received_, uint64_t truncated_) {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < received_; ++i) {
+            bytes += packets_[i]._size;
+        }
+
+        _packets.store(_packets.load(std::memory_order_relaxed) + received_, std::memory_order_relaxed);
+        _bytes.store(_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        _batches.store(_batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (truncated_) {
+            _truncated.store(_truncated.load(std::memory_order_relaxed) + truncated_, std::memory_order_relaxed);
+        }
+
+        callback_(packets_, received_);
+    }
+};
+
+NetworkSocket::NetworkSocket(const std::string& host_, int port_, const SocketConfig& config_)
+    : _impl(std::make_unique<Impl>(host_, port_, config_)) {
+}
+
+NetworkSocket::~NetworkSocket() = default;
+
+bool NetworkSocket::connect() {
+    return _impl->connect();
+}
+
+void NetworkSocket::disconnect() {
+    _impl->disconnect();
+}
+
+void NetworkSocket::startReceiving(DataCallback callback_) {
+    _impl->startReceiving([callback = std::move(callback_)](const PacketView* packets_, size_t count_) {
+        for (size_t i = 0; i < count_; ++i) {
+            callback(packets_[i]._data, packets_[i]._size);
+        }
+    });
+}
+
+void NetworkSocket::startReceivingBatch(BatchCallback callback_) {
+    _impl->startReceiving(std::move(callback_));
+}
+
+void NetworkSocket::stopReceiving() {
+    _impl->stopReceiving();
+}
+
+bool NetworkSocket::send(const char* data_, size_t size_) {
+    return _impl->send(data_, size_);
+}
+
+SocketStats NetworkSocket::getStats() const {
+    return _impl->getStats();
+}
+
+SocketBackend NetworkSocket::getBackend() const {
+    return _impl->getBackend();
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,375 @@
+#include "MarketDataProvider/Recovery.hpp"
+#include "MarketDataProvider/SpscRingBuffer.hpp"
+#include "SocketDetail.hpp"
+
+#include <spdlog/spdlog.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace MarketDataProvider {
+
+namespace {
+
+constexpr size_t MaxQueuedRequests = 64;
+constexpr size_t EventCapacity     = 1024;
+constexpr int    SocketTimeoutSecs = 2;
+
+bool validStream(short streamId_) {
+    return streamId_ >= 0 && streamId_ < MaxStream;
+}
+
+} // namespace
+
+class Recovery::Impl {
+public:
+    Impl(const std::string& host_, int port_)
+        : _host(host_), _port(port_), _events(EventCapacity) {
+        _worker = std::thread([this] { workerLoop(); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _condition.notify_all();
+        // Unblock a worker waiting on the server
+        const int fd = _fd.load();
+        if (fd >= 0) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        _worker.join();
+        closeConnection();
+    }
+
+    bool requestRecovery(short streamId_, int startSeq_, int endSeq_) {
+        if (!validStream(streamId_) || startSeq_ <= 0 || endSeq_ < startSeq_) {
+            spdlog::error("Invalid recovery request: stream {} [{}, {}]", streamId_, startSeq_, endSeq_);
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_requests.size() >= MaxQueuedRequests) {
+                spdlog::warn("Recovery queue full, dropping request for stream {} [{}, {}]", streamId_, startSeq_, endSeq_);
+                return false;
+            }
+            _requests.push_back(RecoveryRequest{RECOVERY, streamId_, startSeq_, endSeq_});
+        }
+        _outstanding[streamId_].fetch_add(1, std::memory_order_relaxed);
+        _stats._requests.fetch_add(1, std::memory_order_relaxed);
+        _condition.notify_one();
+
+        spdlog::info("Requested recovery for stream {} [{}, {}]", streamId_, startSeq_, endSeq_);
+        return true;
+    }
+
+    void processRecoveryResponse(const RecoveryResponse& response_) {
+        switch (response_._requestStatus) {
+            case RECOVERY_DATA:
+                _stats._packets.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case RECOVERY_COMPLETE:
+                _stats._completed.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case RECOVERY_REJECTED:
+                _stats._rejected.fetch_add(1, std::memory_order_relaxed);
+                spdlog::warn("Recovery rejected for stream {}", response_._streamId);
+                break;
+            default:
+                spdlog::error("Unknown recovery status: {}", response_._requestStatus);
+                return;
+        }
+        if (validStream(response_._streamId)) {
+            _outstanding[response_._streamId].fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    int getOutstanding(short streamId_) const {
+        return validStream(streamId_) ? _outstanding[streamId_].load(std::memory_order_relaxed) : 0;
+    }
+
+    size_t pollEvents(const EventCallbackT& callback_, size_t max_) {
+        return _events.popBatch(callback_, max_);
+    }
+
+    void setNotify(NotifyCallbackT notify_) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _notify = std::move(notify_);
+    }
+
+    RecoveryStats getStats() const {
+        RecoveryStats stats;
+        stats._requests  = _stats._requests.load(std::memory_order_relaxed);
+        stats._packets   = _stats._packets.load(std::memory_order_relaxed);
+        stats._completed = _stats._completed.load(std::memory_order_relaxed);
+        stats._rejected  = _stats._rejected.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct AtomicStats {
+        std::atomic<uint64_t> _requests{0};
+        std::atomic<uint64_t> _packets{0};
+        std::atomic<uint64_t> _completed{0};
+        std::atomic<uint64_t> _rejected{0};
+    };
+
+    std::string                    _host;
+    int                            _port;
+    SpscRingBuffer<RecoveryEvent>  _events;
+    std::atomic<int>               _outstanding[MaxStream] = {};
+    AtomicStats                    _stats;
+    std::atomic<int>               _fd{-1};
+
+    std::mutex                     _mutex;
+    std::condition_variable        _condition;
+    std::deque<RecoveryRequest>    _requests;
+    NotifyCallbackT                _notify;
+    bool                           _running = true;
+    std::thread                    _worker;
+
+    void workerLoop() {
+        while (true) {
+            RecoveryRequest request;
+            NotifyCallbackT notify;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this] { return !_running || !_requests.empty(); });
+                if (!_running) {
+                    return;
+                }
+                request = _requests.front();
+                _requests.pop_front();
+                notify = _notify;
+            }
+
+            serve(request);
+            if (notify) {
+                notify();
+            }
+        }
+    }
+
+    void serve(const RecoveryRequest& request_) {
+        if (!connectServer() || !sendAll(&request_, sizeof(request_))) {
+            closeConnection();
+            finish(request_, RECOVERY_REJECTED);
+            return;
+        }
+
+        while (isRunning()) {
+            RecoveryEvent* event = claimEvent();
+            if (!event) {
+                return;
+            }
+            RecoveryResponse response;
+            if (!receiveAll(&response, sizeof(response))) {
+                spdlog::error("Recovery connection lost for stream {}", request_._streamId);
+                closeConnection();
+                finish(request_, RECOVERY_REJECTED);
+                return;
+            }
+
+            const int payload = response._msgLen - static_cast<int>(sizeof(RecoveryResponse));
+            if (response._requestStatus != RECOVERY_DATA) {
+                // Skip the whole payload, however long, so the next frame starts on its header
+                if (payload < 0 || !discard(static_cast<size_t>(payload))) {
+                    spdlog::error("Malformed recovery frame of {} bytes for stream {}", response._msgLen, request_._streamId);
+                    closeConnection();
+                }
+                finish(request_, response._requestStatus == RECOVERY_COMPLETE ? RECOVERY_COMPLETE : RECOVERY_REJECTED);
+                return;
+            }
+
+            if (payload < static_cast<int>(sizeof(StreamHeader)) + 1 || payload > static_cast<int>(MAX_PACKET_SIZE)
+                || !receiveAll(event->_packet._data, static_cast<size_t>(payload))) {
+                spdlog::error("Malformed recovery frame of {} bytes for stream {}", response._msgLen, request_._streamId);
+                closeConnection();
+                finish(request_, RECOVERY_REJECTED);
+                return;
+            }
+
+            processRecoveryResponse(response);
+            event->_streamId        = request_._streamId;
+            event->_startSeq        = request_._startSeqNo;
+            event->_endSeq          = request_._endSeqNo;
+            event->_status          = RECOVERY_DATA;
+            event->_packet._size    = static_cast<uint32_t>(payload);
+            event->_packet._rxNanos = wallClockNanos();
+            _events.publish();
+        }
+    }
+
+    // Completion goes through the same ring so it is seen after the range's data
+    void finish(const RecoveryRequest& request_, RecoveryStatus status_) {
+        processRecoveryResponse(RecoveryResponse{
+            static_cast<short>(sizeof(RecoveryResponse)), request_._streamId, request_._endSeqNo, RECOVERY, status_});
+
+        RecoveryEvent* event = claimEvent();
+        if (!event) {
+            return;
+        }
+        event->_streamId     = request_._streamId;
+        event->_startSeq     = request_._startSeqNo;
+        event->_endSeq       = request_._endSeqNo;
+        event->_status       = status_;
+        event->_packet._size = 0;
+        _events.publish();
+    }
+
+    // Waits for the stream thread to make room rather than losing results
+    RecoveryEvent* claimEvent() {
+        RecoveryEvent* event = _events.claim();
+        while (!event && isRunning()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            event = _events.claim();
+        }
+        return event;
+    }
+
+    bool isRunning() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _running;
+    }
+
+    bool connectServer() {
+        if (_fd.load() >= 0) {
+            return true;
+        }
+
+        addrinfo hints{};
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        const std::string port = std::to_string(_port);
+        if (const int error = ::getaddrinfo(_host.c_str(), port.c_str(), &hints, &addresses); error != 0) {
+            spdlog::error("Cannot resolve recovery server {}: {}", _host, ::gai_strerror(error));
+            return false;
+        }
+
+        for (addrinfo* address = addresses; address; address = address->ai_next) {
+            const int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            timeval timeout{SocketTimeoutSecs, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            const int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+                _fd = fd;
+                break;
+            }
+            ::close(fd);
+        }
+        ::freeaddrinfo(addresses);
+
+        if (_fd.load() < 0) {
+            spdlog::error("Cannot connect to recovery server {}:{}: {}", _host, _port, std::strerror(errno));
+            return false;
+        }
+        spdlog::info("Connected to recovery server {}:{}", _host, _port);
+        return true;
+    }
+
+    void closeConnection() {
+        const int fd = _fd.exchange(-1);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool sendAll(const void* data_, size_t size_) {
+        const char* data = static_cast<const char*>(data_);
+        while (size_ > 0) {
+            const ssize_t sent = ::send(_fd.load(), data, size_, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                spdlog::error("Recovery send failed: {}", std::strerror(errno));
+                return false;
+            }
+            data += sent;
+            size_ -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool receiveAll(void* data_, size_t size_) {
+        char* data = static_cast<char*>(data_);
+        while (size_ > 0) {
+            const ssize_t received = ::recv(_fd.load(), data, size_, 0);
+            if (received <= 0) {
+                if (received < 0 && errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += received;
+            size_ -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    bool discard(size_t size_) {
+        char buffer[MAX_PACKET_SIZE];
+        while (size_ > 0) {
+            const size_t chunk = std::min(size_, sizeof(buffer));
+            if (!receiveAll(buffer, chunk)) {
+                return false;
+            }
+            size_ -= chunk;
+        }
+        return true;
+    }
+};
+
+Recovery::Recovery(const std::string& host_, int port_)
+    : _impl(std::make_unique<Impl>(host_, port_)) {
+}
+
+Recovery::~Recovery() = default;
+
+bool Recovery::requestRecovery(short streamId_, int startSeq_, int endSeq_) {
+    return _impl->requestRecovery(streamId_, startSeq_, endSeq_);
+}
+
+void Recovery::processRecoveryResponse(const RecoveryResponse& response_) {
+    _impl->processRecoveryResponse(response_);
+}
+
+bool Recovery::isRecoveryNeeded(short streamId_, int expectedSeq_, int receivedSeq_) {
+    return validStream(streamId_) && receivedSeq_ > expectedSeq_;
+}
+
+int Recovery::getOutstanding(short streamId_) const {
+    return _impl->getOutstanding(streamId_);
+}
+
+size_t Recovery::pollEvents(const EventCallbackT& callback_, size_t max_) {
+    return _impl->pollEvents(callback_, max_);
+}
+
+void Recovery::setNotify(NotifyCallbackT notify_) {
+    _impl->setNotify(std::move(notify_));
+}
+
+RecoveryStats Recovery::getStats() const {
+    return _impl->getStats();
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,131 @@
+#include "MarketDataProvider/ReplayDriver.hpp"
+#include "MarketDataProvider/JournalReader.hpp"
+#include "MarketDataProvider/LadderBuilder.hpp"
+#include "MarketDataProvider/StreamManager.hpp"
+#include "FileDetail.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace MarketDataProvider {
+
+namespace {
+
+using ClockT = std::chrono::steady_clock;
+
+// Nanosecond buckets up to ~65us, everything slower shares the last one
+constexpr size_t LatencyBuckets = 65536;
+
+uint64_t nanosSince(ClockT::time_point start_) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ClockT::now() - start_).count());
+}
+
+uint64_t percentile(const std::vector<uint64_t>& histogram_, uint64_t count_, double fraction_, uint64_t max_) {
+    const auto rank = static_cast<uint64_t>(fraction_ * static_cast<double>(count_));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < histogram_.size(); ++bucket) {
+        seen += histogram_[bucket];
+        if (seen > rank) {
+            return bucket + 1 == histogram_.size() ? max_ : bucket;
+        }
+    }
+    return max_;
+}
+
+// Messages framed in a packet, counted the way StreamManager walks them
+uint64_t countMessages(const char* data_, size_t size_) {
+    uint64_t messages = 0;
+    for (size_t offset = 0; size_ - offset >= sizeof(StreamHeader) + 1;) {
+        const size_t length = static_cast<size_t>(reinterpret_cast<const StreamHeader*>(data_ + offset)->_len);
+        if (length < sizeof(StreamHeader) + 1 || length > size_ - offset) {
+            break;
+        }
+        ++messages;
+        offset += length;
+    }
+    return messages;
+}
+
+// Sleep most of the way to target_, spin the rest
+void waitUntil(ClockT::time_point target_) {
+    constexpr auto SpinWindow = std::chrono::microseconds(200);
+    auto now = ClockT::now();
+    if (target_ - now > SpinWindow) {
+        std::this_thread::sleep_for(target_ - now - SpinWindow);
+    }
+    while (ClockT::now() < target_) {
+    }
+}
+
+} // namespace
+
+ReplayDriver::ReplayDriver(StreamManager& manager_, const ReplayConfig& config_)
+    : _manager(manager_), _config(config_) {
+}
+
+ReplayStats ReplayDriver::run(JournalReader& reader_) {
+    ReplayStats stats;
+    std::vector<uint64_t> histogram(_config._measureLatency ? LatencyBuckets : 0);
+
+    const ClockT::time_point start = ClockT::now();
+    uint64_t firstRxNanos = 0;
+    JournalRecord record;
+    while (reader_.next(record)) {
+        const JournalRecordHeader& header = *record._header;
+        if (!_config._includeRecovered && (header._flags & JOURNAL_RECOVERED)) {
+            continue;
+        }
+
+        if (_config._speed > 0.0 && header._rxNanos) {
+            if (!firstRxNanos) {
+                firstRxNanos = header._rxNanos;
+            }
+            const auto offset = static_cast<double>(header._rxNanos - std::min(header._rxNanos, firstRxNanos)) / _config._speed;
+            waitUntil(start + std::chrono::nanoseconds(static_cast<int64_t>(offset)));
+        }
+
+        if (_config._measureLatency) {
+            const ClockT::time_point before = ClockT::now();
+            _manager.process(record._data, header._size, header._rxNanos);
+            const uint64_t nanos = nanosSince(before);
+            ++histogram[std::min<uint64_t>(nanos, LatencyBuckets - 1)];
+            stats._maxNanos = std::max(stats._maxNanos, nanos);
+        } else {
+            _manager.process(record._data, header._size, header._rxNanos);
+        }
+
+        ++stats._packets;
+        stats._messages += countMessages(record._data, header._size);
+        stats._bytes += header._size;
+    }
+
+    stats._elapsedNanos = nanosSince(start);
+    if (stats._elapsedNanos) {
+        stats._messagesPerSecond = static_cast<double>(stats._messages) * 1e9 / static_cast<double>(stats._elapsedNanos);
+    }
+    if (_config._measureLatency && stats._packets) {
+        stats._p50Nanos  = percentile(histogram, stats._packets, 0.50, stats._maxNanos);
+        stats._p90Nanos  = percentile(histogram, stats._packets, 0.90, stats._maxNanos);
+        stats._p99Nanos  = percentile(histogram, stats._packets, 0.99, stats._maxNanos);
+        stats._p999Nanos = percentile(histogram, stats._packets, 0.999, stats._maxNanos);
+    }
+    return stats;
+}
+
+std::vector<LadderChecksum> ReplayDriver::checksums(const StreamManager& manager_, const std::vector<TokenT>& tokens_) {
+    std::vector<LadderChecksum> result;
+    result.reserve(tokens_.size());
+    for (TokenT token : tokens_) {
+        if (const LadderBuilder* builder = manager_.getLadderBuilder(token)) {
+            result.push_back(LadderChecksum{token, checksum(builder->getLadderDepth())});
+        }
+    }
+    return result;
+}
+
+uint64_t ReplayDriver::checksum(const LadderDepth& depth_) {
+    return fnv1a(&depth_, sizeof(depth_));
+}
+
+} // namespace MarketDataProvider
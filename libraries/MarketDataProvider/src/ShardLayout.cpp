@@ -0,0 +1,40 @@
+#include "MarketDataProvider/ShardLayout.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <unordered_map>
+
+namespace MarketDataProvider {
+
+bool planShards(size_t streamCount_, size_t workerCount_, const std::map<size_t, std::vector<TokenT>>& streamTokens_,
+                ShardLayout& layout_) {
+    workerCount_ = std::clamp<size_t>(workerCount_, 1, std::max<size_t>(streamCount_, 1));
+    layout_ = ShardLayout{};
+    layout_._workerStreams.resize(workerCount_);
+    layout_._workerTokens.resize(workerCount_);
+    for (size_t stream = 0; stream < streamCount_; ++stream) {
+        layout_._streamWorkers.push_back(stream % workerCount_);
+        layout_._workerStreams[stream % workerCount_].push_back(stream);
+    }
+
+    std::unordered_map<TokenT, size_t> tokenWorkers;
+    for (const auto& [stream, tokens] : streamTokens_) {
+        if (stream >= streamCount_) {
+            spdlog::error("Tokens listed for stream {}, only {} streams are configured", stream, streamCount_);
+            return false;
+        }
+        const size_t worker = layout_._streamWorkers[stream];
+        for (const TokenT token : tokens) {
+            const auto [owner, inserted] = tokenWorkers.emplace(token, worker);
+            if (inserted) {
+                layout_._workerTokens[worker].push_back(token);
+            } else if (owner->second != worker) {
+                spdlog::error("Token {} is carried by streams of workers {} and {}", token, owner->second, worker);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,207 @@
+#include "MarketDataProvider/SharedDepthStore.hpp"
+#include "MarketDataProvider/LadderBuilder.hpp"
+#include "SocketDetail.hpp"
+
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace MarketDataProvider {
+
+SharedDepthStore::SharedDepthStore(const std::string& name_)
+    : _name(name_.empty() || name_.front() != '/' ? "/" + name_ : name_) {
+}
+
+SharedDepthStore::~SharedDepthStore() {
+    close();
+}
+
+bool SharedDepthStore::create(const std::vector<TokenT>& tokens_) {
+    close();
+
+    // Readers still mapping an old region keep it until they detach
+    ::shm_unlink(_name.c_str());
+    const int fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        spdlog::error("Cannot create shared depth {}: {}", _name, std::strerror(errno));
+        return false;
+    }
+
+    const size_t size = sizeof(SharedDepthHeader) + tokens_.size() * sizeof(SharedDepthSlot);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        spdlog::error("Cannot size shared depth {}: {}", _name, std::strerror(errno));
+        ::close(fd);
+        ::shm_unlink(_name.c_str());
+        return false;
+    }
+    const bool mapped = map(fd, size, true);
+    ::close(fd);
+    if (!mapped) {
+        ::shm_unlink(_name.c_str());
+        return false;
+    }
+    _writer = true;
+
+    for (size_t i = 0; i < tokens_.size(); ++i) {
+        SharedDepthSlot* slot = new (&_slots[i]) SharedDepthSlot();
+        slot->_token = tokens_[i];
+        slot->_data._depth._token = tokens_[i];
+        _tokens.push_back(tokens_[i]);
+        _slotIndex[tokens_[i]] = static_cast<int>(i);
+    }
+
+    // The magic goes in last so a reader never accepts a half-built region
+    auto* header = new (_header) SharedDepthHeader();
+    header->_version      = SHARED_DEPTH_VERSION;
+    header->_capacity     = static_cast<uint32_t>(tokens_.size());
+    header->_slotSize     = sizeof(SharedDepthSlot);
+    header->_createdNanos = wallClockNanos();
+    header->_live.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->_magic = SHARED_DEPTH_MAGIC;
+
+    spdlog::info("Shared depth {} created with {} slots ({} bytes)", _name, tokens_.size(), size);
+    return true;
+}
+
+bool SharedDepthStore::attach() {
+    close();
+
+    const int fd = ::shm_open(_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        // Usually the writer is not running yet
+        spdlog::warn("Cannot open shared depth {}: {}", _name, std::strerror(errno));
+        return false;
+    }
+    struct stat status {};
+    const bool mapped = ::fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(SharedDepthHeader)
+        && map(fd, static_cast<size_t>(status.st_size), false);
+    ::close(fd);
+    if (!mapped) {
+        spdlog::error("Cannot map shared depth {}", _name);
+        return false;
+    }
+
+    const uint64_t magic = _header->_magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != SHARED_DEPTH_MAGIC || _header->_version != SHARED_DEPTH_VERSION ||
+        _header->_slotSize != sizeof(SharedDepthSlot) ||
+        sizeof(SharedDepthHeader) + _header->_capacity * sizeof(SharedDepthSlot) > _size) {
+        spdlog::error("Shared depth {} is not ready or has an incompatible layout", _name);
+        close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < _header->_capacity; ++i) {
+        _tokens.push_back(_slots[i]._token);
+        _slotIndex[_slots[i]._token] = static_cast<int>(i);
+    }
+    spdlog::info("Attached to shared depth {} with {} tokens", _name, _tokens.size());
+    return true;
+}
+
+void SharedDepthStore::close() {
+    if (!_header) {
+        return;
+    }
+    if (_writer) {
+        _header->_live.store(0, std::memory_order_release);
+        ::shm_unlink(_name.c_str());
+    }
+    ::munmap(_header, _size);
+    _header = nullptr;
+    _slots  = nullptr;
+    _size   = 0;
+    _writer = false;
+    _tokens.clear();
+    _slotIndex.clear();
+}
+
+bool SharedDepthStore::isLive() const {
+    return _header && _header->_live.load(std::memory_order_acquire) != 0;
+}
+
+void SharedDepthStore::publish(const LadderBuilder& builder_, uint64_t rxNanos_, const TradeMessage* trade_) {
+    const int index = findSlot(builder_.getToken());
+    if (index < 0 || !_writer) {
+        return;
+    }
+    SharedDepthSlot& slot = _slots[index];
+
+    // Make the sequence odd; another writer inside the slot has it odd already
+    uint64_t sequence = slot._sequence.load(std::memory_order_relaxed);
+    while ((sequence & 1) || !slot._sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                                   std::memory_order_relaxed)) {
+        if (sequence & 1) {
+            std::this_thread::yield();
+            sequence = slot._sequence.load(std::memory_order_relaxed);
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SharedDepth& data = slot._data;
+    data._version     = builder_.getVersion();
+    data._updateNanos = rxNanos_ ? rxNanos_ : wallClockNanos();
+    data._depth       = builder_.getLadderDepth();
+    data._analytics   = builder_.getAnalytics();
+    if (trade_) {
+        data._lastTradePrice    = trade_->_price;
+        data._lastTradeQuantity = trade_->_quantity;
+        data._lastTradeNanos    = trade_->_timeStamp;
+        data._tradeCount       += 1;
+        data._tradeVolume      += static_cast<uint64_t>(trade_->_quantity);
+    }
+
+    slot._sequence.store(sequence + 2, std::memory_order_release);
+}
+
+int SharedDepthStore::findSlot(TokenT token_) const {
+    const auto it = _slotIndex.find(token_);
+    return it == _slotIndex.end() ? -1 : it->second;
+}
+
+bool SharedDepthStore::tryRead(int slot_, SharedDepth& depth_) const {
+    const SharedDepthSlot& slot = _slots[slot_];
+    const uint64_t before = slot._sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    std::memcpy(&depth_, &slot._data, sizeof(depth_));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot._sequence.load(std::memory_order_relaxed) == before;
+}
+
+void SharedDepthStore::readSlot(int slot_, SharedDepth& depth_) const {
+    while (!tryRead(slot_, depth_)) {
+        std::this_thread::yield();
+    }
+}
+
+bool SharedDepthStore::read(TokenT token_, SharedDepth& depth_) const {
+    const int slot = findSlot(token_);
+    if (slot < 0) {
+        return false;
+    }
+    readSlot(slot, depth_);
+    return true;
+}
+
+bool SharedDepthStore::map(int fd_, size_t size_, bool writable_) {
+    void* address = ::mmap(nullptr, size_, writable_ ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        spdlog::error("Cannot map shared depth {}: {}", _name, std::strerror(errno));
+        return false;
+    }
+    _header = static_cast<SharedDepthHeader*>(address);
+    _slots  = reinterpret_cast<SharedDepthSlot*>(static_cast<char*>(address) + sizeof(SharedDepthHeader));
+    _size   = size_;
+    return true;
+}
+
+} // namespace MarketDataProvider
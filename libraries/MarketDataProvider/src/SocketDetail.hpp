@@ -0,0 +1,37 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace MarketDataProvider {
+
+// Ancillary data reserved per datagram for the SCM_TIMESTAMPNS message
+constexpr size_t TIMESTAMP_CONTROL_SIZE = CMSG_SPACE(sizeof(timespec));
+
+inline uint64_t wallClockNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Kernel receive time from a datagram's control data, fallback_ if absent
+ */
+inline uint64_t receiveTimestamp(msghdr& message_, uint64_t fallback_) {
+#ifdef SO_TIMESTAMPNS
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message_); cmsg; cmsg = CMSG_NXTHDR(&message_, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec stamp;
+            std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            return static_cast<uint64_t>(stamp.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(stamp.tv_nsec);
+        }
+    }
+#else
+    (void)message_;
+#endif
+    return fallback_;
+}
+
+} // namespace MarketDataProvider
@@ -0,0 +1,61 @@
+#include "MarketDataProvider/TokenIndex.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+
+namespace MarketDataProvider {
+
+namespace {
+
+// A flat array is used while it costs at most this many slots per token,
+// with a floor so that small subscriptions with sparse tokens stay dense.
+constexpr size_t DenseSlotsPerToken = 4;
+constexpr size_t DenseMinimumSlots  = 4096;
+
+} // namespace
+
+void TokenIndex::build(const std::vector<std::pair<TokenT, LadderBuilder*>>& entries_) {
+    _denseSlots.clear();
+    _slots.clear();
+    _size     = entries_.size();
+    _minToken = 0;
+    _dense    = true;
+
+    if (entries_.empty()) {
+        return;
+    }
+
+    const auto [minIt, maxIt] = std::minmax_element(entries_.begin(), entries_.end(),
+        [](const auto& lhs_, const auto& rhs_) { return lhs_.first < rhs_.first; });
+
+    const auto range = static_cast<size_t>(static_cast<int64_t>(maxIt->first) - minIt->first) + 1;
+    _dense = range <= std::max(DenseSlotsPerToken * entries_.size(), DenseMinimumSlots);
+
+    if (_dense) {
+        _minToken = minIt->first;
+        _denseSlots.assign(range, nullptr);
+        for (const auto& [token, builder] : entries_) {
+            _denseSlots[static_cast<uint32_t>(token) - static_cast<uint32_t>(_minToken)] = builder;
+        }
+        spdlog::debug("TokenIndex built dense over range {} for {} tokens", range, _size);
+        return;
+    }
+
+    // Keep the load factor at or below 0.5 so probe sequences stay short
+    const size_t capacity = std::bit_ceil(std::max<size_t>(2 * entries_.size(), 2));
+    _mask  = static_cast<uint32_t>(capacity - 1);
+    _shift = static_cast<uint32_t>(32 - std::countr_zero(capacity));
+    _slots.assign(capacity, Slot{});
+
+    for (const auto& [token, builder] : entries_) {
+        uint32_t slot = hash(token);
+        while (_slots[slot]._builder != nullptr && _slots[slot]._token != token) {
+            slot = (slot + 1) & _mask;
+        }
+        _slots[slot] = Slot{token, builder};
+    }
+    spdlog::debug("TokenIndex built hashed with {} slots for {} tokens", capacity, _size);
+}
+
+} // namespace MarketDataProvider
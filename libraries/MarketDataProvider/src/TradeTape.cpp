@@ -0,0 +1,102 @@
+#include "MarketDataProvider/TradeTape.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace MarketDataProvider {
+
+TradeTape::TradeTape(const std::vector<TokenT>& tokens_, size_t capacity_)
+    : _capacity(std::bit_ceil(std::max<size_t>(capacity_, 2))), _mask(_capacity - 1) {
+    for (const auto token : tokens_) {
+        if (_tapeIndex.emplace(token, _tokens.size()).second) {
+            _tokens.push_back(token);
+        }
+    }
+    _heads = std::make_unique<Head[]>(_tokens.size());
+    _entries = std::make_unique<Entry[]>(_tokens.size() * _capacity);
+}
+
+void TradeTape::record(const TradeMessage& trade_, Side aggressor_) {
+    const auto found = _tapeIndex.find(trade_._token);
+    if (found == _tapeIndex.end()) {
+        return;
+    }
+
+    Head& head = _heads[found->second];
+    const uint64_t number = head._count.load(std::memory_order_relaxed);
+    Entry& entry = _entries[found->second * _capacity + (number & _mask)];
+
+    entry._stamp.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry._print._timestamp = trade_._timeStamp;
+    entry._print._price     = trade_._price;
+    entry._print._quantity  = trade_._quantity;
+    entry._print._aggressor = aggressor_;
+    entry._stamp.store(2 * (number + 1), std::memory_order_release);
+    head._count.store(number + 1, std::memory_order_release);
+}
+
+template <typename FunctionT>
+size_t TradeTape::forEachRecent(size_t tape_, size_t count_, FunctionT&& function_) const {
+    const uint64_t count = _heads[tape_]._count.load(std::memory_order_acquire);
+    const uint64_t wanted = std::min<uint64_t>({count, count_, _capacity});
+    const Entry* entries = ring(tape_);
+
+    size_t visited = 0;
+    for (uint64_t number = count - wanted; number < count; ++number) {
+        const Entry& entry = entries[number & _mask];
+        const uint64_t stamp = 2 * (number + 1);
+        if (entry._stamp.load(std::memory_order_acquire) != stamp) {
+            continue;   // Already overwritten by a newer trade
+        }
+        const TradePrint print = entry._print;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry._stamp.load(std::memory_order_relaxed) != stamp) {
+            continue;
+        }
+        function_(print);
+        ++visited;
+    }
+    return visited;
+}
+
+size_t TradeTape::read(TokenT token_, TradePrint* prints_, size_t count_) const {
+    const auto found = _tapeIndex.find(token_);
+    if (found == _tapeIndex.end()) {
+        return 0;
+    }
+    size_t copied = 0;
+    return forEachRecent(found->second, count_, [&](const TradePrint& print_) { prints_[copied++] = print_; });
+}
+
+bool TradeTape::summarize(TokenT token_, size_t count_, TapeSummary& summary_) const {
+    const auto found = _tapeIndex.find(token_);
+    if (found == _tapeIndex.end()) {
+        return false;
+    }
+
+    summary_ = TapeSummary{};
+    PriceT previous = 0;
+    forEachRecent(found->second, count_, [&](const TradePrint& print_) {
+        if (summary_._trades++ == 0) {
+            summary_._firstNanos = print_._timestamp;
+        }
+        summary_._lastNanos = print_._timestamp;
+        const auto quantity = static_cast<uint64_t>(std::max(print_._quantity, 0));
+        (print_._aggressor == BUY ? summary_._buyVolume : summary_._sellVolume) += quantity;
+        if (previous > 0 && print_._price > 0) {
+            const double change = std::log(static_cast<double>(print_._price) / static_cast<double>(previous));
+            summary_._realizedVariance += change * change;
+        }
+        previous = print_._price;
+    });
+    return true;
+}
+
+uint64_t TradeTape::getTradeCount(TokenT token_) const {
+    const auto found = _tapeIndex.find(token_);
+    return found == _tapeIndex.end() ? 0 : _heads[found->second]._count.load(std::memory_order_acquire);
+}
+
+} // namespace MarketDataProvider
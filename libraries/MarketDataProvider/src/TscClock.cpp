@@ -0,0 +1,37 @@
+#include "MarketDataProvider/TscClock.hpp"
+
+#include <spdlog/spdlog.h>
+#include <thread>
+
+namespace MarketDataProvider {
+
+namespace {
+
+uint64_t steadyNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+const TscClock::Calibration& TscClock::calibration() {
+    static const Calibration calibration = [] {
+        constexpr auto Window = std::chrono::milliseconds(10);
+
+        Calibration result;
+        const uint64_t startNanos = steadyNanos();
+        const uint64_t startTicks = now();
+        std::this_thread::sleep_for(Window);
+        const uint64_t endNanos = steadyNanos();
+        const uint64_t endTicks = now();
+        if (endTicks > startTicks) {
+            result._nanosPerTick = static_cast<double>(endNanos - startNanos) / static_cast<double>(endTicks - startTicks);
+        }
+
+        spdlog::info("TscClock calibrated at {:.4f} ns per tick", result._nanosPerTick);
+        return result;
+    }();
+    return calibration;
+}
+
+} // namespace MarketDataProvider
@@ -1,24 +1,29 @@
 #include "OptionsGreeks/OptionsGreeks.hpp"
 #include "OptionsGreeks/IVCalculator/BlackScholesModel.hpp"
 
+#include <Profiling/Profiling.hpp>
 #include <ctime>
 
 namespace OptionsGreeks {
 
 double GetDelta(double S, double K, double v, double r, double T, bool IsCall) {
+    PROFILE_ZONE();
     return IVCalculator::delta(S, K, r, v, T) - (not IsCall);
 }
 
 double GetGamma(double s, double k, double v, double r, double t, [[maybe_unused]] bool IsCall) {
+    PROFILE_ZONE();
     // Identical to call by put-call parity
     return IVCalculator::gamma(s, k, r, v, t) * 100.0;
 }
 
 double GetVega(double s, double k, double v, double r, double t, [[maybe_unused]] bool IsCall) {
+    PROFILE_ZONE();
     return IVCalculator::vega(s, k, r, v, t) / 10000.0;
 }
 
 double GetRho(double s, double k, double v, double r, double t, bool IsCall) {
+    PROFILE_ZONE();
     if (IsCall) {
         return IVCalculator::call_rho(s, k, r, v, t);
     } else {
@@ -27,6 +32,7 @@ double GetRho(double s, double k, double v, double r, double t, bool IsCall) {
 }
 
 double GetTheta(double s, double k, double v, double r, double t, bool IsCall) {
+    PROFILE_ZONE();
     if (IsCall) {
         return IVCalculator::call_theta(s, k, r, v, t) / 36500.0;
     } else {
@@ -35,10 +41,12 @@ double GetTheta(double s, double k, double v, double r, double t, bool IsCall) {
 }
 
 double GetIV(double S, double K, double r, double T, double P, bool IsCE) {
+    PROFILE_ZONE();
     return IVCalculator::option_price(S, K, r, T, P, IsCE);
 }
 
 double GetOptionPrice(double s, double k, double v, double r, double t, bool IsCall) {
+    PROFILE_ZONE();
     if (IsCall) {
         return IVCalculator::call_price(s, k, r, v, t);
     } else {
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @brief Tracy instrumentation for the hot paths
+ *
+ * Configure with -DTRADING_PLATFORM_PROFILING=ON and connect the Tracy
+ * profiler to the running process. Without the option every macro expands
+ * to nothing and Tracy is not even included, so release builds carry no
+ * trace of it.
+ *
+ * PROFILE_ZONE()             time the enclosing scope, named after the function
+ * PROFILE_ZONE_NAMED(name_)  same with a fixed name, for blocks inside a function
+ * PROFILE_FRAME(name_)       end one iteration of the named loop (a Tracy frame)
+ * PROFILE_PLOT(name_, value_) add a point to a numeric plot
+ * PROFILE_THREAD(name_)      name the calling thread in the timeline
+ *
+ * Frame and plot names must be string literals: Tracy keys them by pointer.
+ */
+#ifdef TRADING_PLATFORM_PROFILING
+
+#include <tracy/Tracy.hpp>
+
+#define PROFILE_ZONE()               ZoneScoped
+#define PROFILE_ZONE_NAMED(name_)    ZoneScopedN(name_)
+#define PROFILE_FRAME(name_)         FrameMarkNamed(name_)
+#define PROFILE_PLOT(name_, value_)  TracyPlot(name_, value_)
+#define PROFILE_THREAD(name_)        tracy::SetThreadName(name_)
+
+#else
+
+#define PROFILE_ZONE()
+#define PROFILE_ZONE_NAMED(name_)
+#define PROFILE_FRAME(name_)
+#define PROFILE_PLOT(name_, value_)
+#define PROFILE_THREAD(name_)
+
+#endif
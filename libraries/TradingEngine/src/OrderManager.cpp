@@ -1,5 +1,6 @@
 #include "TradingEngine/OrderManager.hpp"
 #include <DatabaseLayer/Enums.hpp>
+#include <Profiling/Profiling.hpp>
 #include <spdlog/spdlog.h>
 #include <chrono>
 
@@ -10,6 +11,7 @@ OrderManager::OrderManager() {
 }
 
 OrderId OrderManager::placeOrder(const nlohmann::json& orderRequest) {
+    PROFILE_ZONE();
     if (!validateOrder(orderRequest)) {
         spdlog::error("Order validation failed");
         return 0;
@@ -38,6 +40,7 @@ OrderId OrderManager::placeOrder(const nlohmann::json& orderRequest) {
 }
 
 bool OrderManager::modifyOrder(const nlohmann::json& modifyRequest) {
+    PROFILE_ZONE();
     if (!modifyRequest.contains(JSON_ORDER_ID)) {
         spdlog::error("Modify request missing order ID");
         return false;
@@ -71,6 +74,7 @@ bool OrderManager::modifyOrder(const nlohmann::json& modifyRequest) {
 }
 
 bool OrderManager::cancelOrder(const nlohmann::json& cancelRequest) {
+    PROFILE_ZONE();
     if (!cancelRequest.contains(JSON_ORDER_ID)) {
         spdlog::error("Cancel request missing order ID");
         return false;
@@ -103,6 +107,7 @@ void OrderManager::setOrderCallback(OrderCallback callback) {
 }
 
 void OrderManager::processOrderFill(OrderId orderId, double fillPrice, int fillQuantity) {
+    PROFILE_ZONE();
     auto it = _orders.find(orderId);
     if (it == _orders.end()) {
         spdlog::error("Order not found for fill: {}", orderId);
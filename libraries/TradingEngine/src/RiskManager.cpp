@@ -1,5 +1,6 @@
 #include "TradingEngine/RiskManager.hpp"
 #include <DatabaseLayer/Enums.hpp>
+#include <Profiling/Profiling.hpp>
 #include <spdlog/spdlog.h>
 #include <chrono>
 
@@ -10,6 +11,7 @@ RiskManager::RiskManager() {
 }
 
 bool RiskManager::validateOrder(const nlohmann::json& orderRequest, const std::string& clientId) {
+    PROFILE_ZONE();
     try {
         // Get or create risk limits for client
         auto it = _clientLimits.find(clientId);
@@ -112,7 +112,7 @@ MarketDataProvider::OrderMessage MarketDataSimulator::createRandomOrder(MarketDa
     order._token = token;
     order._orderType = (_rng() % 2 == 0) ? 'B' : 'S'; // Buy or Sell
     order._timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count() / 1e9;
+        std::chrono::system_clock::now().time_since_epoch()).count();
     
     // Update price with random walk
     double& currentPrice = _currentPrices[token];
@@ -135,11 +135,16 @@ MarketDataProvider::OrderMessage MarketDataSimulator::createRandomOrder(MarketDa
 MarketDataProvider::TradeMessage MarketDataSimulator::createRandomTrade(MarketDataProvider::TokenT token) {
     MarketDataProvider::TradeMessage trade;
     
-    trade._buyOrderId = _currentOrderId - _rng() % 100; // Random recent order
-    trade._sellOrderId = _currentOrderId - _rng() % 100;
+    // Random recent orders, never below the first id early in a run
+    const auto recentOrderId = [this]() -> MarketDataProvider::OrderIdT {
+        const MarketDataProvider::OrderIdT back = _rng() % 100;
+        return _currentOrderId > back ? _currentOrderId - back : 1;
+    };
+    trade._buyOrderId = recentOrderId();
+    trade._sellOrderId = recentOrderId();
     trade._token = token;
     trade._timeStamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count() / 1e9;
+        std::chrono::system_clock::now().time_since_epoch()).count();
     
     double currentPrice = _currentPrices[token];
     trade._price = static_cast<int>(currentPrice * 100);
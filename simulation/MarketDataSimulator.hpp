@@ -62,7 +62,7 @@ private:
     DataCallback _orderCallback;
     TradeCallback _tradeCallback;
     
-    double _currentOrderId = 1.0;
+    MarketDataProvider::OrderIdT _currentOrderId = 1;
     std::unordered_map<MarketDataProvider::TokenT, double> _currentPrices;
     
     void simulationLoop();
@@ -1,5 +1,218 @@
 #include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <MarketDataProvider/MarketDataProvider.hpp>
+#include <MarketDataProvider/StreamManager.ipp>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Build a single message packet: StreamHeader, message type and the message in NSE wire form
+template <typename MessageT>
+std::vector<char> makePacket(int sequence, char type, const MessageT& message, short streamId = 0) {
+    const auto wire = MarketDataProvider::NseDecoder::encode(message);
+    std::vector<char> packet(sizeof(MarketDataProvider::StreamHeader) + 1 + sizeof(wire));
+
+    MarketDataProvider::StreamHeader header{};
+    header._len = static_cast<short>(packet.size());
+    header._streamId = streamId;
+    header._sequence = sequence;
+    header._type = type;
+
+    std::memcpy(packet.data(), &header, sizeof(header));
+    packet[sizeof(header)] = type;
+    std::memcpy(packet.data() + sizeof(header) + 1, &wire, sizeof(wire));
+    return packet;
+}
+
+MarketDataProvider::OrderMessage makeOrder(MarketDataProvider::OrderIdT orderId, MarketDataProvider::TokenT token, char side,
+                                           MarketDataProvider::PriceT price, MarketDataProvider::QuantityT quantity) {
+    MarketDataProvider::OrderMessage order{};
+    order._orderId = orderId;
+    order._token = token;
+    order._orderType = side;
+    order._price = price;
+    order._quantity = quantity;
+    return order;
+}
+
+struct LoopbackResult {
+    bool                              _connected = false;
+    MarketDataProvider::SocketBackend _backend   = MarketDataProvider::RECVMMSG;
+    std::vector<int>                  _sequences;
+    std::vector<uint64_t>             _timestamps;
+    MarketDataProvider::SocketStats   _stats;
+};
+
+// Send packets to a loopback multicast group and collect what the socket receives
+LoopbackResult receiveLoopback(MarketDataProvider::SocketBackend backend, int packets, MarketDataProvider::TokenT token) {
+    MarketDataProvider::SocketConfig config;
+    config._interface = "127.0.0.1";
+    config._batchSize = 8;
+    config._backend = backend;
+    const int port = 30000 + static_cast<int>(::getpid() % 20000) + (backend == MarketDataProvider::IO_URING);
+
+    LoopbackResult result;
+    MarketDataProvider::NetworkSocket socket("239.255.0.1", port, config);
+    if (!socket.connect()) {
+        return result;
+    }
+    result._connected = true;
+    result._backend = socket.getBackend();
+
+    std::mutex mutex;
+    socket.startReceivingBatch([&](const MarketDataProvider::PacketView* views, size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) {
+            const auto* header = reinterpret_cast<const MarketDataProvider::StreamHeader*>(views[i]._data);
+            result._sequences.push_back(header->_sequence);
+            result._timestamps.push_back(views[i]._rxNanos);
+        }
+    });
+
+    for (int sequence = 1; sequence <= packets; ++sequence) {
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10));
+        socket.send(packet.data(), packet.size());
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (result._sequences.size() == static_cast<size_t>(packets)) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    socket.stopReceiving();
+    result._stats = socket.getStats();
+    return result;
+}
+
+// Minimal recovery server: answers each RecoveryRequest with the packets it
+// holds for the range followed by RECOVERY_COMPLETE, once released. The
+// completion frame carries completionPadding bytes of payload.
+class RecoveryServer {
+public:
+    explicit RecoveryServer(std::map<std::pair<short, int>, std::vector<char>> packets, bool released = true,
+                            size_t completionPadding = 0)
+        : _packets(std::move(packets)), _released(released), _completionPadding(completionPadding) {
+        _listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        ::getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &length);
+        _port = ntohs(address.sin_port);
+        ::listen(_listener, 1);
+        _thread = std::thread([this] { serve(); });
+    }
+
+    ~RecoveryServer() {
+        release();
+        ::shutdown(_listener, SHUT_RDWR);
+        ::close(_listener);
+        _thread.join();
+    }
+
+    int port() const { return _port; }
+    void release() { _released = true; }
+
+private:
+    std::map<std::pair<short, int>, std::vector<char>> _packets;
+    std::atomic<bool> _released;
+    size_t _completionPadding;
+    int _listener = -1;
+    int _port = 0;
+    std::thread _thread;
+
+    void serve() {
+        const int client = ::accept(_listener, nullptr, nullptr);
+        if (client < 0) {
+            return;
+        }
+        MarketDataProvider::RecoveryRequest request;
+        while (::recv(client, &request, sizeof(request), MSG_WAITALL) == sizeof(request)) {
+            while (!_released) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            for (int sequence = request._startSeqNo; sequence <= request._endSeqNo; ++sequence) {
+                auto it = _packets.find({request._streamId, sequence});
+                if (it != _packets.end()) {
+                    sendFrame(client, request._streamId, sequence, MarketDataProvider::RECOVERY_DATA, it->second);
+                }
+            }
+            sendFrame(client, request._streamId, request._endSeqNo, MarketDataProvider::RECOVERY_COMPLETE,
+                      std::vector<char>(_completionPadding, 0));
+        }
+        ::close(client);
+    }
+
+    static void sendFrame(int client, short streamId, int sequence, char status, const std::vector<char>& packet) {
+        MarketDataProvider::RecoveryResponse response{};
+        response._msgLen = static_cast<short>(sizeof(response) + packet.size());
+        response._streamId = streamId;
+        response._seqNo = sequence;
+        response._msgType = MarketDataProvider::RECOVERY;
+        response._requestStatus = status;
+        std::vector<char> frame(sizeof(response));
+        std::memcpy(frame.data(), &response, sizeof(response));
+        frame.insert(frame.end(), packet.begin(), packet.end());
+        ::send(client, frame.data(), frame.size(), MSG_NOSIGNAL);
+    }
+};
+
+// Poll recovery until the stream has no gap left
+bool waitForRecovery(MarketDataProvider::StreamManager& manager, short streamId) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.isRecovering(streamId) && std::chrono::steady_clock::now() < deadline) {
+        if (manager.pollRecovery() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return !manager.isRecovering(streamId);
+}
+
+} // namespace
+
+// A feed outside the library: bodies are OrderMessage as is, new orders and cancels only
+struct NativeOrderDecoder {
+    template <typename HandlerT>
+    static bool decode(char type_, const char* body_, size_t size_, HandlerT& handler_) {
+        if (size_ < sizeof(MarketDataProvider::OrderMessage)) {
+            return false;
+        }
+        MarketDataProvider::OrderMessage order;
+        std::memcpy(&order, body_, sizeof(order));
+        if (type_ == MarketDataProvider::NEW) {
+            handler_.newOrder(order);
+        } else if (type_ == MarketDataProvider::CANCEL) {
+            handler_.cancelOrder(order);
+        } else {
+            handler_.unknownMessage(type_);
+        }
+        return true;
+    }
+
+    template <typename HandlerT>
+    static void prefetch(char, const char*, size_t, HandlerT&) {}
+};
 
 class MarketDataProviderTest : public ::testing::Test {
 protected:
@@ -119,6 +332,1608 @@ TEST_F(MarketDataProviderTest, StreamManagerCreation) {
     });
 }
 
+TEST_F(MarketDataProviderTest, StreamManagerRoutesEveryToken) {
+    MarketDataProvider::StreamManager manager(0);
+    manager.init({12345, 12346, 12347});
+
+    int sequence = 0;
+    for (int token : {12345, 12346, 12347}) {
+        ++sequence;
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100 + token % 10, 10));
+        manager.process(packet.data(), packet.size());
+    }
+
+    for (int token : {12345, 12346, 12347}) {
+        const auto* ladder = manager.getLadderBuilder(token);
+        ASSERT_NE(ladder, nullptr);
+        auto depth = ladder->getLadderDepth();
+        EXPECT_EQ(depth._token, token);
+        EXPECT_EQ(depth._bid[0]._price, 100 + token % 10);
+        EXPECT_EQ(depth._bid[0]._quantity, 10);
+    }
+    EXPECT_EQ(manager.getLadderBuilder(99999), nullptr);
+}
+
+TEST_F(MarketDataProviderTest, TokenIndexDenseAndHashed) {
+    std::vector<std::unique_ptr<MarketDataProvider::LadderBuilder>> builders;
+    std::vector<std::pair<MarketDataProvider::TokenT, MarketDataProvider::LadderBuilder*>> compact, sparse;
+    for (int i = 0; i < 64; ++i) {
+        builders.push_back(std::make_unique<MarketDataProvider::LadderBuilder>(i));
+        compact.emplace_back(35000 + i, builders.back().get());
+        sparse.emplace_back(i * 1000003, builders.back().get());
+    }
+
+    MarketDataProvider::TokenIndex dense;
+    dense.build(compact);
+    EXPECT_TRUE(dense.isDense());
+
+    MarketDataProvider::TokenIndex hashed;
+    hashed.build(sparse);
+    EXPECT_FALSE(hashed.isDense());
+
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(dense.find(35000 + i), builders[i].get());
+        EXPECT_EQ(hashed.find(i * 1000003), builders[i].get());
+    }
+    EXPECT_EQ(dense.find(34999), nullptr);
+    EXPECT_EQ(hashed.find(7), nullptr);
+}
+
+TEST_F(MarketDataProviderTest, LadderDepthBestPriceFirst) {
+    for (auto type : {MarketDataProvider::FLAT_MAP, MarketDataProvider::TICK_ARRAY}) {
+        MarketDataProvider::LadderBuilder ladder(token, type);
+        double orderId = 0;
+        for (int price : {100, 102, 101}) {
+            ladder.processNewOrder(makeOrder(++orderId, token, 'B', price, 10));
+        }
+        for (int price : {105, 103, 104}) {
+            ladder.processNewOrder(makeOrder(++orderId, token, 'S', price, 10));
+        }
+
+        auto depth = ladder.getLadderDepth();
+        EXPECT_EQ(depth._bid[0]._price, 102);
+        EXPECT_EQ(depth._bid[1]._price, 101);
+        EXPECT_EQ(depth._bid[2]._price, 100);
+        EXPECT_EQ(depth._ask[0]._price, 103);
+        EXPECT_EQ(depth._ask[1]._price, 104);
+        EXPECT_EQ(depth._ask[2]._price, 105);
+    }
+}
+
+TEST_F(MarketDataProviderTest, TickArrayMatchesFlatMap) {
+    constexpr MarketDataProvider::PriceT tick = 5;
+    MarketDataProvider::LadderBuilder flat(token, MarketDataProvider::FLAT_MAP, tick);
+    MarketDataProvider::LadderBuilder dense(token, MarketDataProvider::TICK_ARRAY, tick);
+
+    std::mt19937 rng(7);
+    std::vector<MarketDataProvider::OrderMessage> live;
+    int mid = 100000;
+    for (int i = 0; i < 20000; ++i) {
+        // Drift far enough to force the tick window to recenter
+        mid += static_cast<int>(rng() % 4) - 1;
+        if (live.empty() || rng() % 3 != 0) {
+            const char side = (rng() & 1) ? 'B' : 'S';
+            const int offset = 1 + static_cast<int>(rng() % 40);
+            const int price = (side == 'B' ? mid - offset : mid + offset) * tick;
+            live.push_back(makeOrder(i + 1, token, side, price, 1 + static_cast<int>(rng() % 50)));
+            flat.processNewOrder(live.back());
+            dense.processNewOrder(live.back());
+        } else {
+            const size_t index = rng() % live.size();
+            flat.processCancelOrder(live[index]);
+            dense.processCancelOrder(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        auto expected = flat.getLadderDepth();
+        auto actual = dense.getLadderDepth();
+        ASSERT_EQ(std::memcmp(&expected, &actual, sizeof(expected)), 0) << "diverged at message " << i;
+    }
+}
+
+TEST_F(MarketDataProviderTest, TradeReducesRestingQuantity) {
+    builder->processNewOrder(makeOrder(1, token, 'B', 100, 50));
+    builder->processNewOrder(makeOrder(2, token, 'S', 101, 30));
+
+    MarketDataProvider::TradeMessage trade{};
+    trade._buyOrderId = 1;
+    trade._sellOrderId = 2;
+    trade._token = token;
+    trade._price = 100;
+    trade._quantity = 25;
+    builder->processTrade(trade);
+
+    auto depth = builder->getLadderDepth();
+    EXPECT_EQ(depth._bid[0]._quantity, 25);
+    EXPECT_EQ(depth._ask[0]._quantity, 5);
+
+    // A trade without a positive quantity changes nothing
+    for (MarketDataProvider::QuantityT quantity : {0, -10}) {
+        trade._quantity = quantity;
+        builder->processTrade(trade);
+        depth = builder->getLadderDepth();
+        EXPECT_EQ(depth._bid[0]._quantity, 25);
+        EXPECT_EQ(depth._ask[0]._quantity, 5);
+        EXPECT_EQ(builder->getOrderBook().find(1)->_quantity, 25);
+        EXPECT_EQ(builder->getOrderBook().find(2)->_quantity, 5);
+    }
+
+    trade._quantity = 25;
+    builder->processTrade(trade);
+    depth = builder->getLadderDepth();
+    EXPECT_EQ(depth._bid[0]._quantity, 0);
+    EXPECT_EQ(depth._ask[0]._quantity, 0);
+}
+
+TEST_F(MarketDataProviderTest, OrderTableMatchesUnorderedMap) {
+    MarketDataProvider::OrderTable<MarketDataProvider::Order> table(16);
+    std::unordered_map<MarketDataProvider::OrderKeyT, MarketDataProvider::Order> expected;
+
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 50000; ++i) {
+        const MarketDataProvider::OrderKeyT key = rng() % 2048;
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(table.erase(key), expected.erase(key) == 1);
+        } else {
+            MarketDataProvider::Order order{static_cast<int>(i), static_cast<int>(key)};
+            table.insert(key, order);
+            expected[key] = order;
+        }
+    }
+
+    EXPECT_EQ(table.size(), expected.size());
+    for (MarketDataProvider::OrderKeyT key = 0; key < 2048; ++key) {
+        const auto* found = table.find(key);
+        auto it = expected.find(key);
+        ASSERT_EQ(found != nullptr, it != expected.end()) << "key " << key;
+        if (found) {
+            EXPECT_EQ(found->_price, it->second._price);
+            EXPECT_EQ(found->_quantity, it->second._quantity);
+        }
+    }
+
+    // The id that marks free slots is still an ordinary key
+    constexpr auto Sentinel = MarketDataProvider::OrderTable<MarketDataProvider::Order>::EmptyKey;
+    const size_t size = table.size();
+    EXPECT_EQ(table.find(Sentinel), nullptr);
+    table.insert(Sentinel, MarketDataProvider::Order{7, 9});
+    EXPECT_EQ(table.size(), size + 1);
+    ASSERT_NE(table.find(Sentinel), nullptr);
+    EXPECT_EQ(table.find(Sentinel)->_price, 7);
+    size_t visited = 0;
+    table.forEach([&](MarketDataProvider::OrderKeyT key, const MarketDataProvider::Order&) { visited += key == Sentinel; });
+    EXPECT_EQ(visited, 1u);
+    EXPECT_TRUE(table.erase(Sentinel));
+    EXPECT_FALSE(table.erase(Sentinel));
+    EXPECT_EQ(table.find(Sentinel), nullptr);
+    EXPECT_EQ(table.size(), size);
+}
+
+TEST_F(MarketDataProviderTest, QueuePositionFollowsTimePriority) {
+    for (int id = 1; id <= 4; ++id) {
+        builder->processNewOrder(makeOrder(id, token, 'B', 100, 10 * id));
+    }
+
+    auto position = builder->getQueuePosition(3);
+    ASSERT_TRUE(position._found);
+    EXPECT_EQ(position._ordersAhead, 2u);
+    EXPECT_EQ(position._quantityAhead, 30);
+    EXPECT_EQ(position._levelOrders, 4u);
+    EXPECT_EQ(position._levelQuantity, 100);
+
+    // Cancelling an order ahead moves us up
+    builder->processCancelOrder(makeOrder(1, token, 'B', 100, 10));
+    EXPECT_EQ(builder->getQueuePosition(3)._ordersAhead, 1u);
+
+    // Reducing quantity keeps priority, increasing it sends the order to the back
+    builder->processModifyOrder(makeOrder(2, token, 'B', 100, 5));
+    EXPECT_EQ(builder->getQueuePosition(2)._ordersAhead, 0u);
+    EXPECT_EQ(builder->getQueuePosition(3)._quantityAhead, 5);
+    builder->processModifyOrder(makeOrder(2, token, 'B', 100, 50));
+    EXPECT_EQ(builder->getQueuePosition(2)._ordersAhead, 2u);
+
+    // A partial fill reduces the head of the queue in place
+    MarketDataProvider::TradeMessage trade{};
+    trade._buyOrderId = 3;
+    trade._token = token;
+    trade._price = 100;
+    trade._quantity = 10;
+    builder->processTrade(trade);
+    EXPECT_EQ(builder->getQueuePosition(3)._ordersAhead, 0u);
+    EXPECT_EQ(builder->getQueuePosition(2)._quantityAhead, 20 + 40);
+    EXPECT_EQ(builder->getLadderDepth()._bid[0]._quantity, 110);
+
+    EXPECT_FALSE(builder->getQueuePosition(1)._found);
+}
+
+TEST_F(MarketDataProviderTest, CancelUsesRestingOrderSide) {
+    builder->processNewOrder(makeOrder(1, token, 'B', 100, 10));
+
+    // The cancel carries the wrong side, the book knows better
+    builder->processCancelOrder(makeOrder(1, token, 'S', 100, 10));
+
+    auto depth = builder->getLadderDepth();
+    EXPECT_EQ(depth._bid[0]._quantity, 0);
+    EXPECT_EQ(depth._ask[0]._quantity, 0);
+    EXPECT_EQ(builder->getOrderBook().size(), 0u);
+    EXPECT_EQ(builder->getOrderBook().levelCount(), 0u);
+}
+
+TEST_F(MarketDataProviderTest, DepthUpdatesPublishOnlyVisibleChanges) {
+    std::vector<MarketDataProvider::DepthUpdate> updates;
+    builder->subscribe([&updates](const MarketDataProvider::DepthUpdate& update) { updates.push_back(update); });
+
+    for (int level = 0; level < MarketDataProvider::LADDER_DEPTH; ++level) {
+        builder->processNewOrder(makeOrder(level + 1, token, 'B', 100 - level, 10));
+    }
+    ASSERT_EQ(updates.size(), static_cast<size_t>(MarketDataProvider::LADDER_DEPTH));
+    EXPECT_EQ(updates.back()._version, static_cast<uint64_t>(MarketDataProvider::LADDER_DEPTH));
+
+    // Below the published depth: no event
+    builder->processNewOrder(makeOrder(10, token, 'B', 50, 10));
+    EXPECT_EQ(updates.size(), static_cast<size_t>(MarketDataProvider::LADDER_DEPTH));
+
+    // Joining the best level changes only its quantity
+    builder->processNewOrder(makeOrder(11, token, 'B', 100, 5));
+    ASSERT_EQ(updates.size(), static_cast<size_t>(MarketDataProvider::LADDER_DEPTH) + 1);
+    const auto& join = updates.back();
+    EXPECT_EQ(join._token, token);
+    EXPECT_EQ(join._changedMask, 1u);
+    ASSERT_EQ(join._count, 1);
+    EXPECT_EQ(join._deltas[0]._level, 0);
+    EXPECT_EQ(join._deltas[0]._side, MarketDataProvider::BUY);
+    EXPECT_EQ(join._deltas[0]._quantity, 15);
+
+    // A new best ask touches only the ask side
+    builder->processNewOrder(makeOrder(12, token, 'S', 101, 7));
+    EXPECT_EQ(updates.back()._changedMask, 1u << MarketDataProvider::LADDER_DEPTH);
+    EXPECT_EQ(builder->getVersion(), updates.back()._version);
+
+    // Removing the best bid shifts every visible bid level up
+    builder->processCancelOrder(makeOrder(1, token, 'B', 100, 10));
+    builder->processCancelOrder(makeOrder(11, token, 'B', 100, 5));
+    EXPECT_EQ(updates.back()._changedMask, (1u << MarketDataProvider::LADDER_DEPTH) - 1);
+    EXPECT_EQ(builder->getLadderDepth()._bid[MarketDataProvider::LADDER_DEPTH - 1]._price, 50);
+}
+
+TEST_F(MarketDataProviderTest, SpscRingBufferDropsWhenFull) {
+    MarketDataProvider::SpscRingBuffer<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(4));
+    EXPECT_EQ(ring.drops(), 1u);
+    EXPECT_EQ(ring.size(), 4u);
+
+    std::vector<int> popped;
+    EXPECT_EQ(ring.popBatch([&](int value) { popped.push_back(value); }, 3), 3u);
+    EXPECT_EQ(popped, (std::vector<int>{0, 1, 2}));
+    EXPECT_TRUE(ring.tryPush(5));
+    EXPECT_EQ(ring.popBatch([&](int value) { popped.push_back(value); }, 8), 2u);
+    EXPECT_EQ(popped, (std::vector<int>{0, 1, 2, 3, 5}));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST_F(MarketDataProviderTest, SpscRingBufferPreservesOrderAcrossThreads) {
+    constexpr uint64_t Count = 100'000;
+
+    for (auto strategy : {MarketDataProvider::BUSY_SPIN, MarketDataProvider::BLOCKING}) {
+        MarketDataProvider::SpscRingBuffer<uint64_t> ring(1024, strategy);
+        std::atomic<bool> running{true};
+
+        std::thread producer([&] {
+            for (uint64_t i = 0; i < Count;) {
+                if (ring.tryPush(i)) {
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t expected = 0;
+        bool ordered = true;
+        while (expected < Count) {
+            ring.waitPopBatch([&](uint64_t value) {
+                ordered &= value == expected++;
+            }, 16, running);
+        }
+        producer.join();
+
+        EXPECT_TRUE(ordered);
+        EXPECT_EQ(ring.pushed(), Count);
+    }
+}
+
+TEST_F(MarketDataProviderTest, NetworkSocketMulticastLoopback) {
+    constexpr int Packets = 32;
+    const auto result = receiveLoopback(MarketDataProvider::RECVMMSG, Packets, token);
+    if (!result._connected) {
+        GTEST_SKIP() << "Multicast is not available on loopback";
+    }
+
+    ASSERT_EQ(result._sequences.size(), static_cast<size_t>(Packets));
+    for (int i = 0; i < Packets; ++i) {
+        EXPECT_EQ(result._sequences[i], i + 1);
+        EXPECT_GT(result._timestamps[i], 0u);
+    }
+    EXPECT_EQ(result._stats._packets, static_cast<uint64_t>(Packets));
+    EXPECT_LE(result._stats._batches, result._stats._packets);
+    EXPECT_EQ(result._stats._truncated, 0u);
+}
+
+TEST_F(MarketDataProviderTest, NetworkSocketIoUringLoopback) {
+    constexpr int Packets = 32;
+    const auto result = receiveLoopback(MarketDataProvider::IO_URING, Packets, token);
+    if (!result._connected) {
+        GTEST_SKIP() << "Multicast is not available on loopback";
+    }
+    if (result._backend != MarketDataProvider::IO_URING) {
+        GTEST_SKIP() << "io_uring is not available, socket fell back to recvmmsg";
+    }
+
+    ASSERT_EQ(result._sequences.size(), static_cast<size_t>(Packets));
+    for (int i = 0; i < Packets; ++i) {
+        EXPECT_EQ(result._sequences[i], i + 1);
+        EXPECT_GT(result._timestamps[i], 0u);
+    }
+    EXPECT_EQ(result._stats._packets, static_cast<uint64_t>(Packets));
+    EXPECT_EQ(result._stats._noBuffers, 0u);
+}
+
+TEST_F(MarketDataProviderTest, StreamManagerRecoversGapInOrder) {
+    constexpr short Stream = 3;
+    auto packetFor = [&](int sequence, short streamId) {
+        return makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence + 100 * streamId, token, 'B', 100, 10), streamId);
+    };
+
+    RecoveryServer server({{{Stream, 2}, packetFor(2, Stream)}, {{Stream, 3}, packetFor(3, Stream)}}, false);
+    MarketDataProvider::Recovery recovery("127.0.0.1", server.port());
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setRecovery(&recovery);
+
+    for (auto [sequence, streamId] : {std::pair<int, short>{1, Stream}, {4, Stream}, {5, Stream}, {1, 1}}) {
+        auto packet = packetFor(sequence, streamId);
+        manager.process(packet.data(), packet.size());
+    }
+
+    // 4 and 5 wait for the gap, the other stream is unaffected
+    const auto& book = manager.getLadderBuilder(token)->getOrderBook();
+    EXPECT_EQ(book.size(), 2u);
+    EXPECT_EQ(manager.getStreamStats(Stream)._buffered, 2u);
+    EXPECT_EQ(manager.getStreamStats(1)._expected, 2);
+
+    server.release();
+    ASSERT_TRUE(waitForRecovery(manager, Stream));
+
+    std::vector<MarketDataProvider::OrderKeyT> queue;
+    book.forEachOrder(MarketDataProvider::BUY, 100, [&](const MarketDataProvider::OrderNode& order) {
+        queue.push_back(order._orderId);
+    });
+    EXPECT_EQ(queue, (std::vector<MarketDataProvider::OrderKeyT>{301, 101, 302, 303, 304, 305}));
+
+    const auto stats = manager.getStreamStats(Stream);
+    EXPECT_EQ(stats._expected, 6);
+    EXPECT_EQ(stats._gaps, 1u);
+    EXPECT_EQ(stats._recovered, 2u);
+    EXPECT_EQ(stats._skipped, 0u);
+    EXPECT_EQ(recovery.getStats()._completed, 1u);
+}
+
+TEST_F(MarketDataProviderTest, StreamManagerSkipsUnrecoverableGap) {
+    RecoveryServer server({});
+    MarketDataProvider::Recovery recovery("127.0.0.1", server.port());
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setRecovery(&recovery);
+
+    for (int sequence : {1, 4, 5}) {
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10));
+        manager.process(packet.data(), packet.size());
+    }
+    ASSERT_TRUE(waitForRecovery(manager, 0));
+
+    auto stats = manager.getStreamStats(0);
+    EXPECT_EQ(stats._expected, 6);
+    EXPECT_EQ(stats._skipped, 2u);
+    EXPECT_EQ(stats._buffered, 0u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getOrderBook().size(), 3u);
+
+    // Late copies of applied or skipped packets are dropped
+    auto late = makePacket(2, MarketDataProvider::NEW, makeOrder(2, token, 'B', 100, 10));
+    manager.process(late.data(), late.size());
+    EXPECT_EQ(manager.getStreamStats(0)._duplicates, 1u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getOrderBook().size(), 3u);
+}
+
+TEST_F(MarketDataProviderTest, RecoveryOutlivesStreamReset) {
+    auto packetFor = [&](int sequence) {
+        return makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10));
+    };
+
+    RecoveryServer server({}, false);
+    MarketDataProvider::Recovery recovery("127.0.0.1", server.port());
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setRecovery(&recovery);
+
+    for (int sequence : {1, 3}) {
+        auto packet = packetFor(sequence);
+        manager.process(packet.data(), packet.size());
+    }
+    ASSERT_TRUE(manager.isRecovering(0));
+
+    // The answer to the request made before the reset arrives after it
+    manager.resetStream(0, 10);
+    server.release();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.pollRecovery() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(manager.isRecovering(0));
+
+    // Later gaps are still recovered rather than skipped on the spot
+    for (int sequence : {10, 12}) {
+        auto packet = packetFor(sequence);
+        manager.process(packet.data(), packet.size());
+    }
+    EXPECT_TRUE(manager.isRecovering(0));
+    ASSERT_TRUE(waitForRecovery(manager, 0));
+    EXPECT_EQ(manager.getStreamStats(0)._skipped, 1u);
+
+    // Overrunning the reorder window counts as a gap with recovery attached too
+    auto ahead = packetFor(13 + MarketDataProvider::REORDER_WINDOW);
+    manager.process(ahead.data(), ahead.size());
+    const auto stats = manager.getStreamStats(0);
+    EXPECT_EQ(stats._gaps, 2u);
+    EXPECT_EQ(stats._expected, 14 + MarketDataProvider::REORDER_WINDOW);
+    EXPECT_EQ(recovery.getStats()._completed, 2u);
+}
+
+TEST_F(MarketDataProviderTest, RecoveryAppliesEveryMessageOfADatagram) {
+    auto packetFor = [&](int sequence) {
+        return makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10));
+    };
+
+    // The original datagram carried 2 and 3, so one RECOVERY_DATA frame fills both
+    std::vector<char> datagram = packetFor(2);
+    const auto third = packetFor(3);
+    datagram.insert(datagram.end(), third.begin(), third.end());
+    RecoveryServer server({{{0, 2}, datagram}}, true);
+    MarketDataProvider::Recovery recovery("127.0.0.1", server.port());
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setRecovery(&recovery);
+
+    for (int sequence : {1, 4}) {
+        auto packet = packetFor(sequence);
+        manager.process(packet.data(), packet.size());
+    }
+    ASSERT_TRUE(waitForRecovery(manager, 0));
+
+    const auto stats = manager.getStreamStats(0);
+    EXPECT_EQ(stats._expected, 5);
+    EXPECT_EQ(stats._recovered, 2u);
+    EXPECT_EQ(stats._skipped, 0u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getOrderBook().size(), 4u);
+}
+
+TEST_F(MarketDataProviderTest, RecoverySkipsOversizeStatusFrames) {
+    auto packetFor = [&](int sequence) {
+        return makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10));
+    };
+
+    // Completions larger than any packet must not leave bytes behind for the next request
+    RecoveryServer server({{{0, 2}, packetFor(2)}, {{0, 4}, packetFor(4)}}, true,
+                          2 * MarketDataProvider::MAX_PACKET_SIZE + 100);
+    MarketDataProvider::Recovery recovery("127.0.0.1", server.port());
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setRecovery(&recovery);
+
+    for (int sequence : {1, 3}) {
+        auto packet = packetFor(sequence);
+        manager.process(packet.data(), packet.size());
+    }
+    ASSERT_TRUE(waitForRecovery(manager, 0));
+    auto packet = packetFor(5);
+    manager.process(packet.data(), packet.size());
+    ASSERT_TRUE(waitForRecovery(manager, 0));
+
+    const auto stats = manager.getStreamStats(0);
+    EXPECT_EQ(stats._expected, 6);
+    EXPECT_EQ(stats._recovered, 2u);
+    EXPECT_EQ(stats._skipped, 0u);
+    EXPECT_EQ(recovery.getStats()._completed, 2u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getOrderBook().size(), 5u);
+}
+
+TEST_F(MarketDataProviderTest, LineArbitratorForwardsFirstCopy) {
+    MarketDataProvider::LineArbitrator arbitrator(8);
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+
+    constexpr size_t A = 0;
+    constexpr size_t B = 1;
+    // (line, stream, sequence, receive time)
+    const std::vector<std::tuple<size_t, short, int, uint64_t>> arrivals = {
+        {A, 0, 1, 1000}, {B, 0, 1, 1500},   // A wins by 500ns
+        {B, 0, 2, 1800}, {A, 0, 2, 2000},   // B wins by 200ns
+        {A, 0, 3, 3000}, {B, 1, 3, 3100},   // Same sequence on another stream is not a duplicate
+        {B, 0, 4, 4000}, {A, 0, 4, 4700},   // B wins by 700ns
+        {A, 0, 3, 5000},                    // Retransmit on the same line
+        {A, 0, 20, 6000}, {B, 0, 5, 6100},  // B fell further behind than the window
+    };
+
+    std::vector<std::pair<short, int>> forwarded;
+    for (const auto& [line, streamId, sequence, rxNanos] : arrivals) {
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence * 10 + streamId, token, 'B', 100, 10), streamId);
+        if (arbitrator.accept(line, packet.data(), packet.size(), rxNanos)) {
+            forwarded.emplace_back(streamId, sequence);
+            manager.process(packet.data(), packet.size());
+        }
+    }
+
+    const std::vector<std::pair<short, int>> expected = {{0, 1}, {0, 2}, {0, 3}, {1, 3}, {0, 4}, {0, 20}};
+    EXPECT_EQ(forwarded, expected);
+    EXPECT_EQ(manager.getStreamStats(0)._duplicates, 0u);
+
+    const auto lineA = arbitrator.getLineStats(A);
+    EXPECT_EQ(lineA._packets, 6u);
+    EXPECT_EQ(lineA._won, 3u);
+    EXPECT_EQ(lineA._duplicates, 3u);
+    EXPECT_EQ(lineA._leadSamples, 1u);
+    EXPECT_EQ(lineA._leadNanos, 500u);
+
+    const auto lineB = arbitrator.getLineStats(B);
+    EXPECT_EQ(lineB._packets, 5u);
+    EXPECT_EQ(lineB._won, 3u);
+    EXPECT_EQ(lineB._duplicates, 1u);
+    EXPECT_EQ(lineB._stale, 1u);
+    EXPECT_EQ(lineB._leadSamples, 2u);
+    EXPECT_EQ(lineB._leadNanos, 900u);
+    EXPECT_EQ(lineB._maxLeadNanos, 700u);
+}
+
+TEST_F(MarketDataProviderTest, JournalRecordsEveryPacketAcrossSegments) {
+    const auto directory = std::filesystem::temp_directory_path() / ("mdp_journal_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig config;
+    config._directory = directory.string();
+    config._prefix = "test";
+    config._segmentSize = 8192;
+
+    constexpr int Packets = 200;
+    {
+        MarketDataProvider::Journal journal(config);
+        ASSERT_TRUE(journal.open());
+        MarketDataProvider::StreamManager manager(1);
+        manager.init({token});
+        manager.setJournal(&journal);
+
+        for (int sequence = 1; sequence <= Packets; ++sequence) {
+            auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10), 3);
+            manager.process(packet.data(), packet.size(), 1000 + sequence);
+        }
+
+        const auto stats = journal.getStats();
+        EXPECT_EQ(stats._records, static_cast<uint64_t>(Packets));
+        EXPECT_GT(stats._segments, 1u);
+        EXPECT_EQ(journal.getPosition()._segment, stats._segments - 1);
+    }
+
+    // Walk the segments in order and check each record against what was sent
+    int sequence = 0;
+    uint32_t segments = 0;
+    for (uint32_t index = 0; std::filesystem::exists(directory / fmt::format("test.{:06}.journal", index)); ++index) {
+        std::ifstream file(directory / fmt::format("test.{:06}.journal", index), std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ASSERT_GE(bytes.size(), sizeof(MarketDataProvider::JournalSegmentHeader));
+
+        MarketDataProvider::JournalSegmentHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        EXPECT_EQ(header._magic, MarketDataProvider::JOURNAL_MAGIC);
+        EXPECT_EQ(header._segment, index);
+
+        size_t offset = sizeof(header);
+        while (offset + sizeof(MarketDataProvider::JournalRecordHeader) <= bytes.size()) {
+            MarketDataProvider::JournalRecordHeader record;
+            std::memcpy(&record, bytes.data() + offset, sizeof(record));
+            if (record._size == 0) {
+                break;
+            }
+            ++sequence;
+            const auto expected = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100, 10), 3);
+            ASSERT_EQ(record._size, expected.size());
+            EXPECT_EQ(record._streamId, 3);
+            EXPECT_EQ(record._rxNanos, 1000u + sequence);
+            EXPECT_EQ(std::memcmp(bytes.data() + offset + sizeof(record), expected.data(), expected.size()), 0);
+            offset += (sizeof(record) + record._size + 7) & ~size_t{7};
+        }
+        ++segments;
+    }
+    EXPECT_EQ(sequence, Packets);
+    EXPECT_GT(segments, 1u);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(MarketDataProviderTest, JournalDropsRatherThanWaitForASegment) {
+    const auto directory = std::filesystem::temp_directory_path() / ("mdp_journal_starved_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig config;
+    config._directory = directory.string();
+    config._prefix = "starved";
+    config._segmentSize = 8192;
+    config._rotateTimeout = std::chrono::milliseconds(200);
+
+    MarketDataProvider::Journal journal(config);
+    ASSERT_TRUE(journal.open());
+    // Without the directory the worker cannot prepare any further segment
+    std::filesystem::remove_all(directory);
+
+    const std::vector<char> packet(100, 'x');
+    bool dropped = false;
+    for (int i = 0; i < 1000 && !dropped; ++i) {
+        dropped = !journal.append(packet.data(), packet.size(), 0, 0);
+    }
+    ASSERT_TRUE(dropped);
+    EXPECT_EQ(journal.getStats()._dropped, 1u);
+
+    // Once a rotation has timed out the feed is not held up again
+    const auto before = std::chrono::steady_clock::now();
+    EXPECT_FALSE(journal.append(packet.data(), packet.size(), 0, 0));
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(100));
+    EXPECT_EQ(journal.getStats()._dropped, 2u);
+
+    // The worker keeps retrying, so journaling resumes once a segment can be made
+    std::filesystem::create_directories(directory);
+    bool resumed = false;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!resumed && std::chrono::steady_clock::now() < deadline) {
+        resumed = journal.append(packet.data(), packet.size(), 0, 0);
+        if (!resumed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    EXPECT_TRUE(resumed);
+    journal.close();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(MarketDataProviderTest, ReplayReproducesRecordedBook) {
+    const auto directory = std::filesystem::temp_directory_path() / ("mdp_replay_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig config;
+    config._directory = directory.string();
+    config._prefix = "session";
+    config._segmentSize = 8192;
+
+    const MarketDataProvider::TokenListT tokens = {token, token + 1};
+    MarketDataProvider::StreamManager live(1);
+    live.init(tokens);
+    MarketDataProvider::JournalPosition middle;
+    constexpr int Packets = 300;
+    {
+        MarketDataProvider::Journal journal(config);
+        ASSERT_TRUE(journal.open());
+        live.setJournal(&journal);
+
+        std::mt19937 random(7);
+        for (int sequence = 1; sequence <= Packets; ++sequence) {
+            const MarketDataProvider::TokenT orderToken = tokens[random() % tokens.size()];
+            const char side = random() % 2 ? 'B' : 'S';
+            const bool cancel = sequence > 10 && random() % 4 == 0;
+            const double orderId = cancel ? sequence - 10 : sequence;
+            auto packet = makePacket(sequence, cancel ? MarketDataProvider::CANCEL : MarketDataProvider::NEW,
+                                     makeOrder(orderId, orderToken, side, 100 + static_cast<int>(random() % 8), 10));
+            live.process(packet.data(), packet.size(), 1000 + sequence);
+            if (sequence == Packets / 2) {
+                middle = journal.getPosition();
+            }
+        }
+        live.setJournal(nullptr);
+    }
+
+    MarketDataProvider::JournalReader reader(config._directory, config._prefix);
+    ASSERT_TRUE(reader.open());
+    EXPECT_GT(reader.getSegments().size(), 1u);
+
+    MarketDataProvider::StreamManager replayed(1);
+    replayed.init(tokens);
+    MarketDataProvider::ReplayDriver driver(replayed);
+    const auto stats = driver.run(reader);
+    EXPECT_EQ(stats._packets, static_cast<uint64_t>(Packets));
+    EXPECT_EQ(stats._messages, static_cast<uint64_t>(Packets));
+    EXPECT_GT(stats._messagesPerSecond, 0.0);
+    EXPECT_LE(stats._p50Nanos, stats._p99Nanos);
+    EXPECT_LE(stats._p99Nanos, stats._maxNanos);
+
+    const auto expected = MarketDataProvider::ReplayDriver::checksums(live, tokens);
+    const auto actual = MarketDataProvider::ReplayDriver::checksums(replayed, tokens);
+    ASSERT_EQ(actual.size(), tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(actual[i]._token, expected[i]._token);
+        EXPECT_EQ(actual[i]._checksum, expected[i]._checksum);
+    }
+
+    // A position taken while writing resumes right after that record
+    ASSERT_TRUE(reader.seek(middle));
+    MarketDataProvider::JournalRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(reinterpret_cast<const MarketDataProvider::StreamHeader*>(record._data)->_sequence, Packets / 2 + 1);
+    int remaining = 1;
+    while (reader.next(record)) {
+        ++remaining;
+    }
+    EXPECT_EQ(remaining, Packets / 2);
+
+    // Throughput counts every message of a packet carrying several
+    config._prefix = "batched";
+    {
+        MarketDataProvider::Journal journal(config);
+        ASSERT_TRUE(journal.open());
+        for (int sequence = 1; sequence <= 30; sequence += 3) {
+            std::vector<char> datagram;
+            for (int message = sequence; message < sequence + 3; ++message) {
+                const auto packet = makePacket(message, MarketDataProvider::NEW, makeOrder(message, token, 'B', 100, 10));
+                datagram.insert(datagram.end(), packet.begin(), packet.end());
+            }
+            journal.append(datagram.data(), datagram.size(), 0, 0);
+        }
+    }
+    MarketDataProvider::JournalReader batchedReader(config._directory, config._prefix);
+    ASSERT_TRUE(batchedReader.open());
+    MarketDataProvider::StreamManager batched(1);
+    batched.init(tokens);
+    const auto batchedStats = MarketDataProvider::ReplayDriver(batched).run(batchedReader);
+    EXPECT_EQ(batchedStats._packets, 10u);
+    EXPECT_EQ(batchedStats._messages, 30u);
+    EXPECT_EQ(batched.getLadderBuilder(token)->getLadderDepth()._bid[0]._quantity, 300);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(MarketDataProviderTest, CheckpointRestoresBookAndJournalTail) {
+    const auto directory = std::filesystem::temp_directory_path() / ("mdp_checkpoint_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig journalConfig;
+    journalConfig._directory = (directory / "journal").string();
+    journalConfig._prefix = "stream0";
+    journalConfig._segmentSize = 8192;
+    MarketDataProvider::CheckpointConfig checkpointConfig;
+    checkpointConfig._directory = (directory / "checkpoints").string();
+    checkpointConfig._prefix = "stream0";
+
+    const MarketDataProvider::TokenListT tokens = {token, token + 1};
+    MarketDataProvider::StreamManager live(1);
+    live.init(tokens);
+    constexpr int Packets = 300;
+    {
+        MarketDataProvider::Journal journal(journalConfig);
+        ASSERT_TRUE(journal.open());
+        live.setJournal(&journal);
+        MarketDataProvider::Checkpoint checkpoint(checkpointConfig);
+
+        std::mt19937 random(11);
+        for (int sequence = 1; sequence <= Packets; ++sequence) {
+            const MarketDataProvider::TokenT orderToken = tokens[random() % tokens.size()];
+            const char side = random() % 2 ? 'B' : 'S';
+            const bool cancel = sequence > 10 && random() % 4 == 0;
+            const double orderId = cancel ? sequence - 10 : sequence;
+            auto packet = makePacket(sequence, cancel ? MarketDataProvider::CANCEL : MarketDataProvider::NEW,
+                                     makeOrder(orderId, orderToken, side, 100 + static_cast<int>(random() % 8), 10));
+            live.process(packet.data(), packet.size(), 1000 + sequence);
+            if (sequence % 100 == 0) {
+                EXPECT_TRUE(checkpoint.save(live, journal.getPosition()));
+                checkpoint.flush();
+            }
+        }
+        live.setJournal(nullptr);
+
+        const auto stats = checkpoint.getStats();
+        EXPECT_EQ(stats._saved, 3u);
+        EXPECT_EQ(stats._failed, 0u);
+        EXPECT_GT(stats._bytes, sizeof(MarketDataProvider::CheckpointHeader));
+    }
+    // Only the newest two snapshots are kept
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(checkpointConfig._directory),
+                            std::filesystem::directory_iterator()), 2);
+
+    // Corrupt the newest snapshot: restore falls back to the one before it
+    {
+        const auto newest = directory / "checkpoints" / "stream0.000002.snapshot";
+        ASSERT_TRUE(std::filesystem::exists(newest));
+        std::fstream file(newest, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(MarketDataProvider::CheckpointHeader) + 2);
+        file.put('\x7f');
+    }
+
+    MarketDataProvider::StreamManager restored(1);
+    restored.init(tokens);
+    MarketDataProvider::Checkpoint checkpoint(checkpointConfig);
+    MarketDataProvider::JournalPosition position;
+    ASSERT_TRUE(checkpoint.restore(restored, position));
+    EXPECT_EQ(restored.getStreamStats(0)._expected, 201);
+
+    MarketDataProvider::JournalReader reader(journalConfig._directory, journalConfig._prefix);
+    ASSERT_TRUE(reader.open());
+    ASSERT_TRUE(reader.seek(position));
+    MarketDataProvider::ReplayConfig replayConfig;
+    replayConfig._measureLatency = false;
+    EXPECT_EQ(MarketDataProvider::ReplayDriver(restored, replayConfig).run(reader)._messages, 100u);
+
+    const auto expected = MarketDataProvider::ReplayDriver::checksums(live, tokens);
+    const auto actual = MarketDataProvider::ReplayDriver::checksums(restored, tokens);
+    ASSERT_EQ(actual.size(), tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(actual[i]._checksum, expected[i]._checksum);
+        EXPECT_EQ(restored.getLadderBuilder(tokens[i])->getVersion(), live.getLadderBuilder(tokens[i])->getVersion());
+    }
+    EXPECT_EQ(restored.getStreamStats(0)._expected, live.getStreamStats(0)._expected);
+
+    // Time priority survives the round trip
+    for (int orderId = 1; orderId <= Packets; ++orderId) {
+        for (MarketDataProvider::TokenT orderToken : tokens) {
+            const auto before = live.getLadderBuilder(orderToken)->getQueuePosition(orderId);
+            const auto after = restored.getLadderBuilder(orderToken)->getQueuePosition(orderId);
+            EXPECT_EQ(after._found, before._found);
+            EXPECT_EQ(after._ordersAhead, before._ordersAhead);
+            EXPECT_EQ(after._quantityAhead, before._quantityAhead);
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(MarketDataProviderTest, WarmStartIgnoresEarlierSessions) {
+    const auto directory = std::filesystem::temp_directory_path() / ("mdp_session_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    MarketDataProvider::JournalConfig journalConfig;
+    journalConfig._directory = (directory / "journal").string();
+    journalConfig._prefix = "shard0";
+    journalConfig._segmentSize = 8192;
+    MarketDataProvider::CheckpointConfig checkpointConfig;
+    checkpointConfig._directory = (directory / "checkpoints").string();
+    checkpointConfig._prefix = "shard0";
+
+    // Yesterday's run leaves a resting order, a snapshot and its journal behind
+    const MarketDataProvider::TokenListT tokens = {token};
+    journalConfig._session = checkpointConfig._session = 20261016;
+    {
+        MarketDataProvider::StreamManager manager(1);
+        manager.init(tokens);
+        MarketDataProvider::Journal journal(journalConfig);
+        ASSERT_TRUE(journal.open());
+        manager.setJournal(&journal);
+        auto packet = makePacket(1, MarketDataProvider::NEW, makeOrder(1, token, 'B', 100, 10));
+        manager.process(packet.data(), packet.size(), 0);
+        MarketDataProvider::Checkpoint checkpoint(checkpointConfig);
+        EXPECT_TRUE(checkpoint.save(manager, journal.getPosition()));
+        checkpoint.flush();
+        manager.setJournal(nullptr);
+    }
+
+    // Today's run has journaled one order and no snapshot yet
+    journalConfig._session = checkpointConfig._session = 20261017;
+    {
+        MarketDataProvider::StreamManager manager(1);
+        manager.init(tokens);
+        MarketDataProvider::Journal journal(journalConfig);
+        ASSERT_TRUE(journal.open());
+        manager.setJournal(&journal);
+        auto packet = makePacket(1, MarketDataProvider::NEW, makeOrder(7, token, 'S', 105, 20));
+        manager.process(packet.data(), packet.size(), 0);
+        manager.setJournal(nullptr);
+    }
+    EXPECT_EQ(MarketDataProvider::listJournalSegments(journalConfig._directory, journalConfig._prefix).size(), 2u);
+    EXPECT_EQ(MarketDataProvider::listJournalSegments(journalConfig._directory, journalConfig._prefix, 20261017),
+              std::vector<uint32_t>{1});
+
+    MarketDataProvider::StreamManager restarted(1);
+    restarted.init(tokens);
+    MarketDataProvider::JournalPosition position;
+    EXPECT_FALSE(MarketDataProvider::Checkpoint(checkpointConfig).restore(restarted, position));
+
+    MarketDataProvider::JournalReader reader(journalConfig._directory, journalConfig._prefix, journalConfig._session);
+    ASSERT_TRUE(reader.open());
+    MarketDataProvider::ReplayConfig replayConfig;
+    replayConfig._measureLatency = false;
+    EXPECT_EQ(MarketDataProvider::ReplayDriver(restarted, replayConfig).run(reader)._messages, 1u);
+
+    // Only today's order is on the book
+    const auto depth = restarted.getLadderBuilder(token)->getLadderDepth();
+    EXPECT_EQ(depth._bid[0]._quantity, 0);
+    EXPECT_EQ(depth._ask[0]._price, 105);
+    EXPECT_EQ(depth._ask[0]._quantity, 20);
+
+    // The earlier session's snapshot is still there for its own session
+    checkpointConfig._session = 20261016;
+    EXPECT_TRUE(MarketDataProvider::Checkpoint(checkpointConfig).restore(restarted, position));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(MarketDataProviderTest, SharedDepthStorePublishesBooksAcrossMappings) {
+    const std::string name = "mdp_depth_test_" + std::to_string(::getpid());
+    MarketDataProvider::SharedDepthStore writer(name);
+    ASSERT_TRUE(writer.create({token, token + 1}));
+
+    MarketDataProvider::SharedDepthStore reader(name);
+    ASSERT_TRUE(reader.attach());
+    EXPECT_TRUE(reader.isLive());
+    EXPECT_EQ(reader.getTokens(), (std::vector<MarketDataProvider::TokenT>{token, token + 1}));
+    EXPECT_EQ(reader.findSlot(token + 2), -1);
+
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token, token + 1});
+    manager.setDepthStore(&writer);
+
+    auto packet = makePacket(1, MarketDataProvider::NEW, makeOrder(1, token, 'B', 100, 10));
+    manager.process(packet.data(), packet.size());
+    packet = makePacket(2, MarketDataProvider::NEW, makeOrder(2, token, 'S', 102, 5));
+    manager.process(packet.data(), packet.size());
+
+    MarketDataProvider::TradeMessage trade{};
+    trade._timeStamp = 42.0;
+    trade._buyOrderId = 1;
+    trade._sellOrderId = 2;
+    trade._token = token;
+    trade._price = 102;
+    trade._quantity = 3;
+    packet = makePacket(3, MarketDataProvider::TRADE, trade);
+    manager.process(packet.data(), packet.size());
+
+    MarketDataProvider::SharedDepth depth;
+    ASSERT_TRUE(reader.read(token, depth));
+    const auto* builder = manager.getLadderBuilder(token);
+    EXPECT_EQ(depth._version, builder->getVersion());
+    const auto expected = builder->getLadderDepth();
+    EXPECT_EQ(std::memcmp(&depth._depth, &expected, sizeof(expected)), 0);
+    EXPECT_EQ(depth._lastTradePrice, 102);
+    EXPECT_EQ(depth._lastTradeQuantity, 3);
+    EXPECT_EQ(depth._lastTradeNanos, 42u);
+    EXPECT_EQ(depth._tradeCount, 1u);
+    EXPECT_GT(depth._updateNanos, 0u);
+
+    // Untouched token keeps its empty slot
+    ASSERT_TRUE(reader.read(token + 1, depth));
+    EXPECT_EQ(depth._version, 0u);
+    EXPECT_EQ(depth._depth._token, token + 1);
+
+    // Readers racing the writer only ever see a whole update: the writer
+    // keeps price and quantity of the best bid equal
+    std::atomic<bool> running{true};
+    std::thread publisher([&] {
+        int sequence = 4;
+        for (int price = 1; running.load(std::memory_order_relaxed); price = price % 1000 + 1, sequence += 2) {
+            const auto order = makeOrder(sequence, token + 1, 'B', 100000 + price, 100000 + price);
+            auto add = makePacket(sequence, MarketDataProvider::NEW, order);
+            manager.process(add.data(), add.size());
+            auto remove = makePacket(sequence + 1, MarketDataProvider::CANCEL, order);
+            manager.process(remove.data(), remove.size());
+        }
+    });
+    const int slot = reader.findSlot(token + 1);
+    uint64_t lastVersion = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (lastVersion < 20'000 && std::chrono::steady_clock::now() < deadline) {
+        reader.readSlot(slot, depth);
+        EXPECT_EQ(depth._depth._bid[0]._price, depth._depth._bid[0]._quantity);
+        EXPECT_GE(depth._version, lastVersion);
+        lastVersion = depth._version;
+    }
+    running = false;
+    publisher.join();
+    EXPECT_GE(lastVersion, 20'000u);
+
+    writer.close();
+    EXPECT_FALSE(reader.isLive());
+    MarketDataProvider::SharedDepthStore late(name);
+    EXPECT_FALSE(late.attach());
+}
+
+TEST_F(MarketDataProviderTest, ConflatingPublisherDeliversLatestStatePerSubscriber) {
+    const MarketDataProvider::TokenListT tokens = {token, token + 1};
+    MarketDataProvider::ConflatingPublisher publisher(tokens, 8);
+    MarketDataProvider::StreamManager manager(1);
+    manager.init(tokens);
+    manager.subscribe([&publisher](const MarketDataProvider::DepthUpdate& update) { publisher.onUpdate(update); });
+
+    auto fast = publisher.subscribe("fast", std::chrono::nanoseconds(0));
+    auto slow = publisher.subscribe("slow", std::chrono::hours(1));
+    std::map<MarketDataProvider::TokenT, MarketDataProvider::ConflatedDepth> seen;
+    const auto record = [&seen](const MarketDataProvider::ConflatedDepth& depth) { seen[depth._depth._token] = depth; };
+
+    // Every token starts dirty so a new subscriber gets a full picture
+    EXPECT_EQ(fast->poll(record), 2u);
+    EXPECT_EQ(slow->poll(record), 2u);
+
+    int sequence = 0;
+    for (int price = 100; price < 105; ++price) {
+        ++sequence;
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', price, 10));
+        manager.process(packet.data(), packet.size());
+    }
+    EXPECT_EQ(fast->pending(), 1u);
+
+    seen.clear();
+    EXPECT_EQ(fast->poll(record), 1u);
+    ASSERT_EQ(seen.count(token), 1u);
+    const auto* builder = manager.getLadderBuilder(token);
+    EXPECT_EQ(seen[token]._version, builder->getVersion());
+    EXPECT_EQ(seen[token]._skipped, 4u);
+    const auto expected = builder->getLadderDepth();
+    EXPECT_EQ(std::memcmp(&seen[token]._depth, &expected, sizeof(expected)), 0);
+    EXPECT_EQ(fast->poll(record), 0u);
+
+    // The slow subscriber is held back by its interval but keeps its dirty set
+    EXPECT_EQ(slow->poll(record), 0u);
+    EXPECT_EQ(slow->pending(), 1u);
+
+    // Falling a whole log behind marks every token dirty instead of losing updates
+    for (int i = 0; i < 20; ++i) {
+        ++sequence;
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token + 1, 'S', 200 - i, 5));
+        manager.process(packet.data(), packet.size());
+    }
+    seen.clear();
+    EXPECT_EQ(fast->poll(record), 2u);
+    EXPECT_EQ(fast->getStats()._overruns, 1u);
+    EXPECT_EQ(seen[token + 1]._version, manager.getLadderBuilder(token + 1)->getVersion());
+    EXPECT_EQ(fast->getStats()._delivered, 5u);
+    EXPECT_GE(fast->getStats()._conflated, 4u);
+}
+
+TEST_F(MarketDataProviderTest, PacketsCarryingSeveralMessages) {
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+
+    // Three messages back to back in one datagram
+    std::vector<char> datagram;
+    for (int sequence = 1; sequence <= 3; ++sequence) {
+        auto packet = makePacket(sequence, MarketDataProvider::NEW, makeOrder(sequence, token, 'B', 100 + sequence, 10));
+        datagram.insert(datagram.end(), packet.begin(), packet.end());
+    }
+    manager.process(datagram.data(), datagram.size());
+    EXPECT_EQ(manager.getStreamStats(0)._expected, 4);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._bid[2]._price, 101);
+
+    // A message whose length runs past the datagram stops the walk there
+    std::vector<char> truncated = makePacket(4, MarketDataProvider::CANCEL, makeOrder(3, token, 'B', 103, 10));
+    auto tail = makePacket(5, MarketDataProvider::CANCEL, makeOrder(2, token, 'B', 102, 10));
+    truncated.insert(truncated.end(), tail.begin(), tail.end() - 1);
+    manager.process(truncated.data(), truncated.size());
+    EXPECT_EQ(manager.getStreamStats(0)._expected, 5);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._bid[0]._price, 102);
+
+    // A trailing message framed correctly but too short for its type is counted, never read past
+    std::vector<char> shortTail = makePacket(5, MarketDataProvider::NEW, makeOrder(10, token, 'B', 104, 10));
+    auto cancel = makePacket(6, MarketDataProvider::CANCEL, makeOrder(10, token, 'B', 104, 10));
+    const size_t shortLength = sizeof(MarketDataProvider::StreamHeader) + 1 + 8;
+    reinterpret_cast<MarketDataProvider::StreamHeader*>(cancel.data())->_len = static_cast<short>(shortLength);
+    shortTail.insert(shortTail.end(), cancel.begin(), cancel.begin() + shortLength);
+    const MarketDataProvider::PacketView shortView{shortTail.data(), shortTail.size(), 0};
+    manager.processBatch({&shortView, 1});
+    EXPECT_EQ(manager.getStreamStats(0)._expected, 7);
+    EXPECT_EQ(manager.getStreamStats(0)._malformed, 1u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._bid[0]._price, 104);
+
+    // processBatch leaves the same books as processing packet by packet
+    MarketDataProvider::StreamManager batched(1);
+    MarketDataProvider::StreamManager single(1);
+    batched.init({token, token + 1});
+    single.init({token, token + 1});
+    std::vector<std::vector<char>> packets;
+    for (int sequence = 1; sequence <= 40; ++sequence) {
+        const MarketDataProvider::TokenT target = token + sequence % 2;
+        const char type = sequence % 5 == 0 ? MarketDataProvider::CANCEL : MarketDataProvider::NEW;
+        packets.push_back(makePacket(sequence, type, makeOrder(sequence % 5 == 0 ? sequence - 2 : sequence, target,
+                                                               sequence % 3 ? 'B' : 'S', 100 + sequence % 7, sequence)));
+    }
+    packets[10].insert(packets[10].end(), packets[11].begin(), packets[11].end());
+    packets.erase(packets.begin() + 11);
+
+    std::vector<MarketDataProvider::PacketView> views;
+    for (const auto& packet : packets) {
+        views.push_back({packet.data(), packet.size(), 0});
+        single.process(packet.data(), packet.size());
+    }
+    batched.processBatch(views);
+
+    EXPECT_EQ(batched.getStreamStats(0)._expected, 41);
+    for (MarketDataProvider::TokenT target : {token, token + 1}) {
+        const auto expected = single.getLadderBuilder(target)->getLadderDepth();
+        const auto actual = batched.getLadderBuilder(target)->getLadderDepth();
+        EXPECT_EQ(std::memcmp(&actual, &expected, sizeof(expected)), 0);
+        EXPECT_EQ(batched.getLadderBuilder(target)->getVersion(), single.getLadderBuilder(target)->getVersion());
+    }
+}
+
+TEST_F(MarketDataProviderTest, StreamManagerInstantiatesForOutOfTreeDecoder) {
+    MarketDataProvider::BasicStreamManager<NativeOrderDecoder> manager(1);
+    manager.init({token});
+
+    const auto packet = [](int sequence_, char type_, const MarketDataProvider::OrderMessage& order_) {
+        std::vector<char> packet(sizeof(MarketDataProvider::StreamHeader) + 1 + sizeof(order_));
+        MarketDataProvider::StreamHeader header{};
+        header._len = static_cast<short>(packet.size());
+        header._sequence = sequence_;
+        std::memcpy(packet.data(), &header, sizeof(header));
+        packet[sizeof(header)] = type_;
+        std::memcpy(packet.data() + sizeof(header) + 1, &order_, sizeof(order_));
+        return packet;
+    };
+    auto first = packet(1, MarketDataProvider::NEW, makeOrder(1, token, 'B', 100, 10));
+    manager.process(first.data(), first.size());
+    auto second = packet(2, MarketDataProvider::NEW, makeOrder(2, token, 'S', 101, 5));
+    manager.process(second.data(), second.size());
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._bid[0]._quantity, 10);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._ask[0]._price, 101);
+
+    auto cancel = packet(3, MarketDataProvider::CANCEL, makeOrder(1, token, 'B', 100, 10));
+    manager.process(cancel.data(), cancel.size());
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._bid[0]._quantity, 0);
+    EXPECT_EQ(manager.getStreamStats(0)._expected, 4);
+}
+
+TEST_F(MarketDataProviderTest, ShardsOwnDisjointStreamsAndTokens) {
+    // Five streams on two workers; stream 4 repeats a token of stream 0, both on worker 0
+    const std::map<size_t, std::vector<MarketDataProvider::TokenT>> streamTokens = {
+        {0, {100, 101}}, {1, {200}}, {2, {300}}, {3, {400}}, {4, {500, 100}}};
+    MarketDataProvider::ShardLayout layout;
+    ASSERT_TRUE(MarketDataProvider::planShards(5, 2, streamTokens, layout));
+    EXPECT_EQ(layout._streamWorkers, (std::vector<size_t>{0, 1, 0, 1, 0}));
+    EXPECT_EQ(layout._workerStreams[0], (std::vector<size_t>{0, 2, 4}));
+    EXPECT_EQ(layout._workerStreams[1], (std::vector<size_t>{1, 3}));
+    EXPECT_EQ(layout._workerTokens[0], (std::vector<MarketDataProvider::TokenT>{100, 101, 300, 500}));
+    EXPECT_EQ(layout._workerTokens[1], (std::vector<MarketDataProvider::TokenT>{200, 400}));
+
+    // A token on two workers' streams, or an unknown stream, is not a valid layout
+    MarketDataProvider::ShardLayout rejected;
+    EXPECT_FALSE(MarketDataProvider::planShards(5, 2, {{0, {100}}, {1, {100}}}, rejected));
+    EXPECT_FALSE(MarketDataProvider::planShards(5, 2, {{5, {100}}}, rejected));
+    ASSERT_TRUE(MarketDataProvider::planShards(2, 8, {}, rejected));
+    EXPECT_EQ(rejected._workerStreams.size(), 2u);
+
+    // Each worker builds only its own tokens and sees only its own streams
+    std::vector<std::unique_ptr<MarketDataProvider::StreamManager>> workers;
+    for (const auto& tokens : layout._workerTokens) {
+        workers.push_back(std::make_unique<MarketDataProvider::StreamManager>(1));
+        workers.back()->init(tokens);
+    }
+    for (const auto& [stream, tokens] : streamTokens) {
+        const auto packet = makePacket(1, MarketDataProvider::NEW, makeOrder(stream + 1, tokens.front(), 'B', 100, 10),
+                                       static_cast<short>(stream));
+        workers[layout._streamWorkers[stream]]->process(packet.data(), packet.size());
+    }
+    for (size_t worker = 0; worker < workers.size(); ++worker) {
+        for (size_t stream = 0; stream < layout._streamWorkers.size(); ++stream) {
+            const bool own = layout._streamWorkers[stream] == worker;
+            EXPECT_EQ(workers[worker]->getStreamStats(static_cast<short>(stream))._expected, own ? 2 : 1);
+            for (const auto token : streamTokens.at(stream)) {
+                EXPECT_EQ(workers[worker]->getLadderBuilder(token) != nullptr, own);
+            }
+        }
+    }
+    EXPECT_EQ(workers[0]->getLadderBuilder(100)->getLadderDepth()._bid[0]._quantity, 10);
+    EXPECT_EQ(workers[1]->getLadderBuilder(400)->getLadderDepth()._bid[0]._quantity, 10);
+}
+
+TEST_F(MarketDataProviderTest, LadderDepthTemplatedOnLevels) {
+    static_assert(sizeof(MarketDataProvider::BasicLadderDepth<1>) == sizeof(MarketDataProvider::TokenT) + 2 * sizeof(MarketDataProvider::Ladder));
+
+    for (auto type : {MarketDataProvider::FLAT_MAP, MarketDataProvider::TICK_ARRAY}) {
+        MarketDataProvider::LadderBuilder builder(token, type);
+        for (int level = 0; level < 12; ++level) {
+            builder.processNewOrder(makeOrder(level + 1, token, 'B', 100 - level, 10 + level));
+            builder.processNewOrder(makeOrder(level + 101, token, 'S', 101 + level, 20 + level));
+        }
+
+        const auto published = builder.getLadderDepth();
+        const auto top = builder.getLadderDepth<1>();
+        EXPECT_EQ(top._token, token);
+        EXPECT_EQ(top._bid[0]._price, 100);
+        EXPECT_EQ(top._ask[0]._price, 101);
+
+        const auto five = builder.getLadderDepth<5>();
+        EXPECT_EQ(std::memcmp(&five, &published, sizeof(published)), 0);
+
+        const auto ten = builder.getLadderDepth<10>();
+        const auto twenty = builder.getLadderDepth<20>();
+        for (int level = 0; level < 10; ++level) {
+            EXPECT_EQ(ten._bid[level]._price, 100 - level);
+            EXPECT_EQ(ten._ask[level]._quantity, 20 + level);
+        }
+        EXPECT_EQ(twenty._bid[11]._price, 89);
+        EXPECT_EQ(twenty._ask[11]._price, 112);
+        EXPECT_EQ(twenty._bid[12]._quantity, 0);
+        EXPECT_EQ(twenty._ask[19]._price, 0);
+    }
+}
+
+TEST_F(MarketDataProviderTest, DecoderNormalizesWireMessages) {
+    // Wire times are seconds in a double, decoded ones integer nanoseconds
+    MarketDataProvider::OrderMessage order = makeOrder(9'007'199'254'740'000ULL, token, 'S', 250, 7);
+    order._timestamp = 1'700'000'000'123'456'768ULL;
+    const auto wire = MarketDataProvider::NseDecoder::encode(order);
+    EXPECT_DOUBLE_EQ(wire._timestamp, 1'700'000'000.123456768);
+
+    const auto decoded = MarketDataProvider::NseDecoder::normalize(wire);
+    EXPECT_EQ(decoded._orderId, order._orderId);
+    EXPECT_NEAR(static_cast<double>(decoded._timestamp), static_cast<double>(order._timestamp), 1000.0);
+    EXPECT_EQ(decoded._token, token);
+    EXPECT_EQ(decoded._price, 250);
+
+    MarketDataProvider::TradeMessage trade{};
+    trade._timeStamp = 42;
+    trade._buyOrderId = 3;
+    trade._sellOrderId = 4;
+    const auto decodedTrade = MarketDataProvider::NseDecoder::normalize(MarketDataProvider::NseDecoder::encode(trade));
+    EXPECT_EQ(decodedTrade._timeStamp, 42u);
+    EXPECT_EQ(decodedTrade._sellOrderId, 4u);
+
+    // Wire values no integer can hold decode as 0 instead of converting out of range
+    auto bad = MarketDataProvider::NseDecoder::encode(order);
+    bad._orderId = -5.0;
+    bad._timestamp = std::nan("");
+    const auto badOrder = MarketDataProvider::NseDecoder::normalize(bad);
+    EXPECT_EQ(badOrder._orderId, 0u);
+    EXPECT_EQ(badOrder._timestamp, 0u);
+    bad._orderId = std::nan("");
+    bad._timestamp = 1e300;
+    EXPECT_EQ(MarketDataProvider::NseDecoder::normalize(bad)._orderId, 0u);
+    EXPECT_EQ(MarketDataProvider::NseDecoder::normalize(bad)._timestamp, 0u);
+    bad._orderId = 1e30;
+    EXPECT_EQ(MarketDataProvider::NseDecoder::normalize(bad)._orderId, 0u);
+
+    // Ids past 2^53 stay distinct once decoded, a double would merge them
+    constexpr MarketDataProvider::OrderIdT Large = (1ULL << 53) + 1;
+    builder->processNewOrder(makeOrder(Large - 1, token, 'B', 100, 10));
+    builder->processNewOrder(makeOrder(Large, token, 'B', 100, 5));
+    EXPECT_EQ(builder->getLadderDepth()._bid[0]._quantity, 15);
+    builder->processCancelOrder(makeOrder(Large, token, 'B', 100, 5));
+    EXPECT_EQ(builder->getLadderDepth()._bid[0]._quantity, 10);
+}
+
+TEST_F(MarketDataProviderTest, BookAnalyticsFollowTheBook) {
+    MarketDataProvider::LadderBuilder ticked(token, MarketDataProvider::TICK_ARRAY, 5);
+    EXPECT_EQ(ticked.getAnalytics()._mid, 0.0);
+
+    ticked.processNewOrder(makeOrder(1, token, 'B', 1000, 30));
+    EXPECT_EQ(ticked.getAnalytics()._mid, 0.0);   // One-sided book
+    ticked.processNewOrder(makeOrder(2, token, 'S', 1010, 10));
+    ticked.processNewOrder(makeOrder(3, token, 'B', 995, 20));
+
+    const auto& analytics = ticked.getAnalytics();
+    EXPECT_DOUBLE_EQ(analytics._mid, 1005.0);
+    EXPECT_DOUBLE_EQ(analytics._microprice, (1000.0 * 10 + 1010.0 * 30) / 40);
+    EXPECT_DOUBLE_EQ(analytics._imbalance, (50.0 - 10.0) / 60.0);
+    EXPECT_EQ(analytics._spreadTicks, 2);
+
+    MarketDataProvider::TradeMessage trade{};
+    trade._token = token;
+    trade._buyOrderId = 1;
+    trade._sellOrderId = 2;
+    trade._price = 1010;
+    trade._quantity = 4;
+    ticked.processTrade(trade);
+    trade._price = 1000;
+    trade._quantity = 6;
+    ticked.processTrade(trade);
+    EXPECT_EQ(analytics._tradeVolume, 10u);
+    EXPECT_DOUBLE_EQ(analytics._vwap, (1010.0 * 4 + 1000.0 * 6) / 10);
+    EXPECT_EQ(analytics._mid, 0.0);   // The trades took out the only offer
+
+    // Incremental figures match a recomputation from the depth after random churn
+    std::mt19937 rng(7);
+    for (MarketDataProvider::OrderIdT id = 10; id < 2000; ++id) {
+        const char side = rng() % 2 ? 'B' : 'S';
+        const int price = side == 'B' ? 900 + static_cast<int>(rng() % 20) * 5 : 1010 + static_cast<int>(rng() % 20) * 5;
+        if (rng() % 3 == 0) {
+            ticked.processCancelOrder(makeOrder(id - 1 - rng() % 8, token, side, price, 1));
+        } else {
+            ticked.processNewOrder(makeOrder(id, token, side, price, 1 + static_cast<int>(rng() % 50)));
+        }
+        const auto depth = ticked.getLadderDepth();
+        int64_t bid = 0;
+        int64_t ask = 0;
+        for (int level = 0; level < MarketDataProvider::LADDER_DEPTH; ++level) {
+            bid += depth._bid[level]._quantity;
+            ask += depth._ask[level]._quantity;
+        }
+        if (depth._bid[0]._quantity > 0 && depth._ask[0]._quantity > 0) {
+            ASSERT_DOUBLE_EQ(analytics._imbalance, static_cast<double>(bid - ask) / static_cast<double>(bid + ask));
+            ASSERT_EQ(analytics._spreadTicks, (depth._ask[0]._price - depth._bid[0]._price) / 5);
+        }
+    }
+
+    // Session trade totals survive a clear and restore
+    ticked.clear();
+    EXPECT_EQ(analytics._tradeVolume, 0u);
+    ticked.restoreTrades(10, 10060.0);
+    EXPECT_DOUBLE_EQ(analytics._vwap, 1006.0);
+}
+
+TEST_F(MarketDataProviderTest, BarsCloseByTimeVolumeAndTrades) {
+    std::vector<MarketDataProvider::BarSpec> specs;
+    for (const char* text : {"1s", "volume:10", "ticks:3"}) {
+        MarketDataProvider::BarSpec spec;
+        ASSERT_TRUE(MarketDataProvider::parseBarSpec(text, spec));
+        specs.push_back(spec);
+    }
+    EXPECT_EQ(specs[0]._size, 1'000'000'000u);
+    MarketDataProvider::BarSpec invalid;
+    EXPECT_FALSE(MarketDataProvider::parseBarSpec("10x", invalid));
+    EXPECT_FALSE(MarketDataProvider::parseBarSpec("ticks:0", invalid));
+
+    MarketDataProvider::BarAggregator bars({token}, specs, 2);
+    std::vector<MarketDataProvider::Bar> published;
+    bars.subscribe([&published](const MarketDataProvider::Bar& bar) { published.push_back(bar); });
+    const auto path = std::filesystem::temp_directory_path() / ("mdp_bars_" + std::to_string(::getpid()) + ".bars");
+    std::filesystem::remove(path);
+    MarketDataProvider::BarFile file;
+    ASSERT_TRUE(file.open(path.string()));
+    bars.setBarFile(&file);
+
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setBarAggregator(&bars);
+
+    // Seconds, price and quantity of each trade, fed through the stream
+    const std::tuple<double, int, int> trades[] = {{1.0, 100, 4}, {1.25, 103, 4}, {1.5, 99, 4}, {2.25, 101, 2}, {2.5, 102, 1}};
+    int sequence = 0;
+    for (const auto& [seconds, price, quantity] : trades) {
+        MarketDataProvider::TradeMessage trade{};
+        trade._timeStamp = static_cast<MarketDataProvider::TimestampT>(seconds * 1e9);
+        trade._token = token;
+        trade._price = price;
+        trade._quantity = quantity;
+        ++sequence;
+        const auto packet = makePacket(sequence, MarketDataProvider::TRADE, trade);
+        manager.process(packet.data(), packet.size());
+    }
+
+    // The third trade fills the volume and tick bars, the fourth starts a new second
+    ASSERT_EQ(published.size(), 3u);
+    EXPECT_EQ(published[0]._spec, 1);
+    EXPECT_EQ(published[1]._spec, 2);
+    EXPECT_EQ(published[2]._spec, 0);
+    for (const auto& bar : published) {
+        EXPECT_EQ(bar._token, token);
+        EXPECT_EQ(bar._open, 100);
+        EXPECT_EQ(bar._high, 103);
+        EXPECT_EQ(bar._low, 99);
+        EXPECT_EQ(bar._close, 99);
+        EXPECT_EQ(bar._volume, 12u);
+        EXPECT_EQ(bar._trades, 3u);
+        EXPECT_DOUBLE_EQ(bar._notional, 100.0 * 4 + 103.0 * 4 + 99.0 * 4);
+    }
+    EXPECT_EQ(published[0]._endNanos, 1'500'000'000u);
+    EXPECT_EQ(published[2]._startNanos, 1'000'000'000u);
+    EXPECT_EQ(published[2]._endNanos, 2'000'000'000u);
+
+    // A quiet feed closes the open time bar once its interval is over
+    MarketDataProvider::Bar open;
+    ASSERT_TRUE(bars.getOpenBar(token, 0, open));
+    EXPECT_EQ(open._volume, 3u);
+    EXPECT_EQ(bars.closeExpired(2'900'000'000u), 0u);
+    EXPECT_EQ(bars.closeExpired(3'000'000'000u), 1u);
+    EXPECT_EQ(bars.closeExpired(3'000'000'000u), 0u);
+    EXPECT_FALSE(bars.getOpenBar(token, 0, open));
+    EXPECT_EQ(published.back()._open, 101);
+    EXPECT_EQ(published.back()._close, 102);
+
+    // The ring keeps only the newest closed bars
+    for (int i = 0; i < 7; ++i) {
+        MarketDataProvider::TradeMessage trade{};
+        trade._timeStamp = 4'000'000'000u;
+        trade._token = token;
+        trade._price = 200 + i;
+        trade._quantity = 1;
+        bars.onTrade(trade);
+    }
+    std::vector<MarketDataProvider::Bar> history;
+    EXPECT_EQ(bars.getBars(token, 2, history), 2u);
+    EXPECT_EQ(history[0]._close, 203);
+    EXPECT_EQ(history[1]._close, 206);
+    history.clear();
+    EXPECT_EQ(bars.getBars(token, 0, history, 1), 1u);
+    EXPECT_EQ(history[0]._startNanos, 2'000'000'000u);
+    EXPECT_EQ(bars.getBars(token + 1, 0, history), 0u);
+
+    // Every published bar is in the columnar file
+    file.close();
+    std::vector<MarketDataProvider::Bar> stored;
+    ASSERT_TRUE(MarketDataProvider::BarFile::read(path.string(), stored));
+    ASSERT_EQ(stored.size(), published.size());
+    for (size_t i = 0; i < stored.size(); ++i) {
+        EXPECT_EQ(stored[i]._spec, published[i]._spec);
+        EXPECT_EQ(stored[i]._startNanos, published[i]._startNanos);
+        EXPECT_EQ(stored[i]._endNanos, published[i]._endNanos);
+        EXPECT_EQ(stored[i]._close, published[i]._close);
+        EXPECT_EQ(stored[i]._volume, published[i]._volume);
+        EXPECT_DOUBLE_EQ(stored[i]._notional, published[i]._notional);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(MarketDataProviderTest, BarFileWritesBlocksOnItsOwnThread) {
+    const auto path = std::filesystem::temp_directory_path() / ("mdp_bar_blocks_" + std::to_string(::getpid()) + ".bars");
+    std::filesystem::remove(path);
+    MarketDataProvider::BarFile file;
+    ASSERT_TRUE(file.open(path.string()));
+
+    // Two full blocks, a flushed partial one and a tail written on close
+    constexpr size_t Count = MarketDataProvider::BarFile::BlockSize * 2 + 100;
+    for (size_t i = 0; i < Count; ++i) {
+        MarketDataProvider::Bar bar;
+        bar._token = token;
+        bar._close = static_cast<MarketDataProvider::PriceT>(i);
+        file.append(bar);
+        if (i == Count - 50) {
+            file.flush();
+        }
+    }
+    file.close();
+    EXPECT_EQ(file.getBarsWritten(), Count);
+    EXPECT_EQ(file.getBarsDropped(), 0u);
+
+    std::vector<MarketDataProvider::Bar> stored;
+    ASSERT_TRUE(MarketDataProvider::BarFile::read(path.string(), stored));
+    ASSERT_EQ(stored.size(), Count);
+    for (size_t i = 0; i < Count; ++i) {
+        ASSERT_EQ(stored[i]._close, static_cast<MarketDataProvider::PriceT>(i));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(MarketDataProviderTest, TradeTapeKeepsRecentTradesForReaders) {
+    MarketDataProvider::TradeTape tape({token}, 5);
+    EXPECT_EQ(tape.getCapacity(), 8u);
+
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setTradeTape(&tape);
+
+    // The side whose order was not resting took liquidity
+    int sequence = 0;
+    auto send = [&](auto type, const auto& message) {
+        ++sequence;
+        const auto packet = makePacket(sequence, type, message);
+        manager.process(packet.data(), packet.size());
+    };
+    send(MarketDataProvider::NEW, makeOrder(1, token, 'B', 100, 10));
+    send(MarketDataProvider::NEW, makeOrder(2, token, 'S', 101, 10));
+    MarketDataProvider::TradeMessage trade{};
+    trade._token = token;
+    trade._timeStamp = 1000;
+    trade._buyOrderId = 1;
+    trade._sellOrderId = 7;
+    trade._price = 100;
+    trade._quantity = 4;
+    send(MarketDataProvider::TRADE, trade);
+    trade._timeStamp = 2000;
+    trade._buyOrderId = 9;
+    trade._sellOrderId = 2;
+    trade._price = 101;
+    trade._quantity = 6;
+    send(MarketDataProvider::TRADE, trade);
+
+    MarketDataProvider::TradePrint prints[8];
+    ASSERT_EQ(tape.read(token, prints, 8), 2u);
+    EXPECT_EQ(prints[0]._aggressor, MarketDataProvider::SELL);
+    EXPECT_EQ(prints[1]._aggressor, MarketDataProvider::BUY);
+    EXPECT_EQ(prints[1]._timestamp, 2000u);
+
+    MarketDataProvider::TapeSummary summary;
+    ASSERT_TRUE(tape.summarize(token, 8, summary));
+    EXPECT_EQ(summary._sellVolume, 4u);
+    EXPECT_EQ(summary._buyVolume, 6u);
+    EXPECT_DOUBLE_EQ(summary._realizedVariance, std::log(101.0 / 100.0) * std::log(101.0 / 100.0));
+    EXPECT_FALSE(tape.summarize(token + 1, 8, summary));
+
+    // Only the newest capacity trades survive, returned oldest first
+    for (int i = 0; i < 10; ++i) {
+        trade._price = 200 + i;
+        tape.record(trade, MarketDataProvider::BUY);
+    }
+    EXPECT_EQ(tape.getTradeCount(token), 12u);
+    ASSERT_EQ(tape.read(token, prints, 8), 8u);
+    EXPECT_EQ(prints[0]._price, 202);
+    EXPECT_EQ(prints[7]._price, 209);
+    ASSERT_EQ(tape.read(token, prints, 3), 3u);
+    EXPECT_EQ(prints[0]._price, 207);
+
+    // A reader racing the writer only ever sees whole prints, in order
+    MarketDataProvider::TradeTape raced({token}, 64);
+    constexpr int Trades = 200'000;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        MarketDataProvider::TradeMessage next{};
+        next._token = token;
+        for (int i = 1; i <= Trades; ++i) {
+            next._timeStamp = static_cast<MarketDataProvider::TimestampT>(i);
+            next._price = i;
+            next._quantity = i;
+            raced.record(next, i % 2 ? MarketDataProvider::BUY : MarketDataProvider::SELL);
+        }
+        done = true;
+    });
+    bool consistent = true;
+    MarketDataProvider::TradePrint window[64];
+    while (!done) {
+        const size_t copied = raced.read(token, window, 64);
+        for (size_t i = 0; i < copied; ++i) {
+            consistent &= window[i]._quantity == window[i]._price &&
+                          static_cast<MarketDataProvider::TimestampT>(window[i]._price) == window[i]._timestamp &&
+                          (i == 0 || window[i]._timestamp > window[i - 1]._timestamp);
+        }
+    }
+    writer.join();
+    EXPECT_TRUE(consistent);
+    ASSERT_EQ(raced.read(token, window, 64), 64u);
+    EXPECT_EQ(window[63]._price, Trades);
+}
+
+TEST_F(MarketDataProviderTest, LatencyHistogramsPerStageAndStream) {
+    // Buckets stay within 1/32 of the values they hold
+    for (uint64_t value : {0ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull}) {
+        const uint64_t upper = MarketDataProvider::LatencyHistogram::bucketUpperBound(
+            MarketDataProvider::LatencyHistogram::bucketIndex(value));
+        EXPECT_GE(upper, value);
+        EXPECT_LE(upper - value, value / 32);
+    }
+    EXPECT_LT(MarketDataProvider::LatencyHistogram::bucketIndex(1ull << 50), MarketDataProvider::LatencyHistogram::Buckets);
+
+    MarketDataProvider::LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100'000; ++value) {
+        histogram.record(value);
+    }
+    const auto summary = histogram.summarize();
+    EXPECT_EQ(summary._count, 100'000u);
+    EXPECT_EQ(summary._maxNanos, 100'000u);
+    EXPECT_DOUBLE_EQ(summary._meanNanos, 50'000.5);
+    EXPECT_NEAR(static_cast<double>(summary._p50Nanos), 50'000.0, 50'000.0 / 32);
+    EXPECT_NEAR(static_cast<double>(summary._p99Nanos), 99'000.0, 99'000.0 / 32);
+
+    MarketDataProvider::LatencyRecorder recorder;
+    MarketDataProvider::StreamManager manager(1);
+    manager.init({token});
+    manager.setLatencyRecorder(&recorder);
+
+    const uint64_t rxNanos = MarketDataProvider::TscClock::anchor()._wallNanos;
+    auto packet = makePacket(1, MarketDataProvider::NEW, makeOrder(1, token, 'B', 100, 10), 1);
+    manager.process(packet.data(), packet.size(), rxNanos);
+    // Unknown token: decoded, but no book changes and nothing is published
+    packet = makePacket(2, MarketDataProvider::NEW, makeOrder(2, token + 1, 'B', 100, 10), 1);
+    manager.process(packet.data(), packet.size(), rxNanos);
+    // No receive timestamp, so no stage that starts at the socket
+    packet = makePacket(3, MarketDataProvider::NEW, makeOrder(3, token, 'S', 101, 10), 1);
+    manager.process(packet.data(), packet.size());
+
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::DECODE_STAGE).getCount(), 3u);
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::BOOK_STAGE).getCount(), 3u);
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::PUBLISH_STAGE).getCount(), 2u);
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::RECEIVE_STAGE).getCount(), 2u);
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::TICK_TO_BOOK_STAGE).getCount(), 2u);
+    EXPECT_EQ(recorder.getHistogram(0, MarketDataProvider::DECODE_STAGE).getCount(), 0u);
+    const auto tickToBook = recorder.summarize(MarketDataProvider::TICK_TO_BOOK_STAGE);
+    EXPECT_EQ(tickToBook._count, 2u);
+    EXPECT_LT(tickToBook._maxNanos, 1'000'000'000u);
+
+    manager.setLatencyRecorder(nullptr);
+    packet = makePacket(4, MarketDataProvider::CANCEL, makeOrder(3, token, 'S', 101, 10), 1);
+    manager.process(packet.data(), packet.size(), rxNanos);
+    EXPECT_EQ(recorder.getHistogram(1, MarketDataProvider::DECODE_STAGE).getCount(), 3u);
+    EXPECT_EQ(manager.getLadderBuilder(token)->getLadderDepth()._ask[0]._quantity, 0);
+}
+
 TEST_F(MarketDataProviderTest, MessageTypes) {
     EXPECT_EQ(MarketDataProvider::MessageType::NEW, 'N');
     EXPECT_EQ(MarketDataProvider::MessageType::REPLACE, 'M');